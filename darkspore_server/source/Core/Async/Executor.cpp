@@ -0,0 +1,295 @@
+
+// Include
+#include "Executor.h"
+
+#include <algorithm>
+
+//
+namespace {
+	constexpr size_t sMaxStrandBatch = 16;
+
+	thread_local Executor* sCurrentExecutor = nullptr;
+	thread_local size_t sCurrentWorker = 0;
+}
+
+// Strand
+Strand::Strand(Executor& executor) : mExecutor(executor) {}
+
+void Strand::Post(Job job) {
+	std::unique_lock<std::mutex> lock(mLock);
+	if (mClosed) {
+		return;
+	}
+
+	mJobs.emplace_back(Clock::now(), std::move(job));
+	if (mScheduled) {
+		return;
+	}
+
+	mScheduled = true;
+	lock.unlock();
+
+	mExecutor.Post([self = shared_from_this()] {
+		self->Drain();
+	});
+}
+
+void Strand::PostAt(Clock::time_point executionPoint, Job job) {
+	mExecutor.PostAt(executionPoint, [weak = weak_from_this(), job = std::move(job)]() mutable {
+		if (auto self = weak.lock()) {
+			self->Post(std::move(job));
+		}
+	});
+}
+
+void Strand::Close() {
+	std::unique_lock<std::mutex> lock(mLock);
+	mClosed = true;
+
+	auto jobs = std::move(mJobs);
+	mJobs.clear();
+
+	if (mOwner != std::this_thread::get_id()) {
+		mIdle.wait(lock, [this] { return mOwner == std::thread::id(); });
+	}
+}
+
+bool Strand::IsClosed() const {
+	std::lock_guard<std::mutex> lock(mLock);
+	return mClosed;
+}
+
+bool Strand::RunningInThisThread() const {
+	std::lock_guard<std::mutex> lock(mLock);
+	return mOwner == std::this_thread::get_id();
+}
+
+Strand::Stats Strand::GetStats() const {
+	std::lock_guard<std::mutex> lock(mLock);
+	return mStats;
+}
+
+void Strand::Drain() {
+	std::unique_lock<std::mutex> lock(mLock);
+	mOwner = std::this_thread::get_id();
+
+	for (size_t i = 0; i < sMaxStrandBatch && !mClosed && !mJobs.empty(); ++i) {
+		auto [queuedAt, job] = std::move(mJobs.front());
+		mJobs.pop_front();
+		lock.unlock();
+
+		const auto startedAt = Clock::now();
+		job();
+		const auto finishedAt = Clock::now();
+
+		lock.lock();
+
+		const auto wait = startedAt - queuedAt;
+		const auto run = finishedAt - startedAt;
+
+		mStats.jobs++;
+		mStats.totalWait += wait;
+		mStats.totalRun += run;
+		mStats.maxWait = std::max(mStats.maxWait, wait);
+		mStats.maxRun = std::max(mStats.maxRun, run);
+	}
+
+	mOwner = std::thread::id();
+	mIdle.notify_all();
+
+	// Yield to other strands between batches instead of starving them with a busy instance.
+	if (!mClosed && !mJobs.empty()) {
+		lock.unlock();
+		mExecutor.Post([self = shared_from_this()] {
+			self->Drain();
+		});
+	} else {
+		mScheduled = false;
+	}
+}
+
+// Executor
+Executor::Executor(size_t threadCount) {
+	if (threadCount == 0) {
+		threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+
+	mWorkers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		mWorkers.push_back(std::make_unique<Worker>());
+	}
+
+	for (size_t i = 0; i < threadCount; ++i) {
+		mWorkers[i]->thread = std::thread([this, i] { Run(i); });
+	}
+}
+
+Executor::~Executor() {
+	Shutdown();
+}
+
+void Executor::Post(Job job) {
+	if (!mRunning.load(std::memory_order_relaxed)) {
+		return;
+	}
+
+	// Jobs posted from a worker stay on that worker, other threads spread them round robin.
+	size_t index;
+	if (sCurrentExecutor == this) {
+		index = sCurrentWorker;
+	} else {
+		index = mNextWorker.fetch_add(1, std::memory_order_relaxed) % mWorkers.size();
+	}
+
+	Push(index, std::move(job));
+}
+
+void Executor::PostAt(Clock::time_point executionPoint, Job job) {
+	bool notify;
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		if (!mRunning.load(std::memory_order_relaxed)) {
+			return;
+		}
+
+		mTimers.push(Timer { executionPoint, mTimerSequence++, std::move(job) });
+		notify = mTimers.top().sequence == (mTimerSequence - 1);
+	}
+
+	if (notify) {
+		mSignal.notify_one();
+	}
+}
+
+std::shared_ptr<Strand> Executor::MakeStrand() {
+	return std::make_shared<Strand>(*this);
+}
+
+void Executor::Shutdown() {
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		if (!mRunning.exchange(false)) {
+			return;
+		}
+	}
+
+	mSignal.notify_all();
+	for (auto& worker : mWorkers) {
+		if (worker->thread.joinable()) {
+			worker->thread.join();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mLock);
+	while (!mTimers.empty()) {
+		mTimers.pop();
+	}
+
+	for (auto& worker : mWorkers) {
+		worker->jobs.clear();
+	}
+}
+
+void Executor::Run(size_t index) {
+	sCurrentExecutor = this;
+	sCurrentWorker = index;
+
+	Job job;
+	while (mRunning.load(std::memory_order_relaxed)) {
+		PromoteTimers(index);
+
+		if (Pop(index, job) || Steal(index, job)) {
+			mPending.fetch_sub(1, std::memory_order_relaxed);
+			job();
+			job = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mLock);
+		const auto ready = [this] {
+			return !mRunning.load(std::memory_order_relaxed) ||
+				mPending.load(std::memory_order_relaxed) > 0 ||
+				(!mTimers.empty() && mTimers.top().executionPoint <= Clock::now());
+		};
+
+		if (mTimers.empty()) {
+			mSignal.wait(lock, ready);
+		} else {
+			mSignal.wait_until(lock, mTimers.top().executionPoint, ready);
+		}
+	}
+
+	sCurrentExecutor = nullptr;
+}
+
+void Executor::Push(size_t index, Job job) {
+	auto& worker = *mWorkers[index];
+	{
+		std::lock_guard<std::mutex> lock(worker.lock);
+		worker.jobs.push_back(std::move(job));
+	}
+
+	{
+		// Counted under the executor lock so a worker about to sleep cannot miss it.
+		std::lock_guard<std::mutex> lock(mLock);
+		mPending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	mSignal.notify_one();
+}
+
+bool Executor::Pop(size_t index, Job& job) {
+	auto& worker = *mWorkers[index];
+	std::lock_guard<std::mutex> lock(worker.lock);
+	if (worker.jobs.empty()) {
+		return false;
+	}
+
+	job = std::move(worker.jobs.front());
+	worker.jobs.pop_front();
+	return true;
+}
+
+bool Executor::Steal(size_t index, Job& job) {
+	// Skip busy victims first, then wait for each lock; giving up on a locked victim that holds the
+	// pending job would send the worker straight back around Run without ever sleeping.
+	const auto count = mWorkers.size();
+	for (const bool blocking : { false, true }) {
+		for (size_t i = 1; i < count; ++i) {
+			auto& victim = *mWorkers[(index + i) % count];
+			std::unique_lock<std::mutex> lock(victim.lock, std::defer_lock);
+			if (blocking) {
+				lock.lock();
+			} else if (!lock.try_lock()) {
+				continue;
+			}
+
+			if (victim.jobs.empty()) {
+				continue;
+			}
+
+			// Take from the back so the owner keeps its oldest jobs first.
+			job = std::move(victim.jobs.back());
+			victim.jobs.pop_back();
+			return true;
+		}
+	}
+	return false;
+}
+
+void Executor::PromoteTimers(size_t index) {
+	std::vector<Job> dueJobs;
+	{
+		std::lock_guard<std::mutex> lock(mLock);
+		const auto now = Clock::now();
+		while (!mTimers.empty() && mTimers.top().executionPoint <= now) {
+			// priority_queue::top is const, the job is moved out right before popping it.
+			dueJobs.push_back(std::move(const_cast<Timer&>(mTimers.top()).job));
+			mTimers.pop();
+		}
+	}
+
+	for (auto& job : dueJobs) {
+		Push(index, std::move(job));
+	}
+}
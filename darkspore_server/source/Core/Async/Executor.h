@@ -0,0 +1,128 @@
+
+#ifndef _EXECUTOR_HEADER
+#define _EXECUTOR_HEADER
+
+// Include
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <deque>
+#include <queue>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+//
+class Executor;
+
+using Job = std::function<void(void)>;
+
+// Strand
+class Strand : public std::enable_shared_from_this<Strand> {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		struct Stats {
+			uint64_t jobs = 0;
+
+			Clock::duration totalWait {};
+			Clock::duration maxWait {};
+			Clock::duration totalRun {};
+			Clock::duration maxRun {};
+		};
+
+		Strand(Executor& executor);
+
+		void Post(Job job);
+		void PostAt(Clock::time_point executionPoint, Job job);
+
+		// Drops every pending job and waits for the running one, if any, to finish.
+		void Close();
+
+		bool IsClosed() const;
+		bool RunningInThisThread() const;
+
+		Stats GetStats() const;
+
+	private:
+		void Drain();
+
+	private:
+		Executor& mExecutor;
+
+		std::deque<std::tuple<Clock::time_point, Job>> mJobs;
+		Stats mStats;
+
+		mutable std::mutex mLock;
+		std::condition_variable mIdle;
+		std::thread::id mOwner;
+
+		bool mScheduled = false;
+		bool mClosed = false;
+};
+
+// Executor
+class Executor {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		Executor(size_t threadCount = 0);
+		~Executor();
+
+		void Post(Job job);
+		void PostAt(Clock::time_point executionPoint, Job job);
+
+		std::shared_ptr<Strand> MakeStrand();
+
+		size_t GetThreadCount() const { return mWorkers.size(); }
+
+		void Shutdown();
+
+	private:
+		struct Worker {
+			std::deque<Job> jobs;
+			std::mutex lock;
+			std::thread thread;
+		};
+
+		struct Timer {
+			Clock::time_point executionPoint;
+			uint64_t sequence;
+			Job job;
+		};
+
+		struct TimerComparator {
+			bool operator()(const Timer& lhs, const Timer& rhs) const {
+				if (lhs.executionPoint != rhs.executionPoint) {
+					return lhs.executionPoint > rhs.executionPoint;
+				}
+				return lhs.sequence > rhs.sequence;
+			}
+		};
+
+		void Run(size_t index);
+
+		void Push(size_t index, Job job);
+		bool Pop(size_t index, Job& job);
+		bool Steal(size_t index, Job& job);
+
+		void PromoteTimers(size_t index);
+
+	private:
+		std::vector<std::unique_ptr<Worker>> mWorkers;
+		std::priority_queue<Timer, std::vector<Timer>, TimerComparator> mTimers;
+
+		std::mutex mLock;
+		std::condition_variable mSignal;
+
+		std::atomic<size_t> mPending = 0;
+		std::atomic<size_t> mNextWorker = 0;
+		std::atomic<bool> mRunning = true;
+
+		uint64_t mTimerSequence = 0;
+};
+
+#endif
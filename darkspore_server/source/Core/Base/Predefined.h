@@ -7,6 +7,8 @@
 
 //
 class Scheduler;
+class Executor;
+class Strand;
 
 // Game
 namespace Game {
@@ -0,0 +1,93 @@
+
+// Include
+#include "AIScheduler.h"
+#include "Instance.h"
+#include "Object.h"
+
+#include <algorithm>
+#include <limits>
+
+/*
+	Every agent gets a think interval from its state: agents with a target or aggro think every tick, idle ones
+	every 2, 4 or 16 ticks depending on how close the nearest player is. Intervals are powers of two and each
+	agent has a fixed phase taken from its id, so a horde spawned on the same tick still spreads its thinking
+	evenly and an agent switching intervals never thinks twice in a row by accident.
+*/
+
+// Game
+namespace Game {
+	// AIScheduler
+	AIScheduler::AIScheduler(Instance& game) : mGame(game) {}
+
+	uint32_t AIScheduler::GetThinkPhase(uint32_t id) {
+		// Fibonacci hashing, the top bits are spread well even for consecutive ids.
+		return (id * 2654435769u) >> 28;
+	}
+
+	void AIScheduler::BeginTick() {
+		mPlayerBoxes.clear();
+		for (const auto& [_, player] : mGame.GetPlayers()) {
+			if (const auto object = player->GetDeployedCharacterObject(); object && !object->IsMarkedForDeletion()) {
+				mPlayerBoxes.push_back(object->GetBoundingBox());
+			}
+		}
+
+		mStats.ticks++;
+		mStats.agents = 0;
+		mStats.thinks = 0;
+		mStats.searches = 0;
+		mStats.cost = {};
+	}
+
+	void AIScheduler::EndTick() {
+		mStats.totalThinks += mStats.thinks;
+		mStats.totalSearches += mStats.searches;
+		mStats.totalCost += mStats.cost;
+		mStats.maxCost = std::max(mStats.maxCost, mStats.cost);
+	}
+
+	void AIScheduler::Run(AI& ai) {
+		using Clock = std::chrono::steady_clock;
+
+		mStats.agents++;
+
+		const auto playerDistance = GetDistanceToNearestPlayer(ai.GetObject()->GetPosition());
+		const auto interval = GetThinkInterval(ai, playerDistance);
+		if ((mStats.ticks + ai.GetThinkPhase()) % interval != 0) {
+			return;
+		}
+
+		const auto start = Clock::now();
+		ai.OnTick(*this, playerDistance);
+		mStats.cost += Clock::now() - start;
+		mStats.thinks++;
+	}
+
+	float AIScheduler::GetDistanceToNearestPlayer(const glm::vec3& position) const {
+		float distance = std::numeric_limits<float>::infinity();
+		for (const auto& box : mPlayerBoxes) {
+			const auto outside = glm::max(glm::abs(position - box.center) - box.extent, glm::vec3(0));
+			distance = std::min(distance, glm::length(outside));
+		}
+		return distance;
+	}
+
+	void AIScheduler::OnTargetSearch() {
+		mStats.searches++;
+	}
+
+	const AIStats& AIScheduler::GetStats() const {
+		return mStats;
+	}
+
+	uint32_t AIScheduler::GetThinkInterval(const AI& ai, float playerDistance) const {
+		if (ai.IsInCombat()) {
+			return 1;
+		} else if (playerDistance <= sNearDistance) {
+			return sNearInterval;
+		} else if (playerDistance <= sFarDistance) {
+			return sMidInterval;
+		}
+		return sMaxInterval;
+	}
+}
@@ -0,0 +1,76 @@
+
+#ifndef _GAME_AI_SCHEDULER_HEADER
+#define _GAME_AI_SCHEDULER_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+#include "Collision.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Game
+namespace Game {
+	class AI;
+
+	// AIStats
+	struct AIStats {
+		uint64_t ticks = 0;
+
+		// Last tick
+		uint32_t agents = 0;
+		uint32_t thinks = 0;
+		uint32_t searches = 0;
+		std::chrono::steady_clock::duration cost {};
+
+		// Since the instance started
+		uint64_t totalThinks = 0;
+		uint64_t totalSearches = 0;
+		std::chrono::steady_clock::duration totalCost {};
+		std::chrono::steady_clock::duration maxCost {};
+	};
+
+	// AIScheduler
+	class AIScheduler {
+		// Idle agents think less often the further away the closest player is, agents in combat think every tick.
+		static constexpr float sNearDistance = 60.f;
+		static constexpr float sFarDistance = 150.f;
+
+		// Intervals in ticks, all of them have to divide sMaxInterval so think phases stay spread.
+		static constexpr uint32_t sNearInterval = 2;
+		static constexpr uint32_t sMidInterval = 4;
+		static constexpr uint32_t sMaxInterval = 16;
+
+		public:
+			AIScheduler(Instance& game);
+
+			// Agent ids are spread over the phases of the longest interval.
+			static uint32_t GetThinkPhase(uint32_t id);
+
+			void BeginTick();
+			void EndTick();
+
+			// Lets the agent think if this tick is one of its think ticks.
+			void Run(AI& ai);
+
+			// Distance to the closest deployed player character's box, infinity without any.
+			float GetDistanceToNearestPlayer(const glm::vec3& position) const;
+
+			void OnTargetSearch();
+
+			const AIStats& GetStats() const;
+
+		private:
+			uint32_t GetThinkInterval(const AI& ai, float playerDistance) const;
+
+		private:
+			Instance& mGame;
+
+			std::vector<BoundingBox> mPlayerBoxes;
+
+			AIStats mStats;
+	};
+}
+
+#endif
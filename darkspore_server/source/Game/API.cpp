@@ -2,6 +2,9 @@
 // Include
 #include "API.h"
 #include "Config.h"
+#include "GameManager.h"
+#include "Lua.h"
+#include "LuaStatePool.h"
 
 #include "HTTP/Session.h"
 #include "HTTP/Router.h"
@@ -13,6 +16,9 @@
 #include "SporeNet/Creature.h"
 #include "SporeNet/Vendor.h"
 
+#include "RakNet/Server.h"
+
+#include "Core/Async/Executor.h"
 #include "Core/Utils/Functions.h"
 #include "Core/Utils/JSON.h"
 
@@ -339,6 +345,10 @@ namespace Game {
 				recap_game_status(session, response);
 			} else if (method == "api.game.log") {
 				recap_game_log(session, response);
+			} else if (method == "api.game.instanceStats") {
+				recap_game_instanceStats(session, response);
+			} else if (method == "api.game.luaProfile") {
+				recap_game_luaProfile(session, response);
 			} else if (method == "api.panel.listUsers") {
 				recap_panel_listUsers(session, response);
 			} else if (method == "api.panel.getUserInfo") {
@@ -845,6 +855,227 @@ namespace Game {
 		std::cout << "js.console.log: " << postBody << std::endl;
 	}
 
+	void API::recap_game_instanceStats(HTTP::Session& session, HTTP::Response& response) {
+		const auto to_microseconds = [](auto duration) {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+		};
+
+		rapidjson::Document document = utils::json::NewDocumentObject();
+		auto& allocator = document.GetAllocator();
+
+		auto instances = utils::json::NewArray();
+		for (const auto& [id, game] : GameManager::GetGames()) {
+			if (!game->IsRunning()) {
+				continue;
+			}
+
+			const auto& server = game->GetServer();
+			const auto tickStats = server.GetTickStats();
+			const auto strandStats = server.GetStrandStats();
+			const auto stats = game->GetStats();
+
+			auto instance = utils::json::NewObject();
+			utils::json::Set(instance, "id", id, allocator);
+			utils::json::Set(instance, "tickRate", server.GetTickRate(), allocator);
+			utils::json::Set(instance, "ticks", tickStats.ticks, allocator);
+			utils::json::Set(instance, "overruns", tickStats.overruns, allocator);
+			utils::json::Set(instance, "skippedTicks", tickStats.skippedTicks, allocator);
+			utils::json::Set(instance, "lastTickCostUs", to_microseconds(tickStats.lastTickCost), allocator);
+			utils::json::Set(instance, "maxTickCostUs", to_microseconds(tickStats.maxTickCost), allocator);
+			utils::json::Set(instance, "avgTickCostUs", tickStats.ticks ? to_microseconds(tickStats.totalTickCost) / tickStats.ticks : 0, allocator);
+			utils::json::Set(instance, "messagesSent", tickStats.messagesSent, allocator);
+			utils::json::Set(instance, "messagesSuperseded", tickStats.messagesSuperseded, allocator);
+			utils::json::Set(instance, "bytesSent", tickStats.bytesSent, allocator);
+			utils::json::Set(instance, "lastTickMessages", tickStats.lastTickMessages, allocator);
+			utils::json::Set(instance, "lastTickBytes", tickStats.lastTickBytes, allocator);
+			utils::json::Set(instance, "pendingMessages", tickStats.pendingMessages, allocator);
+			utils::json::Set(instance, "pendingBytes", tickStats.pendingBytes, allocator);
+			utils::json::Set(instance, "aiAgents", stats.ai.agents, allocator);
+			utils::json::Set(instance, "aiThinks", stats.ai.thinks, allocator);
+			utils::json::Set(instance, "aiSearches", stats.ai.searches, allocator);
+			utils::json::Set(instance, "aiLastTickCostUs", to_microseconds(stats.ai.cost), allocator);
+			utils::json::Set(instance, "aiMaxTickCostUs", to_microseconds(stats.ai.maxCost), allocator);
+			utils::json::Set(instance, "aiAvgTickCostUs", stats.ai.ticks ? to_microseconds(stats.ai.totalCost) / stats.ai.ticks : 0, allocator);
+			utils::json::Set(instance, "aiTotalThinks", stats.ai.totalThinks, allocator);
+			utils::json::Set(instance, "aiTotalSearches", stats.ai.totalSearches, allocator);
+			utils::json::Set(instance, "timelinePending", stats.timeline.pending, allocator);
+			utils::json::Set(instance, "timelineFired", stats.timeline.fired, allocator);
+			utils::json::Set(instance, "timelineCascaded", stats.timeline.cascaded, allocator);
+			utils::json::Set(instance, "timelineTotalFired", stats.timeline.totalFired, allocator);
+			utils::json::Set(instance, "combatEvents", stats.combat.events, allocator);
+			utils::json::Set(instance, "combatDeaths", stats.combat.deaths, allocator);
+			utils::json::Set(instance, "combatCollapsedDeaths", stats.combat.collapsedDeaths, allocator);
+			utils::json::Set(instance, "combatTotalEvents", stats.combat.totalEvents, allocator);
+			utils::json::Set(instance, "combatTotalDeaths", stats.combat.totalDeaths, allocator);
+			utils::json::Set(instance, "rewinds", stats.lagCompensation.rewinds, allocator);
+			utils::json::Set(instance, "rewoundObjects", stats.lagCompensation.rewoundObjects, allocator);
+			utils::json::Set(instance, "lastRewindMs", stats.lagCompensation.lastRewind, allocator);
+			utils::json::Set(instance, "maxRewindMs", stats.lagCompensation.maxRewind, allocator);
+			utils::json::Set(instance, "triggerVolumes", stats.triggers.triggers, allocator);
+			utils::json::Set(instance, "triggerOccupants", stats.triggers.occupants, allocator);
+			utils::json::Set(instance, "triggerChecked", stats.triggers.checked, allocator);
+			utils::json::Set(instance, "triggerEnters", stats.triggers.enters, allocator);
+			utils::json::Set(instance, "triggerExits", stats.triggers.exits, allocator);
+			utils::json::Set(instance, "triggerStays", stats.triggers.stays, allocator);
+			utils::json::Set(instance, "luaThreads", stats.lua.threads, allocator);
+			utils::json::Set(instance, "luaTimeWaits", stats.lua.timeWaits, allocator);
+			utils::json::Set(instance, "luaEventWaits", stats.lua.eventWaits, allocator);
+			utils::json::Set(instance, "luaPredicateWaits", stats.lua.predicateWaits, allocator);
+			utils::json::Set(instance, "luaWoken", stats.lua.woken, allocator);
+			utils::json::Set(instance, "luaChecked", stats.lua.checked, allocator);
+			utils::json::Set(instance, "luaResumed", stats.lua.resumed, allocator);
+			utils::json::Set(instance, "luaHeapKb", stats.luaCollector.heap, allocator);
+			utils::json::Set(instance, "luaPeakHeapKb", stats.luaCollector.peakHeap, allocator);
+			utils::json::Set(instance, "luaHeapLimitKb", stats.luaCollector.limit, allocator);
+			utils::json::Set(instance, "luaGcCycles", stats.luaCollector.cycles, allocator);
+			utils::json::Set(instance, "luaGcFullCollections", stats.luaCollector.fullCollections, allocator);
+			utils::json::Set(instance, "luaGcSteps", stats.luaCollector.steps, allocator);
+			utils::json::Set(instance, "luaGcStepUs", to_microseconds(stats.luaCollector.stepTime), allocator);
+			utils::json::Set(instance, "luaGcMaxStepUs", to_microseconds(stats.luaCollector.maxStepTime), allocator);
+			utils::json::Set(instance, "luaGcTotalUs", to_microseconds(stats.luaCollector.totalStepTime), allocator);
+			utils::json::Set(instance, "luaGcLastFullUs", to_microseconds(stats.luaCollector.lastFullTime), allocator);
+
+			auto pools = utils::json::NewArray();
+			for (const auto& poolStats : stats.pools) {
+				auto pool = utils::json::NewObject();
+				utils::json::Set(pool, "name", std::string(poolStats.name), allocator);
+				utils::json::Set(pool, "blockSize", poolStats.blockSize, allocator);
+				utils::json::Set(pool, "capacity", poolStats.capacity, allocator);
+				utils::json::Set(pool, "live", poolStats.live, allocator);
+				utils::json::Set(pool, "peak", poolStats.peak, allocator);
+				utils::json::Set(pool, "allocations", poolStats.allocations, allocator);
+				utils::json::Set(pool, "recycled", poolStats.recycled, allocator);
+				utils::json::Add(pools, pool, allocator);
+			}
+			utils::json::Set(instance, "pools", pools, allocator);
+
+			utils::json::Set(instance, "jobs", strandStats.jobs, allocator);
+			utils::json::Set(instance, "maxQueueWaitUs", to_microseconds(strandStats.maxWait), allocator);
+			utils::json::Set(instance, "avgQueueWaitUs", strandStats.jobs ? to_microseconds(strandStats.totalWait) / strandStats.jobs : 0, allocator);
+			utils::json::Add(instances, instance, allocator);
+		}
+
+		const auto luaStatePoolStats = LuaStatePool::Instance().GetStats();
+
+		auto luaStatePool = utils::json::NewObject();
+		utils::json::Set(luaStatePool, "ready", luaStatePoolStats.ready, allocator);
+		utils::json::Set(luaStatePool, "building", luaStatePoolStats.building, allocator);
+		utils::json::Set(luaStatePool, "abilities", luaStatePoolStats.abilities, allocator);
+		utils::json::Set(luaStatePool, "builds", luaStatePoolStats.builds, allocator);
+		utils::json::Set(luaStatePool, "warmAcquires", luaStatePoolStats.warmAcquires, allocator);
+		utils::json::Set(luaStatePool, "coldAcquires", luaStatePoolStats.coldAcquires, allocator);
+		utils::json::Set(luaStatePool, "lastInitUs", to_microseconds(luaStatePoolStats.lastInit), allocator);
+		utils::json::Set(luaStatePool, "lastPreloadUs", to_microseconds(luaStatePoolStats.lastPreload), allocator);
+		utils::json::Set(luaStatePool, "maxBuildUs", to_microseconds(luaStatePoolStats.maxBuild), allocator);
+		utils::json::Set(luaStatePool, "avgBuildUs", luaStatePoolStats.builds ? to_microseconds(luaStatePoolStats.totalBuild) / luaStatePoolStats.builds : 0, allocator);
+		utils::json::Set(luaStatePool, "lastAcquireUs", to_microseconds(luaStatePoolStats.lastAcquire), allocator);
+
+		utils::json::Set(document, "workers", static_cast<uint64_t>(GetApp().GetExecutor().GetThreadCount()));
+		utils::json::Set(document, "luaStatePool", luaStatePool);
+		utils::json::Set(document, "instances", instances);
+
+		response.result() = boost::beast::http::status::ok;
+		response.set(boost::beast::http::field::content_type, "application/json");
+		response.body() = utils::json::ToString(document);
+	}
+
+	void API::recap_game_luaProfile(HTTP::Session& session, HTTP::Response& response) {
+		const auto& request = session.get_request();
+
+		const auto game = GameManager::GetGame(request.uri.parameter<uint32_t>("id"));
+		if (!game || !game->IsRunning()) {
+			response.result() = boost::beast::http::status::not_found;
+			return;
+		}
+
+		// Runs start and stop on the instance strand, this only reads the last one.
+		const auto action = request.uri.parameter("action");
+		if (action == "start") {
+			auto seconds = request.uri.parameter<uint32_t>("seconds");
+			seconds = seconds ? std::min<uint32_t>(seconds, 300) : 30;
+
+			auto period = request.uri.parameter<uint32_t>("period");
+			period = period ? period : LuaProfiler::sDefaultPeriod;
+
+			game->GetServer().add_task([game, seconds, period] {
+				game->GetLua().GetProfiler().Start(std::chrono::seconds(seconds), period);
+			});
+		} else if (action == "stop") {
+			game->GetServer().add_task([game] {
+				game->GetLua().GetProfiler().Stop();
+			});
+		}
+
+		// Never touch the Lua state from here, the instance may drop it while this runs.
+		auto published = game->GetLuaProfile();
+		if (!published) {
+			published = std::make_shared<const LuaProfile>();
+		}
+
+		const auto& profile = *published;
+
+		const auto format = request.uri.parameter("format");
+		if (format == "collapsed" || format == "bindings") {
+			response.result() = boost::beast::http::status::ok;
+			response.set(boost::beast::http::field::content_type, "text/plain");
+			response.body() = format == "collapsed" ? profile.GetCollapsedStacks() : profile.GetCollapsedBindings();
+			return;
+		}
+
+		const auto to_microseconds = [](auto duration) {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+		};
+
+		auto top = request.uri.parameter<uint32_t>("top");
+		top = top ? top : 20;
+
+		rapidjson::Document document = utils::json::NewDocumentObject();
+		auto& allocator = document.GetAllocator();
+
+		auto functions = utils::json::NewArray();
+		for (const auto& entry : profile.GetTopFunctions(top)) {
+			auto function = utils::json::NewObject();
+			utils::json::Set(function, "name", entry.name, allocator);
+			utils::json::Set(function, "selfSamples", entry.selfSamples, allocator);
+			utils::json::Set(function, "totalSamples", entry.totalSamples, allocator);
+			utils::json::Add(functions, function, allocator);
+		}
+
+		auto bindings = utils::json::NewArray();
+		for (const auto& entry : profile.GetTopBindings(top)) {
+			auto binding = utils::json::NewObject();
+			utils::json::Set(binding, "name", entry.name, allocator);
+			utils::json::Set(binding, "calls", entry.calls, allocator);
+			utils::json::Set(binding, "totalUs", to_microseconds(entry.time), allocator);
+			utils::json::Set(binding, "maxUs", to_microseconds(entry.maxTime), allocator);
+			utils::json::Set(binding, "avgUs", entry.calls ? to_microseconds(entry.time) / entry.calls : 0, allocator);
+			utils::json::Add(bindings, binding, allocator);
+		}
+
+		auto abilities = utils::json::NewArray();
+		for (const auto& entry : profile.GetTopAbilities(top)) {
+			auto ability = utils::json::NewObject();
+			utils::json::Set(ability, "name", entry.name, allocator);
+			utils::json::Set(ability, "samples", entry.totalSamples, allocator);
+			utils::json::Set(ability, "nativeCalls", entry.calls, allocator);
+			utils::json::Set(ability, "nativeUs", to_microseconds(entry.time), allocator);
+			utils::json::Add(abilities, ability, allocator);
+		}
+
+		utils::json::Set(document, "running", profile.running);
+		utils::json::Set(document, "durationUs", to_microseconds(profile.duration));
+		utils::json::Set(document, "period", profile.period);
+		utils::json::Set(document, "samples", profile.samples);
+		utils::json::Set(document, "droppedSamples", profile.droppedSamples);
+		utils::json::Set(document, "functions", functions);
+		utils::json::Set(document, "bindings", bindings);
+		utils::json::Set(document, "abilities", abilities);
+
+		response.result() = boost::beast::http::status::ok;
+		response.set(boost::beast::http::field::content_type, "application/json");
+		response.body() = utils::json::ToString(document);
+	}
+
 	void API::recap_panel_listUsers(HTTP::Session& session, HTTP::Response& response) {
 		/*
 		rapidjson::Document document = utils::json::NewDocumentObject();
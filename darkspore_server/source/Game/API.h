@@ -33,6 +33,8 @@ namespace Game {
 			void recap_game_status(HTTP::Session& session, HTTP::Response& response);
 			void recap_game_registration(HTTP::Session& session, HTTP::Response& response);
 			void recap_game_log(HTTP::Session& session, HTTP::Response& response);
+			void recap_game_instanceStats(HTTP::Session& session, HTTP::Response& response);
+			void recap_game_luaProfile(HTTP::Session& session, HTTP::Response& response);
 			void recap_panel_listUsers(HTTP::Session& session, HTTP::Response& response);
 			void recap_panel_getUserInfo(HTTP::Session& session, HTTP::Response& response);
 			void recap_panel_setUserInfo(HTTP::Session& session, HTTP::Response& response);
@@ -5,19 +5,51 @@
 #include "RakNet/Server.h"
 
 #include <algorithm>
+#include <array>
+
+/*
+	Values live in a flat array indexed by AttributeType, reads are a load and writes mark the client visible ones
+	dirty for the next delta. Derived values keep a mask of the attributes they read, a write only invalidates the
+	derived values that depend on it and they are recomputed on their next read.
+*/
+
+namespace {
+	using Game::AttributeType;
+	using Game::DerivedAttribute;
+
+	struct DerivedInput {
+		DerivedAttribute derived;
+		AttributeType input;
+	};
+
+	constexpr std::array derivedInputs {
+		DerivedInput { DerivedAttribute::CombatMovementSpeed, AttributeType::CombatSpeed },
+		DerivedInput { DerivedAttribute::CombatMovementSpeed, AttributeType::MovementSpeedBuff },
+		DerivedInput { DerivedAttribute::NonCombatMovementSpeed, AttributeType::NonCombatSpeed },
+		DerivedInput { DerivedAttribute::NonCombatMovementSpeed, AttributeType::MovementSpeedBuff },
+		DerivedInput { DerivedAttribute::MovementSpeedScale, AttributeType::MovementSpeedBuff },
+		DerivedInput { DerivedAttribute::CriticalDamageScale, AttributeType::CriticalDamageIncrease },
+		DerivedInput { DerivedAttribute::HealScale, AttributeType::HealIncrease },
+		DerivedInput { DerivedAttribute::HoTHealScale, AttributeType::HealIncrease },
+		DerivedInput { DerivedAttribute::HoTHealScale, AttributeType::HoTDoneIncrease },
+		DerivedInput { DerivedAttribute::HealingTakenScale, AttributeType::HealingReduction }
+	};
+
+	// attribute -> mask of the derived values reading it
+	constexpr auto derivedDependents = [] {
+		std::array<uint32_t, static_cast<size_t>(AttributeType::Count)> dependents {};
+		for (const auto& [derived, input] : derivedInputs) {
+			dependents[static_cast<size_t>(input)] |= 1u << static_cast<uint32_t>(derived);
+		}
+		return dependents;
+	}();
+}
 
 // Game
 namespace Game {
 	// Attributes
 	float Attributes::GetValue(uint8_t idx) const {
-		// test performance some time
-		auto end = mData.end();
-		auto it = std::find_if(mData.begin(), end, [idx](const auto& data) { return std::get<0>(data) == idx; });
-		if (it != end) {
-			return std::get<1>(*it);
-		}
-
-		return 0;
+		return idx < sAttributeCount ? mValues[idx] : 0.f;
 	}
 
 	float Attributes::GetValue(AttributeType idx) const {
@@ -25,44 +57,31 @@ namespace Game {
 	}
 
 	void Attributes::SetValue(uint8_t idx, float value) {
-		auto end = mData.end();
-		auto it = std::find_if(mData.begin(), end, [idx](const auto& data) { return std::get<0>(data) == idx; });
-		if (idx < static_cast<uint8_t>(AttributeType::ClientCount)) {
-			if (it != end) {
-				if (value == 0) {
-					mData.erase(it);
-					mErasedData.push_back(idx);
-				} else {
-					std::get<1>(*it) = value;
-				}
-			} else if (value != 0) {
-				if (mDataBits.test(idx)) {
-					mErasedData.erase(std::find(mErasedData.begin(), mErasedData.end(), idx));
-				}
+		if (idx >= sAttributeCount || mValues[idx] == value) {
+			return;
+		}
 
-				mData.push_back({ idx, value });
-				std::sort(mData.begin(), mData.end(), [](const auto& lhs, const auto& rhs) { return std::get<0>(lhs) < std::get<0>(rhs); });
-			}
+		mValues[idx] = value;
+		mStaleDerived |= derivedDependents[idx];
+		if (idx < static_cast<uint8_t>(AttributeType::ClientCount)) {
 			mDataBits.set(idx);
 		}
-		/*
-		else if (it != end) {
-			if (value == 0) {
-				mData.erase(it);
-			} else {
-				std::get<1>(*it) = value;
-			}
-		} else if (value != 0) {
-			mData.push_back({ idx, value });
-			std::sort(mData.begin(), mData.end(), [](const auto& lhs, const auto& rhs) { return std::get<0>(lhs) < std::get<0>(rhs); });
-		}
-		*/
 	}
 
 	void Attributes::SetValue(AttributeType idx, float value) {
 		SetValue(static_cast<uint8_t>(idx), value);
 	}
 
+	float Attributes::GetDerivedValue(DerivedAttribute type) const {
+		const auto bit = 1u << static_cast<uint32_t>(type);
+		const auto index = static_cast<size_t>(type);
+		if (mStaleDerived & bit) {
+			mDerivedValues[index] = ComputeDerivedValue(type);
+			mStaleDerived &= ~bit;
+		}
+		return mDerivedValues[index];
+	}
+
 	std::tuple<float, float> Attributes::GetWeaponDamage() const {
 		return std::make_tuple(mMinWeaponDamage, mMaxWeaponDamage);
 	}
@@ -90,12 +109,12 @@ namespace Game {
 
 		stream.SetWriteOffset(writeOffset + bytes_to_bits(0x26C));
 		for (uint8_t i = 0; i < 0x63; ++i) {
-			Write(stream, GetValue(i));
+			Write(stream, mValues[i]);
 		}
 
 		stream.SetWriteOffset(writeOffset + bytes_to_bits(0x400));
-		for (uint8_t i = 0x63; i < mData.size(); ++i) {
-			Write(stream, GetValue(i));
+		for (uint8_t i = 0x63; i < static_cast<uint8_t>(AttributeType::ClientCount); ++i) {
+			Write(stream, mValues[i]);
 		}
 
 		stream.SetWriteOffset(writeOffset + bytes_to_bits(0x43C));
@@ -105,17 +124,20 @@ namespace Game {
 		stream.SetWriteOffset(writeOffset + size);
 	}
 
-	void Attributes::WriteReflection(RakNet::BitStream& stream) const {
+	void Attributes::WriteReflection(RakNet::BitStream& stream, bool full) const {
 		RakNet::reflection_serializer<sClientVisibleAttributeCount> reflector(stream);
 		reflector.begin();
-		for (const auto& [idx, value] : mData) {
-			if (mDataBits.test(idx)) {
-				reflector.write(idx, value);
+		if (full) {
+			// A full write starts from a client that has no values yet, zeros are implied.
+			for (uint8_t idx = 0; idx < static_cast<uint8_t>(AttributeType::ClientCount); ++idx) {
+				if (mValues[idx] != 0) {
+					reflector.write(idx, mValues[idx]);
+				}
 			}
-		}
-
-		for (const auto& idx : mErasedData) {
-			reflector.write(idx, 0.f);
+		} else {
+			ForEachChanged([&reflector](uint8_t idx, float value) {
+				reflector.write(idx, value);
+			});
 		}
 		reflector.write<111>(mMinWeaponDamage);
 		reflector.write<112>(mMaxWeaponDamage);
@@ -124,6 +146,33 @@ namespace Game {
 
 	void Attributes::ResetReflectionBits() {
 		mDataBits.reset();
-		mErasedData.clear();
+	}
+
+	float Attributes::ComputeDerivedValue(DerivedAttribute type) const {
+		switch (type) {
+			case DerivedAttribute::CombatMovementSpeed:
+				return (GetValue(AttributeType::CombatSpeed) + 1.f) * GetValue(AttributeType::MovementSpeedBuff);
+
+			case DerivedAttribute::NonCombatMovementSpeed:
+				return (GetValue(AttributeType::NonCombatSpeed) + 1.f) * GetValue(AttributeType::MovementSpeedBuff);
+
+			case DerivedAttribute::MovementSpeedScale:
+				return GetValue(AttributeType::MovementSpeedBuff) + 1.f;
+
+			case DerivedAttribute::CriticalDamageScale:
+				return GetValue(AttributeType::CriticalDamageIncrease) + 1.f;
+
+			case DerivedAttribute::HealScale:
+				return GetValue(AttributeType::HealIncrease) + 1.f;
+
+			case DerivedAttribute::HoTHealScale:
+				return GetValue(AttributeType::HealIncrease) + GetValue(AttributeType::HoTDoneIncrease) + 1.f;
+
+			case DerivedAttribute::HealingTakenScale:
+				return 1.f - GetValue(AttributeType::HealingReduction);
+
+			default:
+				return 0.f;
+		}
 	}
 }
@@ -3,11 +3,14 @@
 #define _GAME_ATTRIBUTES_HEADER
 
 // Include
+#include <array>
 #include <cstdint>
 #include <vector>
 #include <bitset>
+#include <tuple>
 
 #include "Core/Base/Predefined.h"
+#include "ObjectPool.h"
 
 // Game
 namespace Game {
@@ -300,13 +303,26 @@ namespace Game {
 		Count
 	};
 
+	// DerivedAttribute, values combined from several attributes. Each one is cached until one of its inputs changes.
+	enum class DerivedAttribute : uint8_t {
+		CombatMovementSpeed = 0,
+		NonCombatMovementSpeed,
+		MovementSpeedScale,
+		CriticalDamageScale,
+		HealScale,
+		HoTHealScale,
+		HealingTakenScale,
+		Count
+	};
+
 	// Attributes
-	class Attributes {
+	class Attributes : public Pooled {
+		static constexpr size_t sAttributeCount = static_cast<size_t>(AttributeType::Count);
+		static constexpr size_t sDerivedCount = static_cast<size_t>(DerivedAttribute::Count);
+
 		public:
 			Attributes() = default;
 
-			const auto& GetData() const { return mData; }
-			const auto& GetErasedData() const { return mErasedData; }
 			const auto& GetDataBits() const { return mDataBits; }
 
 			float GetValue(uint8_t idx) const;
@@ -314,6 +330,18 @@ namespace Game {
 			void SetValue(uint8_t idx, float value);
 			void SetValue(AttributeType idx, float value);
 
+			float GetDerivedValue(DerivedAttribute type) const;
+
+			// Calls writer(idx, value) for every client visible attribute changed since the last reset, cleared ones as 0.
+			template<typename Writer>
+			void ForEachChanged(Writer&& writer) const {
+				for (uint8_t idx = 0; idx < static_cast<uint8_t>(AttributeType::ClientCount); ++idx) {
+					if (mDataBits.test(idx)) {
+						writer(idx, mValues[idx]);
+					}
+				}
+			}
+
 			std::tuple<float, float> GetWeaponDamage() const;
 			void SetWeaponDamage(float minDamage, float maxDamage);
 
@@ -321,17 +349,24 @@ namespace Game {
 			void SetOwnerObject(const ObjectPtr& object);
 
 			void WriteTo(RakNet::BitStream& stream) const;
-			void WriteReflection(RakNet::BitStream& stream) const;
+			void WriteReflection(RakNet::BitStream& stream, bool full = false) const;
 
 			void ResetReflectionBits();
 
 		private:
 			static constexpr uint8_t sClientVisibleAttributeCount = static_cast<uint8_t>(AttributeType::ClientCount) + 2;
 
+			float ComputeDerivedValue(DerivedAttribute type) const;
+
+		private:
+			// One cache line per 16 values, indexed by AttributeType, server only attributes included.
+			alignas(64) std::array<float, sAttributeCount> mValues {};
+
+			mutable std::array<float, sDerivedCount> mDerivedValues {};
+			mutable uint32_t mStaleDerived = (1u << sDerivedCount) - 1;
+
 			ObjectPtr::weak_type mOwnerObject;
 
-			std::vector<std::tuple<uint8_t, float>> mData;
-			std::vector<uint8_t> mErasedData;
 			std::bitset<sClientVisibleAttributeCount> mDataBits;
 
 			float mMinWeaponDamage = 0;
@@ -171,24 +171,15 @@ namespace Game {
 		}
 
 		constexpr uint8_t attributeFieldOffset = 13;
-		const auto& attrData = mPartAttributes.GetData();
-		if (!attrData.empty()) {
-			const auto& attrDataBits = mPartAttributes.GetDataBits();
-			for (const auto& [idx, value] : attrData) {
-				if (attrDataBits.test(idx)) {
-					reflector.write(attributeFieldOffset + idx, value);
-				}
-			}
-		}
-
-		for (const auto& idx : mPartAttributes.GetErasedData()) {
-			reflector.write(attributeFieldOffset + idx, 0.f);
-		}
+		mPartAttributes.ForEachChanged([&reflector](uint8_t idx, float value) {
+			reflector.write(attributeFieldOffset + idx, value);
+		});
 
 		reflector.end();
 	}
 
 	void Character::ResetUpdateBits() {
 		mDataBits.reset();
+		mPartAttributes.ResetReflectionBits();
 	}
 }
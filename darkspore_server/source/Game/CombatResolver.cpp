@@ -0,0 +1,137 @@
+
+// Include
+#include "CombatResolver.h"
+#include "Instance.h"
+#include "InterestManager.h"
+#include "Object.h"
+
+#include "RakNet/Server.h"
+
+#include <algorithm>
+
+/*
+	Damage and heals still change health when the script asks for them, abilities read the result on the spot.
+	What they fan out is held until the end of the tick: a piercing projectile or an AoE hitting thirty targets
+	queues thirty events, targets taking several killing blows die once, and targets healed back up before the
+	tick ends do not die at all. Resolution goes in target id order so the outcome does not depend on the order
+	scripts happened to run in, and each target's events go out to the clients that know it in one pass.
+*/
+
+// Game
+namespace Game {
+	// CombatResolver
+	CombatResolver::CombatResolver(Instance& game) : mGame(game) {}
+
+	void CombatResolver::QueueDamage(const ObjectPtr& target, uint32_t sourceId, float damage, bool critical, bool killingBlow, const glm::vec3& direction) {
+		if (!target) {
+			return;
+		}
+
+		auto& queued = mEvents.emplace_back();
+		queued.target = target;
+
+		auto& event = queued.event;
+		event.mTargetId = target->GetId();
+		event.mSourceId = sourceId;
+		event.mDirection = direction;
+		event.mDeltaHealth = damage;
+		event.mIntegerHpChange = static_cast<int32_t>(damage);
+		event.mFlags = static_cast<CombatEventFlags>(
+			(critical ? static_cast<uint32_t>(CombatEventFlags::Critical) : 0) |
+			(killingBlow ? static_cast<uint32_t>(CombatEventFlags::KillingBlow) : 0)
+		);
+
+		if (killingBlow) {
+			mDeaths.push_back({ target, critical });
+		}
+	}
+
+	void CombatResolver::QueueHeal(const ObjectPtr& target, uint32_t sourceId, float value, bool critical) {
+		if (!target) {
+			return;
+		}
+
+		auto& queued = mEvents.emplace_back();
+		queued.target = target;
+
+		auto& event = queued.event;
+		event.mTargetId = target->GetId();
+		event.mSourceId = sourceId;
+		event.mDeltaHealth = value;
+		event.mIntegerHpChange = static_cast<int32_t>(value);
+		event.mFlags = critical ? CombatEventFlags::Critical : CombatEventFlags::None;
+	}
+
+	void CombatResolver::Resolve() {
+		mStats.events = 0;
+		mStats.deaths = 0;
+		mStats.collapsedDeaths = 0;
+		if (mEvents.empty() && mDeaths.empty()) {
+			return;
+		}
+
+		// Taken out first, death handling runs scripts and whatever they queue is resolved next tick.
+		static thread_local std::vector<QueuedEvent> events;
+		static thread_local std::vector<QueuedDeath> deaths;
+		events.clear();
+		deaths.clear();
+		events.swap(mEvents);
+		deaths.swap(mDeaths);
+
+		const auto byTarget = [](const auto& lhs, const auto& rhs) {
+			return lhs.target->GetId() < rhs.target->GetId();
+		};
+
+		// The first killing blow decides how a target dies.
+		std::stable_sort(deaths.begin(), deaths.end(), byTarget);
+		for (size_t i = 0; i < deaths.size(); ++i) {
+			const auto& [target, critical] = deaths[i];
+			if (i > 0 && deaths[i - 1].target == target) {
+				mStats.collapsedDeaths++;
+				continue;
+			}
+
+			if (target->IsMarkedForDeletion() || (target->HasCombatantData() && target->GetHealth() > 0)) {
+				continue;
+			}
+
+			mGame.OnObjectDeath(target, critical, false);
+			mStats.deaths++;
+		}
+
+		// Events keep the order they happened in for each target.
+		std::stable_sort(events.begin(), events.end(), byTarget);
+
+		auto& interestManager = mGame.GetInterestManager();
+		auto& server = mGame.GetServer();
+		for (size_t i = 0; i < events.size();) {
+			const auto& target = events[i].target;
+
+			size_t end = i + 1;
+			while (end < events.size() && events[end].target == target) {
+				++end;
+			}
+
+			const auto& recipients = interestManager.GetRecipients(target);
+			if (!recipients.empty()) {
+				for (; i < end; ++i) {
+					server.SendCombatEvent(recipients, events[i].event);
+				}
+			}
+
+			i = end;
+		}
+
+		mStats.events = static_cast<uint32_t>(events.size());
+		mStats.totalEvents += mStats.events;
+		mStats.totalDeaths += mStats.deaths;
+
+		// Nothing holds on to the objects past the tick.
+		events.clear();
+		deaths.clear();
+	}
+
+	const CombatStats& CombatResolver::GetStats() const {
+		return mStats;
+	}
+}
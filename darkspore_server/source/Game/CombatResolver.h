@@ -0,0 +1,66 @@
+
+#ifndef _GAME_COMBAT_RESOLVER_HEADER
+#define _GAME_COMBAT_RESOLVER_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+#include "ServerEvent.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Game
+namespace Game {
+	class Object;
+
+	using ObjectPtr = std::shared_ptr<Object>;
+
+	// CombatStats
+	struct CombatStats {
+		// Last tick
+		uint32_t events = 0;
+		uint32_t deaths = 0;
+		uint32_t collapsedDeaths = 0;
+
+		// Since the instance started
+		uint64_t totalEvents = 0;
+		uint64_t totalDeaths = 0;
+	};
+
+	// CombatResolver
+	class CombatResolver {
+		public:
+			CombatResolver(Instance& game);
+
+			// Health changes are applied right away so scripts can read the result, everything they fan out waits for Resolve.
+			void QueueDamage(const ObjectPtr& target, uint32_t sourceId, float damage, bool critical, bool killingBlow, const glm::vec3& direction);
+			void QueueHeal(const ObjectPtr& target, uint32_t sourceId, float value, bool critical);
+
+			// Handles deaths once per target and hands every client its combat events for the tick in one go.
+			void Resolve();
+
+			const CombatStats& GetStats() const;
+
+		private:
+			struct QueuedEvent {
+				ObjectPtr target;
+				CombatEvent event;
+			};
+
+			struct QueuedDeath {
+				ObjectPtr target;
+				bool critical;
+			};
+
+		private:
+			Instance& mGame;
+
+			std::vector<QueuedEvent> mEvents;
+			std::vector<QueuedDeath> mDeaths;
+
+			CombatStats mStats;
+	};
+}
+
+#endif
@@ -74,6 +74,30 @@ namespace Game {
 				mConfig[CONFIG_TEMPLATE_CREATURE_PATH] = value;
 			} else if (name == "TEMPLATE_CREATURE_PARTS_PATH") {
 				mConfig[CONFIG_TEMPLATE_CREATURE_PARTS_PATH] = value;
+			} else if (name == "GAME_TICK_RATE") {
+				mConfig[CONFIG_GAME_TICK_RATE] = value;
+			} else if (name == "GAME_TICK_CATCH_UP") {
+				mConfig[CONFIG_GAME_TICK_CATCH_UP] = value;
+			} else if (name == "GAME_WORKER_THREADS") {
+				mConfig[CONFIG_GAME_WORKER_THREADS] = value;
+			} else if (name == "PACKET_POLICY_PATH") {
+				mConfig[CONFIG_PACKET_POLICY_PATH] = value;
+			} else if (name == "GAME_RELEVANCE_RADIUS") {
+				mConfig[CONFIG_GAME_RELEVANCE_RADIUS] = value;
+			} else if (name == "GAME_CLIENT_BUDGET") {
+				mConfig[CONFIG_GAME_CLIENT_BUDGET] = value;
+			} else if (name == "GAME_SPATIAL_INDEX") {
+				mConfig[CONFIG_GAME_SPATIAL_INDEX] = value;
+			} else if (name == "GAME_PATH_BUDGET") {
+				mConfig[CONFIG_GAME_PATH_BUDGET] = value;
+			} else if (name == "GAME_MAX_REWIND") {
+				mConfig[CONFIG_GAME_MAX_REWIND] = value;
+			} else if (name == "GAME_LUA_STATES") {
+				mConfig[CONFIG_GAME_LUA_STATES] = value;
+			} else if (name == "GAME_LUA_GC_BUDGET") {
+				mConfig[CONFIG_GAME_LUA_GC_BUDGET] = value;
+			} else if (name == "GAME_LUA_GC_LIMIT") {
+				mConfig[CONFIG_GAME_LUA_GC_LIMIT] = value;
 			} else {
 				std::cout << "Game::Config: Unknown config value '" << name << "'" << std::endl;
 			}
@@ -97,6 +121,18 @@ namespace Game {
 		mConfig[CONFIG_DARKSPORE_INDEX_PAGE_PATH] = "index.html";
 		mConfig[CONFIG_TEMPLATE_CREATURE_PATH] = "data/creature_templates.json";
 		mConfig[CONFIG_TEMPLATE_CREATURE_PARTS_PATH] = "data/creature_parts_templates.json";
+		mConfig[CONFIG_GAME_TICK_RATE] = "20";
+		mConfig[CONFIG_GAME_TICK_CATCH_UP] = "true";
+		mConfig[CONFIG_GAME_WORKER_THREADS] = "0";
+		mConfig[CONFIG_PACKET_POLICY_PATH] = "data/packet_policies.xml";
+		mConfig[CONFIG_GAME_RELEVANCE_RADIUS] = "100";
+		mConfig[CONFIG_GAME_CLIENT_BUDGET] = "8192";
+		mConfig[CONFIG_GAME_SPATIAL_INDEX] = "grid";
+		mConfig[CONFIG_GAME_PATH_BUDGET] = "1000";
+		mConfig[CONFIG_GAME_MAX_REWIND] = "250";
+		mConfig[CONFIG_GAME_LUA_STATES] = "2";
+		mConfig[CONFIG_GAME_LUA_GC_BUDGET] = "500";
+		mConfig[CONFIG_GAME_LUA_GC_LIMIT] = "131072";
 
 		pugi::xml_document document;
 		if (auto parse_result = document.load_file(path.c_str())) {
@@ -172,6 +208,18 @@ namespace Game {
 				case CONFIG_DARKSPORE_INDEX_PAGE_PATH: return "DARKSPORE_INDEX_PAGE_PATH";
 				case CONFIG_TEMPLATE_CREATURE_PATH: return "TEMPLATE_CREATURE_PATH";
 				case CONFIG_TEMPLATE_CREATURE_PARTS_PATH: return "TEMPLATE_CREATURE_PARTS_PATH";
+				case CONFIG_GAME_TICK_RATE: return "GAME_TICK_RATE";
+				case CONFIG_GAME_TICK_CATCH_UP: return "GAME_TICK_CATCH_UP";
+				case CONFIG_GAME_WORKER_THREADS: return "GAME_WORKER_THREADS";
+				case CONFIG_PACKET_POLICY_PATH: return "PACKET_POLICY_PATH";
+				case CONFIG_GAME_RELEVANCE_RADIUS: return "GAME_RELEVANCE_RADIUS";
+				case CONFIG_GAME_CLIENT_BUDGET: return "GAME_CLIENT_BUDGET";
+				case CONFIG_GAME_SPATIAL_INDEX: return "GAME_SPATIAL_INDEX";
+				case CONFIG_GAME_PATH_BUDGET: return "GAME_PATH_BUDGET";
+				case CONFIG_GAME_MAX_REWIND: return "GAME_MAX_REWIND";
+				case CONFIG_GAME_LUA_STATES: return "GAME_LUA_STATES";
+				case CONFIG_GAME_LUA_GC_BUDGET: return "GAME_LUA_GC_BUDGET";
+				case CONFIG_GAME_LUA_GC_LIMIT: return "GAME_LUA_GC_LIMIT";
 				default: return "UNKNOWN";
 			}
 		};
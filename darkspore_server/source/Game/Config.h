@@ -29,6 +29,18 @@ namespace Game {
 		CONFIG_DARKSPORE_INDEX_PAGE_PATH,
 		CONFIG_TEMPLATE_CREATURE_PATH,
 		CONFIG_TEMPLATE_CREATURE_PARTS_PATH,
+		CONFIG_GAME_TICK_RATE,
+		CONFIG_GAME_TICK_CATCH_UP,
+		CONFIG_GAME_WORKER_THREADS,
+		CONFIG_PACKET_POLICY_PATH,
+		CONFIG_GAME_RELEVANCE_RADIUS,
+		CONFIG_GAME_CLIENT_BUDGET,
+		CONFIG_GAME_SPATIAL_INDEX,
+		CONFIG_GAME_PATH_BUDGET,
+		CONFIG_GAME_MAX_REWIND,
+		CONFIG_GAME_LUA_STATES,
+		CONFIG_GAME_LUA_GC_BUDGET,
+		CONFIG_GAME_LUA_GC_LIMIT,
 		CONFIG_END
 	};
 
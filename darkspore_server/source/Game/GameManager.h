@@ -26,6 +26,8 @@ namespace Game {
 			static InstancePtr GetGame(uint32_t id);
 			static void StartGame(uint32_t id);
 
+			static const auto& GetGames() { return sGames; }
+
 			// Matchmaking
 			static Matchmaking& StartMatchmaking();
 
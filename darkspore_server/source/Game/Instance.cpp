@@ -3,7 +3,9 @@
 #include "Instance.h"
 
 #include "ObjectManager.h"
+#include "InterestManager.h"
 #include "Lua.h"
+#include "LuaStatePool.h"
 #include "ServerEvent.h"
 #include "Catalyst.h"
 #include "Core/Async/Scheduler.h"
@@ -15,6 +17,8 @@
 
 #include <iostream>
 #include <array>
+#include <optional>
+#include <format>
 
 /*
 	eeh... maybe not
@@ -84,7 +88,12 @@ namespace Game {
 		Stop();
 
 		mObjectManager = std::make_unique<ObjectManager>(*this);
-		mLua = std::make_unique<Lua>(*this);
+		mInterestManager = std::make_unique<InterestManager>(*this);
+		mLua = LuaStatePool::Instance().Acquire(*this);
+		mPathfinder = std::make_unique<Pathfinder>();
+		mPathfinder->SetGrid(mNavigationGrid);
+		mTimeline = std::make_unique<Timeline>(utils::get_milliseconds());
+		mCombatResolver = std::make_unique<CombatResolver>(*this);
 		mServer = std::make_unique<RakNet::Server>(*this);
 
 		std::cout << "[RakNet] starting on IP "
@@ -94,10 +103,6 @@ namespace Game {
 							
 		mServer->start(mData.hostNetwork.exip.port);
 		mGameStartTime = utils::get_milliseconds();
-
-		mServer->add_task([this] {
-			mLua->Initialize();
-		});
 		return true;
 	}
 
@@ -116,10 +121,18 @@ namespace Game {
 		}
 
 		mServer.reset();
+		mPathfinder.reset();
+		mTimeline.reset();
+		mCombatResolver.reset();
 		mLua.reset();
+		mInterestManager.reset();
 		mObjectManager.reset();
 	}
 
+	bool Instance::IsRunning() const {
+		return mServer && mServer->is_running();
+	}
+
 	bool Instance::LoadLevel() {
 		if (mLevelLoaded) {
 			return true;
@@ -177,6 +190,16 @@ namespace Game {
 					}
 				}
 			}
+
+			mNavigationGrid = NavigationGrid::Get(std::format("{}/{}", mChainData.GetDifficultyName(), levelName), mLevel);
+			if (mPathfinder) {
+				mPathfinder->SetGrid(mNavigationGrid);
+			}
+
+			// Whatever the previous level left behind goes now, not in steps during the fight.
+			if (mLua) {
+				mLua->GetCollector().Collect();
+			}
 		}
 
 		return mLevelLoaded;
@@ -238,6 +261,14 @@ namespace Game {
 		return *mObjectManager;
 	}
 
+	InterestManager& Instance::GetInterestManager() {
+		return *mInterestManager;
+	}
+
+	const InterestManager& Instance::GetInterestManager() const {
+		return *mInterestManager;
+	}
+
 	Lua& Instance::GetLua() {
 		return *mLua;
 	}
@@ -245,6 +276,45 @@ namespace Game {
 	const Lua& Instance::GetLua() const {
 		return *mLua;
 	}
+
+	InstanceStats Instance::GetStats() const {
+		std::lock_guard<std::mutex> lock(mStatsMutex);
+		return mStats;
+	}
+
+	std::shared_ptr<const LuaProfile> Instance::GetLuaProfile() const {
+		std::lock_guard<std::mutex> lock(mLuaProfileMutex);
+		return mLuaProfile;
+	}
+
+	void Instance::SetLuaProfile(std::shared_ptr<const LuaProfile> profile) {
+		std::lock_guard<std::mutex> lock(mLuaProfileMutex);
+		mLuaProfile = std::move(profile);
+	}
+
+	Pathfinder& Instance::GetPathfinder() {
+		return *mPathfinder;
+	}
+
+	const Pathfinder& Instance::GetPathfinder() const {
+		return *mPathfinder;
+	}
+
+	Timeline& Instance::GetTimeline() {
+		return *mTimeline;
+	}
+
+	const Timeline& Instance::GetTimeline() const {
+		return *mTimeline;
+	}
+
+	CombatResolver& Instance::GetCombatResolver() {
+		return *mCombatResolver;
+	}
+
+	const CombatResolver& Instance::GetCombatResolver() const {
+		return *mCombatResolver;
+	}
 	
 	void Instance::AddServerTask(std::function<void(void)> task) {
 		mServer->add_task(std::move(task));
@@ -268,6 +338,7 @@ namespace Game {
 		}
 
 		SendObjectGfxState(object, utils::hash_id("dead"));
+		OnLuaEvent(LuaEvent::Death, object->GetId());
 
 		const auto& noun = object->GetNoun();
 		if (noun) {
@@ -305,10 +376,15 @@ namespace Game {
 		}
 	}
 
+	void Instance::OnLuaEvent(LuaEvent event, uint32_t objectId) {
+		if (mLua) {
+			mLua->GetScheduler().Notify(event, objectId);
+		}
+	}
+
 	void Instance::OnPlayerStart(const PlayerPtr& player) {
 		std::cout << "Player Start" << std::endl;
 
-		mLua->PreloadAbilities();
 		mGameStarted = LoadLevel();
 
 		if (mGameStarted) {
@@ -400,7 +476,7 @@ namespace Game {
 				mServer->SendObjectiveUpdate(client, i, 0);
 			}
 
-			// Create all existing objects
+			// Create all existing objects, the ones around the player are sent at the end.
 			for (const auto& object : mObjectManager->GetActiveObjects()) {
 				// Create object in client
 				SendObjectCreate(object);
@@ -432,6 +508,11 @@ namespace Game {
 
 			SendObjectUpdate(characterObject);
 		}
+
+		// Everything that was created before this player joined and is relevant at the spawn point.
+		if (client) {
+			mInterestManager->Update(client);
+		}
 	}
 
 	uint32_t Instance::AddTask(uint32_t delay, std::function<void(uint32_t)> task) {
@@ -445,39 +526,34 @@ namespace Game {
 		mEvents.erase(id);
 	}
 
-	bool Instance::ServerUpdate() const {
-		return (utils::get_milliseconds() - mGameTime) >= 10;
-	}
-
-	bool Instance::Update() {
+	void Instance::Update(float deltaTime) {
 		// It is safe to send packets in this function.
-		auto newGameTime = utils::get_milliseconds();
-
-		if (auto delta = (newGameTime - mGameTimeLua); delta >= 1) {
-			mGameTimeLua = newGameTime;
-			mLua->Update();
+		mGameTime = utils::get_milliseconds();
+
+		// Threads whose timers run out this tick resume in it.
+		UpdateTimeline();
+		mLua->Update();
+		mPathfinder->Update();
+		mObjectManager->Update(deltaTime);
+		mCombatResolver->Resolve();
+		mInterestManager->Update();
+		for (const auto& [_, player] : mPlayers) {
+			SendLabsPlayerUpdate(player);
 		}
 
-		if (auto delta = (newGameTime - mGameTime); delta >= 50) {
-			mGameTime = newGameTime;
-			mObjectManager->Update(delta / 1000.f); // Maybe send update time so we can compensate for lag?
-			for (const auto& [_, player] : mPlayers) {
-				SendLabsPlayerUpdate(player);
-			}
-
-			const auto& client = mServer->GetClient(static_cast<uint8_t>(0));
-			if (client) {
-				auto& objective = mObjectives.front();
-				if (objective.id == utils::hash_id("FinishLevelQuickly")) {
-					objective.value = static_cast<uint32_t>(GetTimeElapsed() / 1000);
-					mServer->SendObjectiveUpdate(client, 0, utils::hash_id("vo_ship_obelisk_accessed"));
-				}
+		const auto& client = mServer->GetClient(static_cast<uint8_t>(0));
+		if (client) {
+			auto& objective = mObjectives.front();
+			if (objective.id == utils::hash_id("FinishLevelQuickly")) {
+				objective.value = static_cast<uint32_t>(GetTimeElapsed() / 1000);
+				mServer->SendObjectiveUpdate(client, 0, utils::hash_id("vo_ship_obelisk_accessed"));
 			}
-
-			return true;
 		}
 
-		return false;
+		// Once the tick did its work, with whatever it left of its budget.
+		mLua->GetCollector().Step();
+
+		UpdateStats();
 	}
 
 	void Instance::MoveObject(const ObjectPtr& object, const Locomotion& locomotionData) {
@@ -493,18 +569,14 @@ namespace Game {
 		bool teleport = goalFlags & 0x020;
 		if (teleport) {
 			object->SetPosition(locomotionData.GetGoalPosition());
-			for (const auto& [_, client] : mServer->GetClients()) {
-				mServer->SendObjectTeleport(client, object, object->GetPosition(), object->GetOrientation());
-			}
+			mServer->SendObjectTeleport(mInterestManager->GetRecipients(object), object, object->GetPosition(), object->GetOrientation());
 		} else {
 			object->SetPosition(locomotionData.GetPartialGoalPosition());
-			for (const auto& [_, client] : mServer->GetClients()) {
-				mServer->SendObjectPlayerMove(client, object, locomotionData);
-			}
+			mServer->SendObjectPlayerMove(mInterestManager->GetRecipients(object), object, locomotionData);
 		}
 	}
 
-	void Instance::UseAbility(const ObjectPtr& object, const RakNet::CombatData& combatData) {
+	void Instance::UseAbility(const ObjectPtr& object, const RakNet::CombatData& combatData, uint32_t rewind) {
 		if (!object) {
 			return;
 		}
@@ -515,6 +587,12 @@ namespace Game {
 
 		const auto& ability = mLua->GetAbility(combatData.abilityId);
 		if (ability) {
+			// Everything the ability checks synchronously sees other objects where the client saw them.
+			std::optional<LagCompensation::Rewind> rewound;
+			if (rewind > 0) {
+				rewound.emplace(mObjectManager->GetLagCompensation(), object, GetTime() - std::min<uint64_t>(rewind, GetTime()));
+			}
+
 			// ability:tick(object, target, cursorPosition, rank)
 			ability->Tick(object, mObjectManager->Get(combatData.targetId), combatData.cursorPosition, combatData.abilityRank);
 		}
@@ -661,10 +739,9 @@ namespace Game {
 			interactableData->SetAbility(utils::hash_id("PickUpLoot"));
 
 			if (SendObjectCreate(object)) {
-				for (const auto& [_, client] : clients) {
-					mServer->SendLootDataUpdate(client, object, *lootData);
-					mServer->SendInteractableDataUpdate(client, object, *interactableData);
-				}
+				const RakNet::Recipients recipients(mInterestManager->GetRecipients(object));
+				mServer->SendLootDataUpdate(recipients, object, *lootData);
+				mServer->SendInteractableDataUpdate(recipients, object, *interactableData);
 			}
 
 			mObjects.push_back(std::move(object));
@@ -832,10 +909,9 @@ namespace Game {
 			interactableData->SetAbility(utils::hash_id("PickUpLoot"));
 
 			if (SendObjectCreate(object)) {
-				for (const auto& [_, client] : clients) {
-					mServer->SendLootDataUpdate(client, object, *lootData);
-					mServer->SendInteractableDataUpdate(client, object, *interactableData);
-				}
+				const RakNet::Recipients recipients(mInterestManager->GetRecipients(object));
+				mServer->SendLootDataUpdate(recipients, object, *lootData);
+				mServer->SendInteractableDataUpdate(recipients, object, *interactableData);
 			}
 
 			mObjects.push_back(std::move(object));
@@ -886,9 +962,7 @@ namespace Game {
 			return false;
 		}
 #if 0
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendObjectCreate(client, object);
-		}
+		mServer->SendObjectCreate(RakNet::Recipients::All(), object);
 #else
 		if (!mGameStarted) {
 			return false;
@@ -899,8 +973,9 @@ namespace Game {
 			return true;
 		}
 
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendObjectCreate(client, object);
+		const auto& recipients = mInterestManager->Publish(object);
+		if (!recipients.empty()) {
+			mServer->SendObjectCreate(recipients, object);
 		}
 
 		object->SetFlags(flags | Object::Created);
@@ -910,15 +985,11 @@ namespace Game {
 	}
 
 	void Instance::SendObjectDelete(const ObjectPtr& object) {
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendObjectDelete(client, object);
-		}
+		mInterestManager->Forget(object);
 	}
 
 	void Instance::SendObjectDelete(const std::vector<ObjectPtr>& objects) {
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendObjectDelete(client, objects);
-		}
+		mInterestManager->Forget(objects);
 	}
 
 	void Instance::SendObjectUpdate(const ObjectPtr& object) {
@@ -926,64 +997,75 @@ namespace Game {
 			return;
 		}
 
-		auto flags = object->GetFlags();
-		auto newFlags = flags;
-
 		for (const auto& [_, client] : mServer->GetClients()) {
 			const auto& player = client->GetPlayer();
-			if (object == player->GetDeployedCharacterObject()) {
+			if (player && object == player->GetDeployedCharacterObject()) {
 				player->SyncCharacterData();
 			}
+		}
 
-			if (object->mDataBits.any()) {
-				mServer->SendObjectUpdate(client, object);
-			}
+		// Clients that do not know the object get its full state once it becomes relevant to them.
+		auto flags = object->GetFlags();
 
-			if (flags & Object::UpdateCombatant) {
-				mServer->SendCombatantDataUpdate(client, object, *object->GetCombatantData());
-				newFlags &= ~Object::UpdateCombatant;
-			}
+		const auto& clients = mInterestManager->GetRecipients(object);
+		if (clients.empty()) {
+			object->SetFlags(flags & ~Object::UpdateFlags);
+			object->ResetUpdateBits();
+			return;
+		}
 
-			if (flags & Object::UpdateAttributes) {
-				mServer->SendAttributeDataUpdate(client, object, *object->GetAttributeData());
-				newFlags &= ~Object::UpdateAttributes;
-			}
+		// None of these messages carry per-client data, each one is serialized once for every client that knows the object.
+		const RakNet::Recipients recipients(clients);
 
-			if (flags & Object::UpdateLootData) {
-				mServer->SendLootDataUpdate(client, object, *object->GetLootData());
-				newFlags &= ~Object::UpdateLootData;
-			}
+		if (object->mDataBits.any()) {
+			mServer->SendObjectUpdate(recipients, object);
+		}
 
-			if (flags & Object::UpdateAgentBlackboardData) {
-				mServer->SendAgentBlackboardUpdate(client, object, *object->GetAgentBlackboardData());
-				newFlags &= ~Object::UpdateAgentBlackboardData;
-			}
+		if (flags & Object::UpdateCombatant) {
+			mServer->SendCombatantDataUpdate(recipients, object, *object->GetCombatantData());
+			flags &= ~Object::UpdateCombatant;
+		}
 
-			if (flags & Object::UpdateInteractableData) {
-				mServer->SendInteractableDataUpdate(client, object, *object->GetInteractableData());
-				newFlags &= ~Object::UpdateInteractableData;
-			}
+		if (flags & Object::UpdateAttributes) {
+			mServer->SendAttributeDataUpdate(recipients, object, *object->GetAttributeData());
+			object->GetAttributeData()->ResetReflectionBits();
+			flags &= ~Object::UpdateAttributes;
+		}
+
+		if (flags & Object::UpdateLootData) {
+			mServer->SendLootDataUpdate(recipients, object, *object->GetLootData());
+			flags &= ~Object::UpdateLootData;
+		}
 
-			if (flags & Object::UpdateLocomotion) {
-				const auto& locomotion = object->GetLocomotionData();
-				if (object->IsPlayerControlled()) {
-					mServer->SendObjectPlayerMove(client, object, *locomotion);
+		if (flags & Object::UpdateAgentBlackboardData) {
+			mServer->SendAgentBlackboardUpdate(recipients, object, *object->GetAgentBlackboardData());
+			flags &= ~Object::UpdateAgentBlackboardData;
+		}
+
+		if (flags & Object::UpdateInteractableData) {
+			mServer->SendInteractableDataUpdate(recipients, object, *object->GetInteractableData());
+			flags &= ~Object::UpdateInteractableData;
+		}
+
+		if (flags & Object::UpdateLocomotion) {
+			const auto& locomotion = object->GetLocomotionData();
+			if (object->IsPlayerControlled()) {
+				mServer->SendObjectPlayerMove(recipients, object, *locomotion);
+			} else {
+				if (locomotion->GetGoalFlags() & 0x20) {
+					mServer->SendObjectTeleport(recipients, object, object->GetPosition(), locomotion->GetFacing());
 				} else {
-					if (locomotion->GetGoalFlags() & 0x20) {
-						mServer->SendObjectTeleport(client, object, object->GetPosition(), locomotion->GetFacing());
-					} else {
 #if 0 // If unreliable update
-						mServer->SendLocomotionDataUnreliableUpdate(client, object, locomotion->GetGoalPosition());
+					mServer->SendLocomotionDataUnreliableUpdate(recipients, object, locomotion->GetGoalPosition());
 #else
-						mServer->SendLocomotionDataUpdate(client, object, *locomotion);
+					mServer->SendLocomotionDataUpdate(recipients, object, *locomotion);
 #endif
-					}
 				}
-				newFlags &= ~Object::UpdateLocomotion;
 			}
+			flags &= ~Object::UpdateLocomotion;
 		}
 
-		object->SetFlags(newFlags);
+		object->SetFlags(flags);
 		object->ResetUpdateBits();
 	}
 
@@ -998,9 +1080,7 @@ namespace Game {
 			object->mLastAnimationPlayTime = timestamp;
 		}
 
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendAnimationState(client, object, state, timestamp, overlay, scale);
-		}
+		mServer->SendAnimationState(mInterestManager->GetRecipients(object), object, state, timestamp, overlay, scale);
 	}
 
 	void Instance::SendObjectGfxState(const ObjectPtr& object, uint32_t state) {
@@ -1012,9 +1092,7 @@ namespace Game {
 		object->mGraphicsState = state;
 		object->mGraphicsStateStartTime = timestamp;
 
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendObjectGfxState(client, object, state, timestamp);
-		}
+		mServer->SendObjectGfxState(mInterestManager->GetRecipients(object), object, state, timestamp);
 	}
 
 	void Instance::SendServerEvent(const ServerEventBase& serverEvent) {
@@ -1022,9 +1100,7 @@ namespace Game {
 			return;
 		}
 
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendServerEvent(client, serverEvent);
-		}
+		mServer->SendServerEvent(RakNet::Recipients::All(), serverEvent);
 	}
 
 	void Instance::SendServerEvent(const PlayerPtr& player, const ServerEventBase& serverEvent) {
@@ -1039,9 +1115,7 @@ namespace Game {
 	}
 
 	void Instance::SendCombatEvent(const CombatEvent& combatEvent) {
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendCombatEvent(client, combatEvent);
-		}
+		mServer->SendCombatEvent(RakNet::Recipients::All(), combatEvent);
 	}
 
 	void Instance::SendCooldownUpdate(const ObjectPtr& object, uint32_t id, uint64_t start, uint32_t duration) {
@@ -1049,9 +1123,7 @@ namespace Game {
 			return;
 		}
 
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendCooldownUpdate(client, object, id, start, duration);
-		}
+		mServer->SendCooldownUpdate(mInterestManager->GetRecipients(object), object, id, start, duration);
 	}
 
 	void Instance::SendLabsPlayerUpdate(const PlayerPtr& player) {
@@ -1059,9 +1131,7 @@ namespace Game {
 			return;
 		}
 
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendLabsPlayerUpdate(client, player);
-		}
+		mServer->SendLabsPlayerUpdate(RakNet::Recipients::All(), player);
 
 		player->ResetUpdateBits();
 	}
@@ -1079,9 +1149,7 @@ namespace Game {
 		ClientEvent lootEvent;
 		lootEvent.SetLootPickup(player->GetId(), *object->GetLootData());
 
-		for (const auto& [_, client] : mServer->GetClients()) {
-			mServer->SendServerEvent(client, lootEvent);
-		}
+		mServer->SendServerEvent(RakNet::Recipients::All(), lootEvent);
 	}
 
 	void Instance::PickupCatalyst(const PlayerPtr& player, const ObjectPtr& object) {
@@ -1109,12 +1177,36 @@ namespace Game {
 			ClientEvent catalystEvent;
 			catalystEvent.SetCatalystPickup(player->GetId());
 
-			for (const auto& [_, client] : mServer->GetClients()) {
-				mServer->SendServerEvent(client, catalystEvent);
+			mServer->SendServerEvent(RakNet::Recipients::All(), catalystEvent);
+		}
+	}
+
+	void Instance::UpdateStats() {
+		std::lock_guard<std::mutex> lock(mStatsMutex);
+		mStats.ai = mObjectManager->GetAIScheduler().GetStats();
+		mStats.timeline = mTimeline->GetStats();
+		mStats.combat = mCombatResolver->GetStats();
+		mStats.lagCompensation = mObjectManager->GetLagCompensation().GetStats();
+		mStats.triggers = mObjectManager->GetTriggerSystem().GetStats();
+		mStats.lua = mLua->GetStats();
+		mStats.luaCollector = mLua->GetCollector().GetStats();
+		mObjectManager->GetPools().GetStats(mStats.pools);
+	}
+
+	void Instance::UpdateTimeline() {
+		static thread_local std::vector<TimelineEvent> events;
+		events.clear();
+
+		mTimeline->Advance(mGameTime, events);
+		for (const auto& event : events) {
+			if (event.type == TimelineEventType::LuaWake) {
+				mLua->GetScheduler().Wake(event.objectId, event.id);
+			} else if (const auto object = mObjectManager->Get(event.objectId); object && !object->IsMarkedForDeletion()) {
+				object->OnTimelineEvent(event);
 			}
 		}
 	}
-	
+
 	void Instance::SendAbilityAnimationSequence(const AbilityAnimationSequenceMsg &msg)
 	{
 		// TODO: implementar de verdade.
@@ -12,6 +12,15 @@
 
 #include "Player.h"
 #include "Level.h"
+#include "Navigation.h"
+#include "Timeline.h"
+#include "CombatResolver.h"
+#include "LuaScheduler.h"
+#include "LuaCollector.h"
+#include "AIScheduler.h"
+#include "LagCompensation.h"
+#include "TriggerSystem.h"
+#include "ObjectPool.h"
 
 #include <cstdint>
 #include <string>
@@ -19,6 +28,7 @@
 #include <map>
 #include <set>
 #include <memory>
+#include <mutex>
 #include <functional>
 
 // Game
@@ -103,7 +113,21 @@ namespace Game {
 
 	// Predefined
 	class ObjectManager;
+	class InterestManager;
 	class Lua;
+	struct LuaProfile;
+
+	// InstanceStats
+	struct InstanceStats {
+		AIStats ai;
+		TimelineStats timeline;
+		CombatStats combat;
+		LagCompensationStats lagCompensation;
+		TriggerStats triggers;
+		LuaStats lua;
+		LuaCollectorStats luaCollector;
+		std::vector<PoolStats> pools;
+	};
 
 	// Instance
 	class Instance {
@@ -118,11 +142,15 @@ namespace Game {
 			bool Start();
 			void Stop();
 
+			bool IsRunning() const;
+
 			bool IsLevelLoaded() const;
 			bool LoadLevel();
 
 			MarkerPtr GetMarker(uint32_t id) const;
 
+			const auto& GetPlayers() const { return mPlayers; }
+
 			PlayerPtr GetPlayer(int64_t id) const;
 			PlayerPtr GetPlayerByIndex(uint8_t index) const;
 			PlayerPtr AddPlayer(const SporeNet::UserPtr& user, uint8_t index);
@@ -135,9 +163,28 @@ namespace Game {
 			ObjectManager& GetObjectManager();
 			const ObjectManager& GetObjectManager() const;
 
+			InterestManager& GetInterestManager();
+			const InterestManager& GetInterestManager() const;
+
 			Lua& GetLua();
 			const Lua& GetLua() const;
 
+			// Thread safe, copied from every subsystem at the end of the last tick.
+			InstanceStats GetStats() const;
+
+			// Thread safe, the last profile the Lua state published; stays valid after the instance stops.
+			std::shared_ptr<const LuaProfile> GetLuaProfile() const;
+			void SetLuaProfile(std::shared_ptr<const LuaProfile> profile);
+
+			Pathfinder& GetPathfinder();
+			const Pathfinder& GetPathfinder() const;
+
+			Timeline& GetTimeline();
+			const Timeline& GetTimeline() const;
+
+			CombatResolver& GetCombatResolver();
+			const CombatResolver& GetCombatResolver() const;
+
 			auto& GetServer() { return *mServer; }
 			const auto& GetServer() const { return *mServer; }
 
@@ -163,19 +210,21 @@ namespace Game {
 			void OnObjectDestroy(const ObjectPtr& object);
 			void OnObjectDeath(const ObjectPtr& object, bool critical, bool knockback);
 
+			// Wakes the lua threads waiting on event for the object, nothing to wake before Start.
+			void OnLuaEvent(LuaEvent event, uint32_t objectId);
+
 			void OnPlayerStart(const PlayerPtr& player);
 
 			uint32_t AddTask(uint32_t delay, std::function<void(uint32_t)> task);
 			void CancelTask(uint32_t id);
 
 			// Network safe functions
-			bool ServerUpdate() const;
-			bool Update();
+			void Update(float deltaTime);
 
 			void MoveObject(const ObjectPtr& object, const Locomotion& locomotionData);
 
 			// Abilities / Combat / Etc
-			void UseAbility(const ObjectPtr& object, const RakNet::CombatData& combatData);
+			void UseAbility(const ObjectPtr& object, const RakNet::CombatData& combatData, uint32_t rewind = 0);
 			void SwapCharacter(const PlayerPtr& player, uint32_t creatureIndex);
 			void InteractWithObject(const PlayerPtr& player, uint32_t objectId);
 			void CancelAction(const PlayerPtr& player, const ObjectPtr& object);
@@ -212,16 +261,31 @@ namespace Game {
 			void PickupLoot(const PlayerPtr& player, const ObjectPtr& object);
 			void PickupCatalyst(const PlayerPtr& player, const ObjectPtr& object);
 
+			// Hands due cooldown and modifier events to their objects.
+			void UpdateTimeline();
+
+			void UpdateStats();
+
 		private:
 			std::unique_ptr<RakNet::Server> mServer;
 			std::unique_ptr<ObjectManager> mObjectManager;
+			std::unique_ptr<InterestManager> mInterestManager;
 			std::unique_ptr<Lua> mLua;
+			std::unique_ptr<Pathfinder> mPathfinder;
+			std::unique_ptr<Timeline> mTimeline;
+			std::unique_ptr<CombatResolver> mCombatResolver;
 
 			std::unordered_map<uint32_t, MarkerPtr> mMarkers;
 			std::map<int64_t, PlayerPtr> mPlayers;
 
 			std::set<uint32_t> mEvents;
 
+			InstanceStats mStats;
+			mutable std::mutex mStatsMutex;
+
+			std::shared_ptr<const LuaProfile> mLuaProfile;
+			mutable std::mutex mLuaProfileMutex;
+
 			std::vector<RakNet::Objective> mObjectives;
 			std::vector<ObjectPtr> mObjects;
 			std::vector<glm::vec3> mPlayerSpawnpoints;
@@ -235,9 +299,9 @@ namespace Game {
 
 			uint64_t mGameStartTime = 0;
 			uint64_t mGameTime = 0;
-			uint64_t mGameTimeLua = 0;
 
 			Level mLevel {};
+			NavigationGridPtr mNavigationGrid;
 
 			bool mGameStarted = false;
 			bool mLevelLoaded = false;
@@ -0,0 +1,379 @@
+
+// Include
+#include "InterestManager.h"
+#include "Instance.h"
+#include "ObjectManager.h"
+#include "Config.h"
+
+#include "RakNet/Server.h"
+
+#include <algorithm>
+
+/*
+	Every client only gets the objects around its deployed character, plus the ones flagged as always relevant.
+	Objects are created on a client the tick they come in range and deleted when they leave, updates and
+	object events are only sent to the clients that currently know the object.
+
+	Creates are never held back by the client bandwidth budget, so an object counts as known as soon as its create is
+	queued: everything sent about it afterwards is behind the create in the frame, and whatever RakNet would not order
+	behind it waits for the next drain. A delete that catches the create still unsent drops both.
+
+	A client without a player or deployed character (loading, dead, spectating) gets everything, as does every client when
+	GAME_RELEVANCE_RADIUS is 0.
+*/
+
+// Game
+namespace Game {
+	// InterestManager
+	InterestManager::InterestManager(Instance& game) : mGame(game) {
+		mRadius = static_cast<float>(Config::GetU32(ConfigKey::CONFIG_GAME_RELEVANCE_RADIUS));
+	}
+
+	float InterestManager::GetRadius() const {
+		return mRadius;
+	}
+
+	void InterestManager::SetRadius(float radius) {
+		mRadius = radius;
+	}
+
+	bool InterestManager::IsRelevant(const RakNet::ClientPtr& client, const ObjectPtr& object) const {
+		if (!client || !object) {
+			return false;
+		}
+
+		auto it = mClients.find(client->GetId());
+		if (it == mClients.end() || it->second.client != client) {
+			return IsReplicated(object);
+		}
+
+		return IsRelevant(it->second, object);
+	}
+
+	bool InterestManager::IsKnown(const RakNet::ClientPtr& client, const ObjectPtr& object) const {
+		if (!client || !object) {
+			return false;
+		}
+
+		auto it = mClients.find(client->GetId());
+		if (it == mClients.end() || it->second.client != client) {
+			return false;
+		}
+
+		return it->second.known.contains(object->GetId());
+	}
+
+	float InterestManager::GetPriority(const RakNet::ClientPtr& client, uint32_t objectId) const {
+		const auto& object = mGame.GetObjectManager().Get(objectId);
+		if (!object) {
+			return 1.f;
+		}
+
+		const auto& player = client->GetPlayer();
+		const auto& anchor = player ? player->GetDeployedCharacterObject() : nullptr;
+		if (!anchor || object == anchor) {
+			// Nothing to measure against, or the client's own character which must never lag behind.
+			return anchor ? 100.f : 1.f;
+		}
+
+		float typeScale = 1.f;
+		if (object->IsPlayerControlled()) {
+			typeScale = 4.f;
+		} else if (object->GetNpcType() == NpcType::Boss) {
+			typeScale = 3.f;
+		} else {
+			switch (object->GetType()) {
+				case NounType::Creature:
+				case NounType::Projectile:
+					typeScale = 2.f;
+					break;
+
+				case NounType::Loot:
+				case NounType::Flora:
+				case NounType::Decal:
+				case NounType::DestructibleOrnament:
+					typeScale = 0.5f;
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		// Near objects come first, far ones still get a share so they age their way into the budget.
+		const float falloff = mRadius > 0 ? mRadius * sHysteresis : sPriorityFalloff;
+		const float distance = glm::distance(anchor->GetPosition(), object->GetPosition());
+		return typeScale * std::max(0.1f, 1.f - distance / falloff);
+	}
+
+	const std::vector<RakNet::ClientPtr>& InterestManager::GetRecipients(const ObjectPtr& object) {
+		mRecipients.clear();
+		if (!object) {
+			return mRecipients;
+		}
+
+		const auto id = object->GetId();
+		for (const auto& [_, state] : mClients) {
+			if (state.known.contains(id)) {
+				mRecipients.push_back(state.client);
+			}
+		}
+
+		return mRecipients;
+	}
+
+	const std::vector<RakNet::ClientPtr>& InterestManager::Publish(const ObjectPtr& object) {
+		mRecipients.clear();
+		if (!object) {
+			return mRecipients;
+		}
+
+		// Pick up clients that connected since the last tick.
+		for (const auto& [_, client] : mGame.GetServer().GetClients()) {
+			GetState(client);
+		}
+
+		const auto id = object->GetId();
+		for (auto& [_, state] : mClients) {
+			if (IsRelevant(state, object)) {
+				state.known.insert(id);
+				mRecipients.push_back(state.client);
+			}
+		}
+
+		return mRecipients;
+	}
+
+	void InterestManager::Forget(const ObjectPtr& object) {
+		if (!object) {
+			return;
+		}
+
+		auto& server = mGame.GetServer();
+
+		const auto id = object->GetId();
+		for (auto& [_, state] : mClients) {
+			if (state.known.erase(id) > 0) {
+				server.SendObjectDelete(state.client, object);
+			}
+		}
+	}
+
+	void InterestManager::Forget(const std::vector<ObjectPtr>& objects) {
+		if (objects.empty()) {
+			return;
+		}
+
+		auto& server = mGame.GetServer();
+		for (auto& [_, state] : mClients) {
+			mLeft.clear();
+			for (const auto& object : objects) {
+				if (object && state.known.erase(object->GetId()) > 0) {
+					mLeft.push_back(object);
+				}
+			}
+
+			if (!mLeft.empty()) {
+				server.SendObjectDelete(state.client, mLeft);
+			}
+		}
+		mLeft.clear();
+	}
+
+	void InterestManager::Update() {
+		const auto& server = mGame.GetServer();
+		std::erase_if(mClients, [&server](const auto& entry) {
+			return server.GetClient(entry.first) != entry.second.client;
+		});
+
+		const auto& clients = server.GetClients();
+		if (clients.empty()) {
+			return;
+		}
+
+		// Collected once per tick instead of once per client.
+		mAlwaysRelevant.clear();
+		for (const auto& object : mGame.GetObjectManager().GetActiveObjects()) {
+			if (IsReplicated(object) && IsAlwaysRelevant(object)) {
+				mAlwaysRelevant.push_back(object);
+			}
+		}
+
+		for (const auto& [_, client] : clients) {
+			UpdateClient(GetState(client));
+		}
+		mAlwaysRelevant.clear();
+	}
+
+	void InterestManager::Update(const RakNet::ClientPtr& client) {
+		if (!client) {
+			return;
+		}
+
+		mAlwaysRelevant.clear();
+		for (const auto& object : mGame.GetObjectManager().GetActiveObjects()) {
+			if (IsReplicated(object) && IsAlwaysRelevant(object)) {
+				mAlwaysRelevant.push_back(object);
+			}
+		}
+
+		UpdateClient(GetState(client));
+		mAlwaysRelevant.clear();
+	}
+
+	bool InterestManager::IsAlwaysRelevant(const ObjectPtr& object) {
+		if (object->IsAlwaysRelevant() || object->IsPlayerControlled()) {
+			return true;
+		}
+
+		if (object->GetNpcType() == NpcType::Boss) {
+			return true;
+		}
+
+		switch (object->GetType()) {
+			case NounType::BossPortal:
+			case NounType::LevelExitPoint:
+				return true;
+
+			default:
+				return false;
+		}
+	}
+
+	bool InterestManager::IsReplicated(const ObjectPtr& object) {
+		// Objects are only replicated once the instance created them, and never again once they are deleted.
+		return object && (object->GetFlags() & Object::Created) && !object->IsMarkedForDeletion();
+	}
+
+	InterestManager::ClientState& InterestManager::GetState(const RakNet::ClientPtr& client) {
+		auto& state = mClients[client->GetId()];
+		if (state.client != client) {
+			// Reconnected or a new client in the same slot, it has nothing created.
+			state.client = client;
+			state.known.clear();
+		}
+		return state;
+	}
+
+	bool InterestManager::IsRelevant(const ClientState& state, const ObjectPtr& object) const {
+		if (mRadius <= 0) {
+			return true;
+		}
+
+		const auto& player = state.client->GetPlayer();
+		if (!player) {
+			return true;
+		}
+
+		const auto& anchor = player->GetDeployedCharacterObject();
+		if (!anchor || IsAlwaysRelevant(object)) {
+			return true;
+		}
+
+		// The client needs all of its own characters to swap between them.
+		for (uint32_t i = 0; i < 3; ++i) {
+			if (object == player->GetCharacterObject(i)) {
+				return true;
+			}
+		}
+
+		return BoundingSphere(anchor->GetPosition(), mRadius).Intersects(object->GetBoundingBox());
+	}
+
+	void InterestManager::UpdateClient(ClientState& state) {
+		const auto& objectManager = mGame.GetObjectManager();
+		const auto& player = state.client->GetPlayer();
+		const auto& anchor = player ? player->GetDeployedCharacterObject() : nullptr;
+
+		mRelevant.clear();
+		mEntered.clear();
+		mLeft.clear();
+
+		const auto keep = [this, &state](const ObjectPtr& object) {
+			const auto id = object->GetId();
+			if (mRelevant.insert(id).second && !state.known.contains(id)) {
+				mEntered.push_back(object);
+			}
+		};
+
+		if (mRadius <= 0 || !anchor) {
+			for (const auto& object : objectManager.GetActiveObjects()) {
+				if (IsReplicated(object)) {
+					keep(object);
+				}
+			}
+		} else {
+			for (const auto& object : mAlwaysRelevant) {
+				keep(object);
+			}
+
+			for (uint32_t i = 0; i < 3; ++i) {
+				const auto& characterObject = player->GetCharacterObject(i);
+				if (IsReplicated(characterObject)) {
+					keep(characterObject);
+				}
+			}
+
+			const auto& center = anchor->GetPosition();
+			const BoundingSphere enterRegion(center, mRadius);
+
+			// Known objects are kept inside the larger region, new ones have to be inside the radius itself.
+			objectManager.VisitObjectsInRadius(BoundingSphere(center, mRadius * sHysteresis), {}, [&](const ObjectPtr& object) {
+				if (IsReplicated(object) && (state.known.contains(object->GetId()) || enterRegion.Intersects(object->GetBoundingBox()))) {
+					keep(object);
+				}
+			});
+		}
+
+		for (const auto id : state.known) {
+			if (!mRelevant.contains(id)) {
+				if (auto object = objectManager.Get(id)) {
+					mLeft.push_back(std::move(object));
+				}
+			}
+		}
+
+		std::swap(state.known, mRelevant);
+
+		if (!mLeft.empty()) {
+			mGame.GetServer().SendObjectDelete(state.client, mLeft);
+		}
+
+		for (const auto& object : mEntered) {
+			SendFullState(state.client, object);
+		}
+
+		mEntered.clear();
+		mLeft.clear();
+	}
+
+	void InterestManager::SendFullState(const RakNet::ClientPtr& client, const ObjectPtr& object) const {
+		// The client never saw this object, the usual deltas are not enough.
+		auto& server = mGame.GetServer();
+		server.SendObjectCreate(client, object, true);
+
+		if (object->HasCombatantData()) {
+			server.SendCombatantDataUpdate(client, object, *object->GetCombatantData());
+		}
+
+		if (object->HasAttributeData()) {
+			server.SendAttributeDataUpdate(client, object, *object->GetAttributeData(), true);
+		}
+
+		if (object->HasLootData()) {
+			server.SendLootDataUpdate(client, object, *object->GetLootData());
+		}
+
+		if (object->HasAgentBlackboardData()) {
+			server.SendAgentBlackboardUpdate(client, object, *object->GetAgentBlackboardData());
+		}
+
+		if (object->HasInteractableData()) {
+			server.SendInteractableDataUpdate(client, object, *object->GetInteractableData());
+		}
+
+		if (object->HasLocomotionData() && !object->IsPlayerControlled()) {
+			server.SendLocomotionDataUpdate(client, object, *object->GetLocomotionData());
+		}
+	}
+}
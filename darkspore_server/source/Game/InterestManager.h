@@ -0,0 +1,80 @@
+
+#ifndef _GAME_INTEREST_MANAGER_HEADER
+#define _GAME_INTEREST_MANAGER_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+
+#include <unordered_set>
+#include <vector>
+#include <map>
+
+// Game
+namespace Game {
+	// InterestManager
+	class InterestManager {
+		// Objects stay known until they are this much further out than the relevance radius, so they do not flicker on the edge.
+		static constexpr float sHysteresis = 1.1f;
+
+		// Distance at which priority bottoms out when there is no relevance radius.
+		static constexpr float sPriorityFalloff = 100.f;
+
+		public:
+			InterestManager(Instance& game);
+
+			float GetRadius() const;
+			void SetRadius(float radius);
+
+			bool IsRelevant(const RakNet::ClientPtr& client, const ObjectPtr& object) const;
+			bool IsKnown(const RakNet::ClientPtr& client, const ObjectPtr& object) const;
+
+			// How urgent the pending state of an object is for a client, see the outgoing frame budget.
+			float GetPriority(const RakNet::ClientPtr& client, uint32_t objectId) const;
+
+			// Clients that have the object created, valid until the next call.
+			const std::vector<RakNet::ClientPtr>& GetRecipients(const ObjectPtr& object);
+
+			// First creation of an object, marks it as known for every client it is relevant to and returns those.
+			const std::vector<RakNet::ClientPtr>& Publish(const ObjectPtr& object);
+
+			// The object is going away, sends the delete to the clients that know it.
+			void Forget(const ObjectPtr& object);
+			void Forget(const std::vector<ObjectPtr>& objects);
+
+			// Creates objects that became relevant and deletes the ones that are not anymore.
+			void Update();
+			void Update(const RakNet::ClientPtr& client);
+
+		private:
+			struct ClientState {
+				RakNet::ClientPtr client;
+				std::unordered_set<uint32_t> known;
+			};
+
+			static bool IsAlwaysRelevant(const ObjectPtr& object);
+			static bool IsReplicated(const ObjectPtr& object);
+
+			ClientState& GetState(const RakNet::ClientPtr& client);
+
+			bool IsRelevant(const ClientState& state, const ObjectPtr& object) const;
+
+			void UpdateClient(ClientState& state);
+			void SendFullState(const RakNet::ClientPtr& client, const ObjectPtr& object) const;
+
+		private:
+			Instance& mGame;
+
+			std::map<uint8_t, ClientState> mClients;
+
+			// Scratch buffers, reused every tick.
+			std::unordered_set<uint32_t> mRelevant;
+			std::vector<ObjectPtr> mAlwaysRelevant;
+			std::vector<ObjectPtr> mEntered;
+			std::vector<ObjectPtr> mLeft;
+			std::vector<RakNet::ClientPtr> mRecipients;
+
+			float mRadius = 0;
+	};
+}
+
+#endif
@@ -0,0 +1,210 @@
+
+// Include
+#include "LagCompensation.h"
+#include "ObjectManager.h"
+#include "Instance.h"
+#include "Config.h"
+
+#include "RakNet/Server.h"
+
+#include <algorithm>
+
+/*
+	Clients act on what they last saw of the world, which is half a round trip plus about a tick of
+	interpolation behind the server. An ability command is therefore evaluated against the world as it was when
+	the client fired: for its duration, everything that moves near the shooter is put back where its history says
+	it was, then restored unless the ability moved it itself. The shooter keeps its own position, the command
+	carries it. Only positions and orientations seen by object code are rewound. Broadphase queries already see
+	last tick's bounds, and the spatial index is never touched, so a rewind costs a radius query plus two writes
+	per object moved.
+*/
+
+// Game
+namespace Game {
+	// LagCompensation::Rewind
+	LagCompensation::Rewind::Rewind(LagCompensation& lagCompensation, const ObjectPtr& shooter, uint64_t time) {
+		if (!shooter) {
+			return;
+		}
+
+		const auto now = lagCompensation.mManager.GetGame().GetTime();
+		if (time >= now) {
+			return;
+		}
+
+		lagCompensation.mManager.VisitObjectsInRadius(BoundingSphere(shooter->GetPosition(), sRewindRadius), {}, [&](const ObjectPtr& object) {
+			if (object == shooter) {
+				return;
+			}
+
+			PositionSample sample;
+			if (!lagCompensation.Sample(object->GetId(), time, sample)) {
+				return;
+			}
+
+			if (sample.position == object->GetPosition() && sample.orientation == object->GetOrientation()) {
+				return;
+			}
+
+			mSaved.push_back({ object, PositionSample { now, object->GetPosition(), object->GetOrientation() }, sample });
+			Place(*object, sample.position, sample.orientation);
+		});
+
+		auto& stats = lagCompensation.mStats;
+		stats.rewinds++;
+		stats.rewoundObjects += mSaved.size();
+		stats.lastRewind = static_cast<uint32_t>(now - time);
+		stats.maxRewind = std::max(stats.maxRewind, stats.lastRewind);
+	}
+
+	LagCompensation::Rewind::~Rewind() {
+		for (const auto& saved : mSaved) {
+			Restore(*saved.object, saved.current, saved.rewound);
+		}
+	}
+
+	// LagCompensation
+	LagCompensation::LagCompensation(ObjectManager& manager) : mManager(manager) {
+		mMaxRewind = Config::GetU32(ConfigKey::CONFIG_GAME_MAX_REWIND);
+	}
+
+	uint32_t LagCompensation::GetMaxRewind() const {
+		return mMaxRewind;
+	}
+
+	uint32_t LagCompensation::GetRewind(int32_t averagePing) const {
+		if (averagePing < 0) {
+			// Not measured yet.
+			return 0;
+		}
+
+		const auto tickTime = 1000 / mManager.GetGame().GetServer().GetTickRate();
+		return std::min(static_cast<uint32_t>(averagePing) / 2 + tickTime, mMaxRewind);
+	}
+
+	void LagCompensation::Record(uint64_t time) {
+		const auto previousTime = mLastRecordTime;
+		mLastRecordTime = time;
+
+		for (const auto& object : mManager.GetActiveObjects()) {
+			if (!object->GetLocomotionData() || object->IsMarkedForDeletion()) {
+				continue;
+			}
+
+			const auto id = object->GetId();
+			const auto index = ObjectManager::GetIndex(id);
+			if (index >= mHistories.size()) {
+				mHistories.resize(static_cast<size_t>(index) + 1);
+			}
+
+			auto& history = mHistories[index];
+			if (!history) {
+				history = std::make_unique<History>();
+			}
+
+			if (history->id != id) {
+				history->id = id;
+				history->head = 0;
+				history->count = 0;
+			}
+
+			const PositionSample sample { time, object->GetPosition(), object->GetOrientation() };
+			if (history->count > 0) {
+				const auto newest = history->GetNewest();
+				if (newest.position == sample.position && newest.orientation == sample.orientation) {
+					continue;
+				}
+
+				// It stood still until the last tick, without this the start of the move would be spread over the whole pause.
+				if (newest.time < previousTime) {
+					history->Push({ previousTime, newest.position, newest.orientation });
+				}
+			}
+
+			history->Push(sample);
+		}
+	}
+
+	void LagCompensation::Remove(uint32_t id) {
+		const auto index = ObjectManager::GetIndex(id);
+		if (index < mHistories.size()) {
+			// Kept allocated for the next object in this slot.
+			if (auto& history = mHistories[index]; history && history->id == id) {
+				history->id = 0;
+				history->count = 0;
+			}
+		}
+	}
+
+	bool LagCompensation::Sample(uint32_t id, uint64_t time, PositionSample& sample) const {
+		const auto history = GetHistory(id);
+		if (!history || history->count == 0) {
+			return false;
+		}
+
+		const auto& samples = history->samples;
+		const auto head = history->head;
+
+		if (const auto& newest = history->GetNewest(); time >= newest.time) {
+			sample = newest;
+			return true;
+		}
+
+		for (uint32_t i = 1; i < history->count; ++i) {
+			const auto& older = samples[(head - 1 - i) & sHistoryMask];
+			if (older.time > time) {
+				continue;
+			}
+
+			const auto& newer = samples[(head - i) & sHistoryMask];
+			const auto t = static_cast<float>(time - older.time) / static_cast<float>(newer.time - older.time);
+
+			sample.time = time;
+			sample.position = glm::mix(older.position, newer.position, t);
+			sample.orientation = glm::slerp(older.orientation, newer.orientation, t);
+			return true;
+		}
+
+		// Further back than the history reaches.
+		sample = samples[(head - history->count) & sHistoryMask];
+		return true;
+	}
+
+	const LagCompensationStats& LagCompensation::GetStats() const {
+		return mStats;
+	}
+
+	void LagCompensation::History::Push(const PositionSample& sample) {
+		samples[head] = sample;
+		head = (head + 1) & sHistoryMask;
+		count = std::min(count + 1, sHistorySize);
+	}
+
+	const LagCompensation::History* LagCompensation::GetHistory(uint32_t id) const {
+		const auto index = ObjectManager::GetIndex(id);
+		if (index < mHistories.size()) {
+			if (const auto& history = mHistories[index]; history && history->id == id) {
+				return history.get();
+			}
+		}
+		return nullptr;
+	}
+
+	void LagCompensation::Place(Object& object, const glm::vec3& position, const glm::quat& orientation) {
+		// Straight into the object, a rewind must not reach the spatial index or replication.
+		object.mBoundingBox.center = position;
+		object.mOrientation = orientation;
+	}
+
+	void LagCompensation::Restore(Object& object, const PositionSample& current, const PositionSample& rewound) {
+		// A knockback, pull or teleport during the rewind went through SetPosition and the spatial index already
+		// has it, putting the old position back would leave the index and triggers pointing somewhere else.
+		if (object.mBoundingBox.center == rewound.position) {
+			object.mBoundingBox.center = current.position;
+		}
+
+		if (object.mOrientation == rewound.orientation) {
+			object.mOrientation = current.orientation;
+		}
+	}
+}
@@ -0,0 +1,115 @@
+
+#ifndef _GAME_LAG_COMPENSATION_HEADER
+#define _GAME_LAG_COMPENSATION_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Game
+namespace Game {
+	class Object;
+	class ObjectManager;
+
+	using ObjectPtr = std::shared_ptr<Object>;
+
+	// PositionSample
+	struct PositionSample {
+		uint64_t time = 0;
+		glm::vec3 position {};
+		glm::quat orientation {};
+	};
+
+	// LagCompensationStats
+	struct LagCompensationStats {
+		uint64_t rewinds = 0;
+		uint64_t rewoundObjects = 0;
+		uint32_t lastRewind = 0;
+		uint32_t maxRewind = 0;
+	};
+
+	// LagCompensation
+	class LagCompensation {
+		// A power of two, 1.6 seconds of movement at the default 20 ticks per second. Samples are only taken when something moved.
+		static constexpr uint32_t sHistorySize = 32;
+		static constexpr uint32_t sHistoryMask = sHistorySize - 1;
+
+		// Objects further away than this from the shooter stay where they are.
+		static constexpr float sRewindRadius = 64.f;
+
+		public:
+			// Moves every object with history near the shooter back to where it was at the given time, and puts it back once it goes out of scope.
+			// Whatever the ability moved in the meantime stays where the ability put it.
+			class Rewind {
+				public:
+					Rewind(LagCompensation& lagCompensation, const ObjectPtr& shooter, uint64_t time);
+					~Rewind();
+
+					Rewind(const Rewind&) = delete;
+					Rewind& operator=(const Rewind&) = delete;
+
+				private:
+					struct Saved {
+						ObjectPtr object;
+						PositionSample current;
+						PositionSample rewound;
+					};
+
+					std::vector<Saved> mSaved;
+			};
+
+			LagCompensation(ObjectManager& manager);
+
+			// GAME_MAX_REWIND, in milliseconds.
+			uint32_t GetMaxRewind() const;
+
+			// Half the round trip plus one tick the client spends interpolating, clamped to the max rewind.
+			uint32_t GetRewind(int32_t averagePing) const;
+
+			// Called after every object ticked, samples moving objects that changed since the last tick.
+			void Record(uint64_t time);
+			void Remove(uint32_t id);
+
+			// Interpolated between the samples around time, false without any history for the object.
+			bool Sample(uint32_t id, uint64_t time, PositionSample& sample) const;
+
+			const LagCompensationStats& GetStats() const;
+
+		private:
+			struct History {
+				std::array<PositionSample, sHistorySize> samples;
+				uint32_t id = 0;
+				uint32_t head = 0;
+				uint32_t count = 0;
+
+				const PositionSample& GetNewest() const { return samples[(head - 1) & sHistoryMask]; }
+				void Push(const PositionSample& sample);
+			};
+
+			const History* GetHistory(uint32_t id) const;
+
+			static void Place(Object& object, const glm::vec3& position, const glm::quat& orientation);
+			static void Restore(Object& object, const PositionSample& current, const PositionSample& rewound);
+
+		private:
+			ObjectManager& mManager;
+
+			// By object slot, only created for objects with locomotion.
+			std::vector<std::unique_ptr<History>> mHistories;
+
+			LagCompensationStats mStats;
+
+			uint64_t mLastRecordTime = 0;
+
+			uint32_t mMaxRewind;
+	};
+}
+
+#endif
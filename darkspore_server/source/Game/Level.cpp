@@ -241,6 +241,10 @@ namespace Game {
 		return mScale;
 	}
 
+	bool Marker::HasCollision() const {
+		return mHasCollision;
+	}
+
 	// Markerset
 	bool Markerset::Load(const std::string& difficultyName, const std::string& markersetAsset) {
 		const std::string fullPath = markersetDataPath + markersetAsset + ".xml";
@@ -405,6 +409,10 @@ namespace Game {
 		return false;
 	}
 
+	const std::unordered_map<uint32_t, Markerset>& Level::GetMarkersets() const {
+		return mMarkersets;
+	}
+
 	const LevelConfig& Level::GetConfig() const {
 		return mConfig;
 	}
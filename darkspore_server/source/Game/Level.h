@@ -138,6 +138,8 @@ namespace Game {
 
 			float GetScale() const;
 
+			bool HasCollision() const;
+
 		private:
 			std::unique_ptr<TeleporterData> mTeleporterData;
 			std::unique_ptr<MarkerInteractableData> mInteractableData;
@@ -232,6 +234,7 @@ namespace Game {
 			bool Load(const std::string& difficultyName, const std::string& levelName);
 
 			bool GetMarkerset(const std::string& name, Markerset& markerset) const;
+			const std::unordered_map<uint32_t, Markerset>& GetMarkersets() const;
 
 			const LevelConfig& GetConfig() const;
 			const LevelConfig& GetFirstTimeConfig() const;
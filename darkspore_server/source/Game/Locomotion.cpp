@@ -2,6 +2,7 @@
 // Include
 #include "Locomotion.h"
 #include "Object.h"
+#include "Instance.h"
 
 #include "RakNet/Types.h"
 
@@ -147,10 +148,7 @@ namespace Game {
 	void Locomotion::Update(float deltaTime) {
 		switch (mObject->GetMovementType()) {
 			case MovementType::Pathfinding: {
-				if (false) {
-					mObject->SetLinearVelocity(glm::zero<glm::vec3>());
-					mObject->SetAngularVelocity(glm::zero<glm::vec3>());
-				}
+				FollowPath(deltaTime);
 				break;
 			}
 
@@ -738,15 +736,15 @@ LAB_009ef634:
 		reflector.end();
 	}
 
-	bool Locomotion::CollideWithCreature(const glm::vec3& position, glm::vec3& collisionPosition) {
-		const auto TestCollision = [this](const ObjectPtr& collidingObject) {
+	bool Locomotion::CollideWithCreature(const glm::vec3& movement, float& impactTime, glm::vec3& collisionPosition) {
+		const auto TestCollision = [this](const Object* collidingObject) {
 			if (collidingObject->GetAttributeValue(AttributeType::Incorporeal) <= 0 && collidingObject->GetAttributeValue(AttributeType::Intangible) == 0) {
 				const auto collidingId = collidingObject->GetId();
 				if (mTargetId == collidingId) {
 					return true;
 				}
 
-				if (mObject->GetOwnerObject() == collidingObject) {
+				if (mObject->GetOwnerObject().get() == collidingObject) {
 					return false;
 				}
 
@@ -785,9 +783,15 @@ LAB_009ef634:
 			return false;
 		}
 
-		const auto& collidingObjects = mObject->GetCollidingObjectsWith(*creatureCollisionVolume, { NounType::Creature });
-		for (const auto& collidingObject : collidingObjects) {
-			if (TestCollision(collidingObject)) {
+		static thread_local std::vector<Contact> contacts;
+
+		// Swept over the whole move so fast projectiles cannot skip past a creature between ticks.
+		contacts.clear();
+		mObject->GetSweptCollisions(contacts, *creatureCollisionVolume, movement, NounType::Creature);
+		for (const auto& contact : contacts) {
+			if (TestCollision(contact.object)) {
+				impactTime = contact.time;
+				collisionPosition = contact.point;
 				return true;
 			}
 		}
@@ -796,6 +800,74 @@ LAB_009ef634:
 		return false;
 	}
 
+	void Locomotion::FollowPath(float deltaTime) {
+		// Players steer on their own client, everything else walks the path towards its goal.
+		if (mObject->IsPlayerControlled() || !(mGoalFlags & (0x001 | 0x400))) {
+			mPath.reset();
+			mPathGoalCell = NavigationGrid::sInvalidCell;
+			mPathStatus = PathStatus::None;
+			return;
+		}
+
+		auto& pathfinder = mObject->GetGame().GetPathfinder();
+		const auto& grid = pathfinder.GetGrid();
+		if (!grid) {
+			return;
+		}
+
+		const auto id = mObject->GetId();
+		const auto position = mObject->GetPosition();
+
+		// Goals on a target move a little every tick, only a new goal cell is worth a new search.
+		if (const auto goalCell = grid->GetCell(mGoalPosition); goalCell != mPathGoalCell) {
+			mPathGoalCell = goalCell;
+			mPath.reset();
+			mPathIndex = 0;
+
+			mPathStatus = pathfinder.Request(id, position, mGoalPosition);
+			if (mPathStatus != PathStatus::Pending) {
+				pathfinder.TakePath(id, mPath);
+			}
+		} else if (mPathStatus == PathStatus::Pending) {
+			mPathStatus = pathfinder.TakePath(id, mPath);
+		}
+
+		if (mPathStatus == PathStatus::Pending) {
+			return;
+		}
+
+		const glm::vec2 current(position);
+		const glm::vec2 goal(mGoalPosition);
+		if (glm::distance(current, goal) <= std::max(mAllowedStopDistance, 0.1f)) {
+			return;
+		}
+
+		// Without a path (unreachable goal) head straight for it, like before.
+		const float reach = grid->GetCellSize() * 0.5f;
+		glm::vec2 waypoint = goal;
+		if (mPath) {
+			while (mPathIndex < mPath->size() && glm::distance((*mPath)[mPathIndex], current) <= reach) {
+				++mPathIndex;
+			}
+
+			if (mPathIndex < mPath->size()) {
+				waypoint = (*mPath)[mPathIndex];
+			}
+		}
+
+		if (const glm::vec3 partialGoal(waypoint, mGoalPosition.z); partialGoal != mPartialGoalPosition) {
+			mPartialGoalPosition = partialGoal;
+			mObject->SetFlags(mObject->GetFlags() | Object::Flags::UpdateLocomotion);
+		}
+
+		const float speed = mObject->GetModifiedMovementSpeed();
+		const auto delta = waypoint - current;
+		if (const float distance = glm::length(delta); speed > 0 && distance > 0) {
+			const float step = std::min(distance, speed * deltaTime);
+			mObject->SetPositionSimulated(glm::vec3(current + delta * (step / distance), position.z));
+		}
+	}
+
 	void Locomotion::Projectile(float value) {
 		if (mReflectedCurrentUpdate != mReflectedLastUpdate) {
 			SetInitialDirection(glm::normalize(mObject->GetLinearVelocity()));
@@ -817,12 +889,14 @@ LAB_009ef634:
 			movementSpeed = mObject->GetLinearVelocity() * acceleration;
 		}
 
+		float impactTime = 0;
 		glm::vec3 collisionPosition;
-		if (CollideWithCreature(collisionPosition, collisionPosition)) {
+		if (CollideWithCreature(movementSpeed, impactTime, collisionPosition)) {
 			mHasCollidedWithCreature = true;
 			// mCollisionPosition = position;
 			if (!mProjectileParameters.mPiercing) {
-				mObject->SetPositionSimulated(mExpectedGeoCollision);
+				// Stop where the creature was first touched.
+				mObject->SetPositionSimulated(mObject->GetPosition() + movementSpeed * impactTime);
 				return;
 			}
 		}
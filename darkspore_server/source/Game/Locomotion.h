@@ -4,6 +4,8 @@
 
 // Include
 #include "Core/Base/Predefined.h"
+#include "Navigation.h"
+#include "ObjectPool.h"
 
 #include <glm/glm.hpp>
 
@@ -123,7 +125,7 @@ namespace Game {
 	};
 
 	// Locomotion
-	class Locomotion {
+	class Locomotion : public Pooled {
 		public:
 			Locomotion(const ObjectPtr& object);
 
@@ -191,7 +193,9 @@ namespace Game {
 			void WriteReflection(RakNet::BitStream& stream) const;
 
 		private:
-			bool CollideWithCreature(const glm::vec3& position, glm::vec3& collisionPosition);
+			bool CollideWithCreature(const glm::vec3& movement, float& impactTime, glm::vec3& collisionPosition);
+
+			void FollowPath(float deltaTime);
 
 			void Projectile(float value);
 			void OrbitOwner(float value);
@@ -216,6 +220,12 @@ namespace Game {
 			glm::vec3 mInitialDirection {};
 			glm::vec3 mOffset {};
 
+			// Path towards mGoalPosition, asked for again whenever the goal moves to another cell.
+			PathPtr mPath;
+			size_t mPathIndex = 0;
+			uint32_t mPathGoalCell = NavigationGrid::sInvalidCell;
+			PathStatus mPathStatus = PathStatus::None;
+
 			uint64_t mLobStartTime = 0;
 
 			uint32_t mGoalFlags = 0;
@@ -0,0 +1,228 @@
+
+// Include
+#include "LooseGrid.h"
+#include "ObjectManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+	Uniform grid over the x/y plane (z is up in every level), cells are only allocated when something is in them.
+	Each object is stored once, in the cell holding the center of its bounding box, so a move is at most a swap
+	between two cell lists. Objects wider than half a cell are kept in a small separate list that every query checks.
+*/
+
+// Game
+namespace Game {
+	// LooseGrid
+	void LooseGrid::Update() {
+		for (const auto& object : mQueue) {
+			Insert(object);
+		}
+		mQueue.clear();
+
+		for (auto id : mMoved) {
+			if (const auto entry = GetEntry(id); entry != sInvalidEntry) {
+				Refresh(entry);
+			}
+		}
+		mMoved.clear();
+	}
+
+	void LooseGrid::Enqueue(const ObjectPtr& object) {
+		mQueue.push_back(object);
+	}
+
+	void LooseGrid::Move(uint32_t id) {
+		mMoved.push_back(id);
+	}
+
+	void LooseGrid::Remove(const ObjectPtr& object) {
+		const auto entry = GetEntry(object->GetId());
+		if (entry == sInvalidEntry) {
+			std::erase(mQueue, object);
+			return;
+		}
+
+		if (mObjects[entry] != object) {
+			return;
+		}
+
+		Erase(entry);
+	}
+
+	void LooseGrid::VisitObjectsInRegion(const BoundingBox& region, NounTypeMask types, ObjectVisitor visitor) const {
+		Query(region, types, visitor, [&region](const BoundingBox& boundingBox) {
+			return region.Intersects(boundingBox);
+		});
+	}
+
+	void LooseGrid::VisitObjectsInRadius(const BoundingSphere& region, NounTypeMask types, ObjectVisitor visitor) const {
+		Query(BoundingBox(region.center - glm::vec3(region.radius), region.center + glm::vec3(region.radius)), types, visitor, [&region](const BoundingBox& boundingBox) {
+			return region.Intersects(boundingBox);
+		});
+	}
+
+	uint64_t LooseGrid::GetCellKey(int32_t x, int32_t y) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+	int32_t LooseGrid::GetCellCoordinate(float value) {
+		return static_cast<int32_t>(std::floor(value / sCellSize));
+	}
+
+	uint64_t LooseGrid::GetCell(const BoundingBox& boundingBox) {
+		if (boundingBox.extent.x > sLooseness || boundingBox.extent.y > sLooseness) {
+			return sLargeCell;
+		}
+		return GetCellKey(GetCellCoordinate(boundingBox.center.x), GetCellCoordinate(boundingBox.center.y));
+	}
+
+	void LooseGrid::Insert(const ObjectPtr& object) {
+		if (!object || object->IsMarkedForDeletion()) {
+			return;
+		}
+
+		const auto id = object->GetId();
+		const auto index = ObjectManager::GetIndex(id);
+		if (index >= mEntries.size()) {
+			mEntries.resize(static_cast<size_t>(index) + 1, sInvalidEntry);
+		} else if (mEntries[index] != sInvalidEntry) {
+			return;
+		}
+
+		const auto entry = static_cast<uint32_t>(mObjects.size());
+		mEntries[index] = entry;
+
+		mBoxes.push_back(object->GetBoundingBox());
+		mTypeBits.push_back(NounTypeMask::GetBit(object->GetType()));
+		mIds.push_back(id);
+		mCells.push_back(sLargeCell);
+		mSlots.push_back(0);
+		mObjects.push_back(object);
+
+		// Moves before the insert were not tracked, the box read above is already current.
+		object->SetDirty(false);
+
+		Place(entry);
+	}
+
+	void LooseGrid::Erase(uint32_t entry) {
+		Unplace(entry);
+		mEntries[ObjectManager::GetIndex(mIds[entry])] = sInvalidEntry;
+
+		// Swap the last entry into the hole.
+		const auto last = static_cast<uint32_t>(mObjects.size() - 1);
+		if (entry != last) {
+			mBoxes[entry] = mBoxes[last];
+			mTypeBits[entry] = mTypeBits[last];
+			mIds[entry] = mIds[last];
+			mCells[entry] = mCells[last];
+			mSlots[entry] = mSlots[last];
+			mObjects[entry] = std::move(mObjects[last]);
+
+			GetCellEntries(mCells[entry])[mSlots[entry]] = entry;
+			mEntries[ObjectManager::GetIndex(mIds[entry])] = entry;
+		}
+
+		mBoxes.pop_back();
+		mTypeBits.pop_back();
+		mIds.pop_back();
+		mCells.pop_back();
+		mSlots.pop_back();
+		mObjects.pop_back();
+	}
+
+	uint32_t LooseGrid::GetEntry(uint32_t id) const {
+		// Moves can be reported for an id whose slot has been reused since, those have to miss.
+		const auto index = ObjectManager::GetIndex(id);
+		if (index < mEntries.size()) {
+			if (const auto entry = mEntries[index]; entry != sInvalidEntry && mIds[entry] == id) {
+				return entry;
+			}
+		}
+		return sInvalidEntry;
+	}
+
+	void LooseGrid::Refresh(uint32_t entry) {
+		const auto& object = mObjects[entry];
+		object->SetDirty(false);
+
+		const auto& boundingBox = object->GetBoundingBox();
+		mBoxes[entry] = boundingBox;
+
+		if (GetCell(boundingBox) != mCells[entry]) {
+			Unplace(entry);
+			Place(entry);
+		}
+	}
+
+	void LooseGrid::Place(uint32_t entry) {
+		const auto cell = GetCell(mBoxes[entry]);
+		auto& entries = GetCellEntries(cell);
+
+		mCells[entry] = cell;
+		mSlots[entry] = static_cast<uint32_t>(entries.size());
+		entries.push_back(entry);
+	}
+
+	void LooseGrid::Unplace(uint32_t entry) {
+		auto& entries = GetCellEntries(mCells[entry]);
+
+		const auto slot = mSlots[entry];
+		const auto moved = entries.back();
+		entries[slot] = moved;
+		mSlots[moved] = slot;
+		entries.pop_back();
+	}
+
+	std::vector<uint32_t>& LooseGrid::GetCellEntries(uint64_t cell) {
+		if (cell == sLargeCell) {
+			return mLarge;
+		}
+		return mGrid[cell];
+	}
+
+	template<typename Intersects>
+	void LooseGrid::Query(const BoundingBox& bounds, NounTypeMask types, const ObjectVisitor& visitor, Intersects&& intersects) const {
+		const auto visit = [&](const std::vector<uint32_t>& entries) {
+			for (auto entry : entries) {
+				if (types.Accepts(mTypeBits[entry]) && intersects(mBoxes[entry]) && !visitor(mObjects[entry])) {
+					return false;
+				}
+			}
+			return true;
+		};
+
+		const auto min = bounds.GetMin() - glm::vec3(sLooseness);
+		const auto max = bounds.GetMax() + glm::vec3(sLooseness);
+
+		const int32_t minX = GetCellCoordinate(min.x);
+		const int32_t minY = GetCellCoordinate(min.y);
+		const int32_t maxX = GetCellCoordinate(max.x);
+		const int32_t maxY = GetCellCoordinate(max.y);
+
+		if (!visit(mLarge)) {
+			return;
+		}
+
+		const auto cellCount = (static_cast<uint64_t>(maxX - minX) + 1) * (static_cast<uint64_t>(maxY - minY) + 1);
+		if (cellCount > mGrid.size() * sMaxCellLookupFactor) {
+			for (const auto& [cell, entries] : mGrid) {
+				const auto x = static_cast<int32_t>(static_cast<uint32_t>(cell >> 32));
+				const auto y = static_cast<int32_t>(static_cast<uint32_t>(cell));
+				if (x >= minX && x <= maxX && y >= minY && y <= maxY && !visit(entries)) {
+					return;
+				}
+			}
+		} else {
+			for (int32_t x = minX; x <= maxX; ++x) {
+				for (int32_t y = minY; y <= maxY; ++y) {
+					if (auto it = mGrid.find(GetCellKey(x, y)); it != mGrid.end() && !visit(it->second)) {
+						return;
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,74 @@
+
+#ifndef _GAME_LOOSE_GRID_HEADER
+#define _GAME_LOOSE_GRID_HEADER
+
+// Include
+#include "SpatialIndex.h"
+
+#include <unordered_map>
+
+// Game
+namespace Game {
+	// LooseGrid
+	class LooseGrid : public SpatialIndex {
+		// Objects live in the cell of their center, queries look half a cell further to catch their overhang.
+		static constexpr float sCellSize = 32.f;
+		static constexpr float sLooseness = sCellSize * 0.5f;
+
+		// Scanning the whole map is cheaper than looking up this many more cells than exist.
+		static constexpr size_t sMaxCellLookupFactor = 2;
+
+		static constexpr uint64_t sLargeCell = ~0ull;
+		static constexpr uint32_t sInvalidEntry = ~0u;
+
+		public:
+			void Update() override;
+
+			void Enqueue(const ObjectPtr& object) override;
+			void Move(uint32_t id) override;
+			void Remove(const ObjectPtr& object) override;
+
+			void VisitObjectsInRegion(const BoundingBox& region, NounTypeMask types, ObjectVisitor visitor) const override;
+			void VisitObjectsInRadius(const BoundingSphere& region, NounTypeMask types, ObjectVisitor visitor) const override;
+
+		private:
+			static uint64_t GetCellKey(int32_t x, int32_t y);
+			static int32_t GetCellCoordinate(float value);
+			static uint64_t GetCell(const BoundingBox& boundingBox);
+
+			uint32_t GetEntry(uint32_t id) const;
+
+			void Insert(const ObjectPtr& object);
+			void Erase(uint32_t entry);
+			void Refresh(uint32_t entry);
+
+			void Place(uint32_t entry);
+			void Unplace(uint32_t entry);
+
+			std::vector<uint32_t>& GetCellEntries(uint64_t cell);
+
+			template<typename Intersects>
+			void Query(const BoundingBox& bounds, NounTypeMask types, const ObjectVisitor& visitor, Intersects&& intersects) const;
+
+		private:
+			// Entries, one array per field so queries only touch boxes and type bits.
+			std::vector<BoundingBox> mBoxes;
+			std::vector<uint64_t> mTypeBits;
+			std::vector<uint32_t> mIds;
+			std::vector<uint64_t> mCells;
+			std::vector<uint32_t> mSlots;
+			std::vector<ObjectPtr> mObjects;
+
+			// cell -> entries, entries too large for a cell are kept in mLarge.
+			std::unordered_map<uint64_t, std::vector<uint32_t>> mGrid;
+			std::vector<uint32_t> mLarge;
+
+			// object slot index -> entry
+			std::vector<uint32_t> mEntries;
+
+			std::vector<ObjectPtr> mQueue;
+			std::vector<uint32_t> mMoved;
+	};
+}
+
+#endif
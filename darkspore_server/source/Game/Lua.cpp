@@ -1,6 +1,7 @@
 
 // Include
 #include "Lua.h"
+#include "LuaStatePool.h"
 
 #include "Instance.h"
 #include "ObjectManager.h"
@@ -98,20 +99,19 @@ namespace Game {
 	}
 
 	bool LuaThread::resume() {
-		if (!mCoroutine.valid()) {
+		// A thread that failed is done as well, nothing would ever resume it.
+		if (!mCoroutine.valid() || mCoroutine.error()) {
 			return true;
 		}
 
-		if (mCoroutine.error()) {
-			return false;
-		}
-
 		sol::variadic_results results;
 		if (mResumeCondition && !mResumeCondition(lua_state(), results)) {
 			return false;
 		}
 
 		mResumeCondition = nullptr;
+		mLua.mScheduler.End(mSlot);
+		mLua.mResumed++;
 
 		sol::protected_function_result result = mCoroutine(sol::as_args(results));
 		if (!result.valid()) {
@@ -119,15 +119,27 @@ namespace Game {
 			std::cout << "LuaThread::resume()" << std::endl;
 			std::cout << err.what() << std::endl;
 			std::cout << std::to_underlying(mCoroutine.status()) << std::endl;
+			return true;
 		}
 
 		return mCoroutine.status() == sol::call_status::ok;
 	}
 
 	void LuaThread::stop() {
+		const bool waiting = mLua.mScheduler.IsWaiting(mSlot);
+
 		// Stop coroutine and recreate thread
+		mResumeCondition = nullptr;
 		mCoroutine = sol::nil;
+
+		mLua.mThreads.erase(lua_state());
 		mThread = sol::thread::create(mLua.GetState());
+		mLua.mThreads.emplace(lua_state(), this);
+
+		// Nothing will wake it any more.
+		if (waiting) {
+			mLua.ReturnThreadToPool(this);
+		}
 	}
 
 	void LuaThread::set_resume_condition(const ResumeCondition& condition) { mResumeCondition = condition; }
@@ -332,7 +344,7 @@ namespace Game {
 	}
 
 	// Lua
-	Lua::Lua(Instance& game) : LuaBase(), mGame(game) {}
+	Lua::Lua() : LuaBase(), mScheduler(*this), mCollector(GetState()), mProfiler(*this) {}
 	Lua::~Lua() {
 		while (!mThreads.empty()) {
 			auto it = mThreads.begin();
@@ -348,36 +360,59 @@ namespace Game {
 		RegisterFunctions();
 
 		LoadFile("data/serverdata/lua/global.lua");
+		mCollector.Start();
 	}
 
 	void Lua::Reload() {
 		LuaBase::Reload();
-		GlobalLua::Instance().Reload();
+		LuaStatePool::Instance().Reload();
 		mAbilities.clear();
 	}
 
+	void Lua::Attach(Instance& game) {
+		mGame = &game;
+		mGameMetatable["Instance"] = mGame;
+		mGameMetatable["Level"] = mGame->GetChainData().GetLevelIndex();
+	}
+
 	void Lua::Update() {
-		for (auto it = mYieldedThreads.begin(); it != mYieldedThreads.end(); ) {
-			auto thread = *it;
+		mProfiler.Update();
+
+		static thread_local std::vector<LuaWaiter> ready;
+		ready.clear();
+
+		mScheduler.Collect(ready);
+
+		mResumed = 0;
+		for (const auto& waiter : ready) {
+			// Threads resumed before this one can stop it, or take its slot.
+			auto thread = mThreadSlots[waiter.slot];
+			if (!thread || !mScheduler.IsCurrent(waiter)) {
+				continue;
+			}
+
 			if (thread->resume()) {
-				it = mYieldedThreads.erase(it);
 				ReturnThreadToPool(thread);
-			} else {
-				++it;
+			} else if (!mScheduler.IsWaiting(waiter.slot)) {
+				// Yielded without saying what for, try again next update.
+				YieldThread(thread);
 			}
 		}
 	}
 
-	void Lua::PreloadAbilities() {
-		// TODO:
+	size_t Lua::PreloadAbilities() {
+		for (const auto& [abilityId, _] : GlobalLua::Instance().GetAbilities()) {
+			GetAbility(abilityId);
+		}
+		return mAbilities.size();
 	}
 
 	Instance& Lua::GetGame() {
-		return mGame;
+		return *mGame;
 	}
 
 	const Instance& Lua::GetGame() const {
-		return mGame;
+		return *mGame;
 	}
 
 	AbilityPtr Lua::GetAbility(const std::string& abilityName) {
@@ -432,6 +467,15 @@ namespace Game {
 		if (mThreadPool.empty()) {
 			thread = new LuaThread(*this);
 			mThreads.emplace(thread->lua_state(), thread);
+
+			if (mFreeThreadSlots.empty()) {
+				thread->mSlot = static_cast<uint32_t>(mThreadSlots.size());
+				mThreadSlots.push_back(thread);
+			} else {
+				thread->mSlot = mFreeThreadSlots.back();
+				mFreeThreadSlots.pop_back();
+				mThreadSlots[thread->mSlot] = thread;
+			}
 		} else {
 			thread = mThreadPool.back();
 			mThreadPool.pop_back();
@@ -446,26 +490,87 @@ namespace Game {
 		return nullptr;
 	}
 
-	void Lua::YieldThread(LuaThread* thread) {
+	void Lua::YieldThread(LuaThread* thread, LuaThread::ResumeCondition condition) {
 		if (thread) {
-			mYieldedThreads.insert(thread);
+			mScheduler.Begin(thread->mSlot, LuaWaitReason::Predicate);
+			mScheduler.Poll(thread->mSlot);
+			thread->set_resume_condition(std::move(condition));
+		}
+	}
+
+	void Lua::YieldThreadUntil(LuaThread* thread, uint64_t time) {
+		if (thread) {
+			mScheduler.Begin(thread->mSlot, LuaWaitReason::Time);
+			mScheduler.WakeAt(thread->mSlot, time);
+			thread->set_resume_condition(nullptr);
+		}
+	}
+
+	void Lua::YieldThreadOn(LuaThread* thread, LuaEvent event, uint32_t objectId, LuaThread::ResumeCondition condition) {
+		if (thread) {
+			mScheduler.Begin(thread->mSlot, LuaWaitReason::Event);
+			mScheduler.Subscribe(thread->mSlot, event, objectId);
+			if (event != LuaEvent::Death) {
+				mScheduler.Subscribe(thread->mSlot, LuaEvent::Death, objectId);
+			}
+
+			// The condition may hold already, it is checked once on the next update and then only on events.
+			mScheduler.Wake(thread->mSlot);
+			thread->set_resume_condition(std::move(condition));
 		}
 	}
 
 	void Lua::ReturnThreadToPool(LuaThread* thread) {
 		constexpr size_t MAX_LUA_THREADS = 256;
+		mScheduler.End(thread->mSlot);
+		thread->mResumeCondition = nullptr;
+
 		if (mThreads.size() > MAX_LUA_THREADS) {
 			mThreads.erase(mThreads.find(thread->lua_state()));
+			mThreadSlots[thread->mSlot] = nullptr;
+			mFreeThreadSlots.push_back(thread->mSlot);
 			delete thread;
 		} else {
 			thread->mValues.clear(); // Remove any stored values.
+			thread->mAbilityId = 0;
 			mThreadPool.push_back(thread);
 		}
 		// CollectGarbage();
 	}
 
+	LuaScheduler& Lua::GetScheduler() {
+		return mScheduler;
+	}
+
+	const LuaScheduler& Lua::GetScheduler() const {
+		return mScheduler;
+	}
+
+	LuaStats Lua::GetStats() const {
+		auto stats = mScheduler.GetStats();
+		stats.threads = static_cast<uint32_t>(mThreads.size());
+		stats.resumed = mResumed;
+		return stats;
+	}
+
+	LuaCollector& Lua::GetCollector() {
+		return mCollector;
+	}
+
+	const LuaCollector& Lua::GetCollector() const {
+		return mCollector;
+	}
+
+	LuaProfiler& Lua::GetProfiler() {
+		return mProfiler;
+	}
+
+	const LuaProfiler& Lua::GetProfiler() const {
+		return mProfiler;
+	}
+
 	// Coroutine
-	Coroutine::Coroutine(Lua& lua, sol::table&& self) : mLua(lua), mSelf(std::move(self)) {
+	Coroutine::Coroutine(Lua& lua, sol::table&& self, uint32_t abilityId) : mLua(lua), mSelf(std::move(self)), mAbilityId(abilityId) {
 		if (mSelf == sol::nil) {
 			throw std::runtime_error("Coroutine::Coroutine: self is nil");
 		}
@@ -506,7 +611,7 @@ namespace Game {
 			return sol::make_object(state, sol::lua_nil);
 	}
 	
-	Ability::Ability(Lua& lua, sol::table&& self, const std::string& name, uint32_t id) : Coroutine(lua, std::move(self)), mName(name), mId(id) {
+	Ability::Ability(Lua& lua, sol::table&& self, const std::string& name, uint32_t id) : Coroutine(lua, std::move(self), id), mName(name), mId(id) {
 		mEnvironment["_ABILITY"] = this;
 
 		if (sol::optional<bool> hasActivate = mSelf["hasActivate"]; hasActivate.value_or(false)) {
@@ -669,6 +774,7 @@ namespace Game {
 			thread = mLua.SpawnThread();
 		}
 
+		thread->set_ability_id(mId);
 		thread->call<void>(mEnvironment, mTickFn, mSelf, object, target, cursorPosition, rank);
 		return true;
 	}
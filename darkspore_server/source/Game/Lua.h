@@ -4,6 +4,9 @@
 
 // Include
 #include "Attributes.h"
+#include "LuaCollector.h"
+#include "LuaProfiler.h"
+#include "LuaScheduler.h"
 
 #include <glm/glm.hpp>
 
@@ -46,6 +49,10 @@ namespace Game {
 		void set_resume_condition(const ResumeCondition &condition);
 		void set_resume_condition(ResumeCondition &&condition);
 
+		// Ability the thread runs for, 0 for anything else.
+		uint32_t ability_id() const { return mAbilityId; }
+		void set_ability_id(uint32_t id) { mAbilityId = id; }
+
 		template <typename Result, typename... Args>
 		decltype(auto) call(const sol::function &func, Args &&...args)
 		{
@@ -93,6 +100,10 @@ namespace Game {
 		sol::environment mEnvironment;
 
 		uint32_t mAbilityInstanceId{0};
+		uint32_t mAbilityId{0};
+
+		// Index into the threads of the lua state, stays the same while the thread lives.
+		uint32_t mSlot{0};
 
 		friend class Lua;
 	};
@@ -160,6 +171,8 @@ namespace Game {
 			const sol::bytecode& GetAbility(const std::string& abilityName) const;
 			const sol::bytecode& GetAbility(uint32_t abilityId) const;
 
+			const auto& GetAbilities() const { return mLoadedAbilities; }
+
 		private:
 			void LoadAbilities();
 
@@ -172,14 +185,20 @@ namespace Game {
 	// Lua
 	class Lua : public LuaBase {
 	public:
-			Lua(Instance& game);
+			// Built without an instance so it can be prewarmed, see LuaStatePool.
+			Lua();
 			~Lua();
 
 			void Initialize() override;
 			void Reload() override;
 
+			// Binds the state to the instance it runs for, before anything runs in it.
+			void Attach(Instance& game);
+
 			void Update();
-			void PreloadAbilities();
+
+			// Runs every ability script GlobalLua loaded, returns how many are registered.
+			size_t PreloadAbilities();
 
 			Instance& GetGame();
 			const Instance& GetGame() const;
@@ -193,7 +212,15 @@ namespace Game {
 
 			LuaThread* SpawnThread();
 			LuaThread* GetThread(lua_State* L) const;
-			void YieldThread(LuaThread* thread);
+
+			// Resumes on the next update once condition holds, checked every update.
+			void YieldThread(LuaThread* thread, LuaThread::ResumeCondition condition = nullptr);
+
+			// Resumes once the game time reaches time.
+			void YieldThreadUntil(LuaThread* thread, uint64_t time);
+
+			// Checks condition whenever event is raised for the object, or the object dies.
+			void YieldThreadOn(LuaThread* thread, LuaEvent event, uint32_t objectId, LuaThread::ResumeCondition condition);
 
 			template<typename Result, typename... Args>
 			auto CallCoroutine(std::nullptr_t, const sol::function& func, Args&&... args) {
@@ -207,6 +234,17 @@ namespace Game {
 
 			void ReturnThreadToPool(LuaThread* thread);
 
+			LuaScheduler& GetScheduler();
+			const LuaScheduler& GetScheduler() const;
+
+			LuaStats GetStats() const;
+
+			LuaCollector& GetCollector();
+			const LuaCollector& GetCollector() const;
+
+			LuaProfiler& GetProfiler();
+			const LuaProfiler& GetProfiler() const;
+
 			struct AbilityInstance {
 					uint32_t id;
 					Ability* ability;
@@ -247,25 +285,35 @@ namespace Game {
 			void RegisterTriggerVolume();
 
 	private:
-			Instance& mGame;
+			Instance* mGame = nullptr;
+			sol::table mGameMetatable;
 
 			std::unordered_map<lua_State*, LuaThread*> mThreads;
 			std::unordered_map<uint32_t, AbilityPtr> mAbilities;
 			std::unordered_map<uint32_t, sol::table> mPrivateTables;
 
-			std::unordered_set<LuaThread*> mYieldedThreads;
+			LuaScheduler mScheduler;
+			LuaCollector mCollector;
+			LuaProfiler mProfiler;
+
+			// slot -> thread, nullptr for free slots.
+			std::vector<LuaThread*> mThreadSlots;
+			std::vector<uint32_t> mFreeThreadSlots;
 
 			std::vector<LuaThread*> mThreadPool;
+			uint32_t mResumed{0};
 
 			uint32_t mNextAbilityInstanceId{1};
 			std::unordered_map<uint32_t, AbilityInstance> mAbilityInstances;
+
+			friend class LuaThread;
 	};
 
 
 	// Coroutine
 	class Coroutine {
 		public:
-			Coroutine(Lua& lua, sol::table&& self);
+			Coroutine(Lua& lua, sol::table&& self, uint32_t abilityId = 0);
 			virtual ~Coroutine() = default;
 
 			void Reload();
@@ -274,7 +322,9 @@ namespace Game {
 			template<typename Result, typename... Args>
 			auto Call(sol::function fn, Args&&... args) const {
 				if (fn) {
-					return mLua.CallCoroutine<Result>(mEnvironment, fn, mSelf, std::forward<Args>(args)...);
+					auto thread = mLua.SpawnThread();
+					thread->set_ability_id(mAbilityId);
+					return thread->call<Result>(mEnvironment, fn, mSelf, std::forward<Args>(args)...);
 				}
 
 				if constexpr (!std::is_void_v<Result>) {
@@ -287,6 +337,8 @@ namespace Game {
 
 			sol::table mSelf;
 			sol::environment mEnvironment;
+
+			uint32_t mAbilityId;
 	};
 
 	// Ability
@@ -0,0 +1,107 @@
+
+// Include
+#include "LuaCollector.h"
+#include "Lua.h"
+#include "Config.h"
+
+#include <algorithm>
+#include <iostream>
+
+/*
+	Every tick that deleted an object used to end with two full collections of the instance state, to get rid of
+	the private tables of what was deleted. That is a walk of every table, closure and ability script in the
+	state, in the middle of the tick, whenever anything died. The automatic collector was still on as well and
+	ran its steps wherever a script happened to allocate.
+
+	The automatic collector is now off and the state is collected here, once per tick, in steps: a cycle starts
+	when the heap doubled since the last one ended, and each tick works on it until the budget is spent. A full
+	collection only happens when a level is loaded, or when the heap goes over the limit anyway. If it is still
+	over half the limit after that, the limit is raised, collecting everything every tick would not help.
+
+	The heap size is what LuaJIT counts as allocated, lua_gc(LUA_GCCOUNT) only reads it back. Steps and full
+	collections reset the threshold the automatic collector runs at, so it is stopped again after each of them.
+*/
+
+// Game
+namespace Game {
+	// LuaCollector
+	LuaCollector::LuaCollector(lua_State* L) : mState(L) {
+		mBudget = std::chrono::microseconds(Config::GetU32(ConfigKey::CONFIG_GAME_LUA_GC_BUDGET));
+		mLimit = std::max<uint32_t>(Config::GetU32(ConfigKey::CONFIG_GAME_LUA_GC_LIMIT), sMinCycle);
+	}
+
+	void LuaCollector::Start() {
+		lua_gc(mState, LUA_GCSTOP, 0);
+		mCollecting = false;
+		mNextCycle = std::max(GetHeap() * sPause / 100, sMinCycle);
+		UpdateHeap();
+	}
+
+	void LuaCollector::Step() {
+		const auto start = Clock::now();
+
+		mStats.steps = 0;
+		if (GetHeap() >= mLimit) {
+			Collect();
+
+			const auto heap = GetHeap();
+			if (heap > mLimit / 2) {
+				mLimit = heap * 2;
+				std::cout << "Game::LuaCollector: heap still at " << heap << " KB after a full collection, limit raised to " << mLimit << " KB." << std::endl;
+			}
+		} else {
+			if (!mCollecting && GetHeap() >= mNextCycle) {
+				mCollecting = true;
+			}
+
+			if (mCollecting) {
+				do {
+					mStats.steps++;
+					if (lua_gc(mState, LUA_GCSTEP, sStepSize)) {
+						mCollecting = false;
+						mNextCycle = std::max(GetHeap() * sPause / 100, sMinCycle);
+						mStats.cycles++;
+						break;
+					}
+				} while (Clock::now() - start < mBudget);
+			}
+
+			// Also undoes anything that turned the automatic collector back on since the last tick.
+			lua_gc(mState, LUA_GCSTOP, 0);
+		}
+
+		mStats.stepTime = Clock::now() - start;
+		mStats.maxStepTime = std::max(mStats.maxStepTime, mStats.stepTime);
+		mStats.totalStepTime += mStats.stepTime;
+		UpdateHeap();
+	}
+
+	void LuaCollector::Collect() {
+		const auto start = Clock::now();
+
+		// Finishes the cycle in progress before running a whole one.
+		lua_gc(mState, LUA_GCCOLLECT, 0);
+		lua_gc(mState, LUA_GCSTOP, 0);
+
+		mCollecting = false;
+		mNextCycle = std::max(GetHeap() * sPause / 100, sMinCycle);
+
+		mStats.lastFullTime = Clock::now() - start;
+		mStats.fullCollections++;
+		UpdateHeap();
+	}
+
+	const LuaCollectorStats& LuaCollector::GetStats() const {
+		return mStats;
+	}
+
+	uint32_t LuaCollector::GetHeap() const {
+		return static_cast<uint32_t>(lua_gc(mState, LUA_GCCOUNT, 0));
+	}
+
+	void LuaCollector::UpdateHeap() {
+		mStats.heap = GetHeap();
+		mStats.peakHeap = std::max(mStats.peakHeap, mStats.heap);
+		mStats.limit = mLimit;
+	}
+}
@@ -0,0 +1,82 @@
+
+#ifndef _GAME_LUA_COLLECTOR_HEADER
+#define _GAME_LUA_COLLECTOR_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+
+#include <chrono>
+#include <cstdint>
+
+// Predefined
+struct lua_State;
+
+// Game
+namespace Game {
+	// LuaCollectorStats
+	struct LuaCollectorStats {
+		using Clock = std::chrono::steady_clock;
+
+		// In kilobytes.
+		uint32_t heap = 0;
+		uint32_t peakHeap = 0;
+		uint32_t limit = 0;
+
+		uint64_t cycles = 0;
+		uint64_t fullCollections = 0;
+
+		// Last step
+		uint32_t steps = 0;
+		Clock::duration stepTime {};
+
+		Clock::duration maxStepTime {};
+		Clock::duration totalStepTime {};
+		Clock::duration lastFullTime {};
+	};
+
+	// LuaCollector
+	class LuaCollector {
+		public:
+			using Clock = std::chrono::steady_clock;
+
+			LuaCollector(lua_State* L);
+
+			// Turns the automatic collector off, the state is only collected through Step and Collect from then on.
+			void Start();
+
+			// Once per tick, works on the current cycle for at most GAME_LUA_GC_BUDGET microseconds.
+			void Step();
+
+			// Full collection, for level transitions and when the heap goes over GAME_LUA_GC_LIMIT.
+			void Collect();
+
+			const LuaCollectorStats& GetStats() const;
+
+		private:
+			uint32_t GetHeap() const;
+
+			void UpdateHeap();
+
+		private:
+			// Kilobytes of allocation each step pays for, small enough to check the budget often.
+			static constexpr int sStepSize = 16;
+
+			// A new cycle starts once the heap grew this much (in percent) since the last one ended.
+			static constexpr uint32_t sPause = 200;
+			static constexpr uint32_t sMinCycle = 1024;
+
+			lua_State* mState;
+
+			Clock::duration mBudget;
+
+			// In kilobytes.
+			uint32_t mLimit;
+			uint32_t mNextCycle = sMinCycle;
+
+			bool mCollecting = false;
+
+			LuaCollectorStats mStats;
+	};
+}
+
+#endif
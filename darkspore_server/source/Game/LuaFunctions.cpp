@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <limits>
 
 // Helpers
 namespace {
@@ -114,6 +115,14 @@ namespace {
 
 		return parameters;
 	}
+
+	auto LuaGetNounTypeMask(const sol::table& value) {
+		Game::NounTypeMask types;
+		for (const auto& entry : value) {
+			types = types | static_cast<Game::NounType>(entry.second.as<uint32_t>());
+		}
+		return types;
+	}
 }
 
 // LuaFunction
@@ -277,40 +286,32 @@ namespace LuaFunction {
 	auto nObjectManager_GetObjectsInRadius(sol::this_state L, glm::vec3 position, float radius, sol::table objectTypes) {
 		auto& game = LuaGetGame(L);
 
-		std::vector<Game::NounType> types;
-		for (const auto& entry : objectTypes) {
-			types.push_back(static_cast<Game::NounType>(entry.second.as<uint32_t>()));
-		}
+		auto result = sol::state_view(L).create_table();
 
-		auto objects = game.GetObjectManager().GetObjectsInRadius(Game::BoundingSphere(position, radius), types);
-		auto objectCount = static_cast<int>(objects.size());
-
-		auto result = sol::state_view(L).create_table(objectCount, 0);
-		for (int i = 0; i < objectCount; ++i) {
-			result[i + 1] = objects[i];
-		}
+		int index = 0;
+		game.GetObjectManager().VisitObjectsInRadius(Game::BoundingSphere(position, radius), LuaGetNounTypeMask(objectTypes), [&result, &index](const Game::ObjectPtr& object) {
+			result[++index] = object;
+		});
 
 		return result;
 	}
 
-	auto nObjectManager_GetObjectsInRadius_SortedByDistance(sol::this_state L, glm::vec3 position, float radius, sol::table objectTypes) {
+	auto nObjectManager_GetObjectsInRadius_SortedByDistance(sol::this_state L, glm::vec3 position, float radius, sol::table objectTypes, sol::optional<uint32_t> maxCount) {
+		static thread_local std::vector<Game::Object*> objects;
+
 		auto& game = LuaGetGame(L);
 
-		std::vector<Game::NounType> types;
-		for (const auto& entry : objectTypes) {
-			types.push_back(static_cast<Game::NounType>(entry.second.as<uint32_t>()));
-		}
+		// Scripts that only want the closest few pass a count, which avoids sorting everything in range.
+		objects.clear();
+		game.GetObjectManager().GetNearestObjects(objects, Game::BoundingSphere(position, radius), maxCount.value_or(std::numeric_limits<uint32_t>::max()), LuaGetNounTypeMask(objectTypes));
 
-		auto objects = game.GetObjectManager().GetObjectsInRadius(Game::BoundingSphere(position, radius), types);
 		auto objectCount = static_cast<int>(objects.size());
-		std::sort(objects.begin(), objects.end(), [&position](const auto& lhs, const auto& rhs) {
-			return glm::distance(position, lhs->GetPosition()) < glm::distance(position, rhs->GetPosition());
-		});
 
 		auto result = sol::state_view(L).create_table(objectCount, 0);
 		for (int i = 0; i < objectCount; ++i) {
-			result[i + 1] = objects[i];
+			result[i + 1] = objects[i]->shared_from_this();
 		}
+		objects.clear();
 
 		return result;
 	}
@@ -440,7 +441,7 @@ namespace LuaFunction {
 
 				game.MoveObject(object, *locomotion);
 
-				thread->set_resume_condition([&objectManager, objectId = object->GetId(), position, distance](lua_State* L, sol::variadic_results& results) {
+				lua.YieldThreadOn(thread, Game::LuaEvent::Moved, object->GetId(), [&objectManager, objectId = object->GetId(), position, distance](lua_State* L, sol::variadic_results& results) {
 					auto object = objectManager.Get(objectId);
 					if (!object) {
 						return true;
@@ -453,8 +454,6 @@ namespace LuaFunction {
 
 					return true;
 				});
-
-				lua.YieldThread(thread);
 			}
 		}
 
@@ -855,11 +854,8 @@ namespace LuaFunction {
 					attributes = attributeSnapshotValue.as<Game::AttributesPtr>();
 				}
 
-				Game::CombatEvent combatEvent;
-				combatEvent.mTargetId = object->GetId();
-				combatEvent.mDirection = direction.value_or(glm::zero<glm::vec3>());
-
-				const auto& result = object->TakeDamage(
+				// The combat event goes out with the rest of the tick's hits.
+				return object->TakeDamage(
 					attributes,
 					std::make_tuple(damageRange.raw_get_or(1, 0.f), damageRange.raw_get_or(2, 0.f)),
 					damageType,
@@ -867,18 +863,8 @@ namespace LuaFunction {
 					damageCoefficient,
 					descriptors,
 					damageMultiplier.value_or(1.0f),
-					combatEvent.mDirection
+					direction.value_or(glm::zero<glm::vec3>())
 				);
-
-				combatEvent.mDeltaHealth = std::get<1>(result);
-				combatEvent.mIntegerHpChange = static_cast<int32_t>(combatEvent.mDeltaHealth);
-
-				if (std::get<2>(result)) {
-					combatEvent.mFlags = Game::CombatEventFlags::Critical;
-				}
-
-				game.SendCombatEvent(combatEvent);
-				return result;
 			}
 
 			return std::make_tuple(false, 0.f, false);
@@ -906,10 +892,7 @@ namespace LuaFunction {
 					attributes = attributeSnapshotValue.as<Game::AttributesPtr>();
 				}
 
-				Game::CombatEvent combatEvent;
-				combatEvent.mTargetId = object->GetId();
-
-				const auto& result = object->Heal(
+				return object->Heal(
 					attributes,
 					std::make_tuple(healRange.raw_get_or(1, 0.f), healRange.raw_get_or(2, 0.f)),
 					healCoefficient,
@@ -917,16 +900,6 @@ namespace LuaFunction {
 					critical.value_or(false),
 					false
 				);
-
-				combatEvent.mDeltaHealth = std::get<0>(result);
-				combatEvent.mIntegerHpChange = static_cast<int32_t>(combatEvent.mDeltaHealth);
-
-				if (std::get<1>(result)) {
-					combatEvent.mFlags = Game::CombatEventFlags::Critical;
-				}
-
-				game.SendCombatEvent(combatEvent);
-				return result;
 			}
 
 			return std::make_tuple(0.f, false);
@@ -1571,7 +1544,7 @@ namespace Game {
 		// global functions
 		mState["AddEvent"] = [this](sol::this_state L, sol::protected_function callback, uint32_t delay, sol::variadic_args args) {
 			if (delay > 0) {
-				auto& game = mGame;
+				auto& game = *mGame;
 				return game.AddTask(delay, [&game, callback = std::move(callback), args = std::vector<sol::object>(args.begin(), args.end())](uint32_t id) mutable {
 					game.AddServerTask([&game, id, callback = std::move(callback), args = std::move(args)]() mutable {
 						game.CancelTask(id);
@@ -1585,7 +1558,7 @@ namespace Game {
 		};
 
 		mState["StopEvent"] = [this](sol::this_state L, uint32_t id) {
-			mGame.CancelTask(id);
+			mGame->CancelTask(id);
 		};
 
 		RegisterThread();
@@ -1607,7 +1580,7 @@ namespace Game {
 		thread["Create"] = [this](sol::this_state L, sol::object objectValue, sol::protected_function callback, sol::variadic_args args) {
 			LuaThread* thread;
 
-			auto& objectManager = mGame.GetObjectManager();
+			auto& objectManager = mGame->GetObjectManager();
 			auto object = LuaGetObject(objectManager, objectValue);
 			if (object) {
 				thread = object->GetLuaThread();
@@ -1643,11 +1616,10 @@ namespace Game {
 			}
 
 			if (milliseconds > 0) {
-				uint64_t time = utils::get_milliseconds() + milliseconds;
-				thread->set_resume_condition([time](lua_State* L, sol::variadic_results& results) { return utils::get_milliseconds() >= time; });
+				YieldThreadUntil(thread, utils::get_milliseconds() + milliseconds);
+			} else {
+				YieldThread(thread);
 			}
-
-			YieldThread(thread);
 		});
 
 		thread["WaitForCallback"] = sol::yielding([this](sol::this_state L, sol::function callback) {
@@ -1656,11 +1628,10 @@ namespace Game {
 				return;
 			}
 
-			thread->set_resume_condition([callback](lua_State* L, sol::variadic_results& results) {
+			// Only the script knows what it waits for, checked every update.
+			YieldThread(thread, [callback](lua_State* L, sol::variadic_results& results) {
 				return callback.call<bool>();
 			});
-
-			YieldThread(thread);
 		});
 
 		thread["WaitForHitpointsAbove"] = sol::yielding([this](sol::this_state L, sol::object objectValue, float value, float deathTimer) {
@@ -1669,10 +1640,10 @@ namespace Game {
 				return;
 			}
 
-			auto& objectManager = mGame.GetObjectManager();
+			auto& objectManager = mGame->GetObjectManager();
 			auto object = LuaGetObject(objectManager, objectValue);
 			if (object) {
-				thread->set_resume_condition([&objectManager, objectId = object->GetId(), value](lua_State* L, sol::variadic_results& results) {
+				YieldThreadOn(thread, Game::LuaEvent::HealthChanged, object->GetId(), [&objectManager, objectId = object->GetId(), value](lua_State* L, sol::variadic_results& results) {
 					auto object = objectManager.Get(objectId);
 					if (!object) {
 						return true;
@@ -1683,9 +1654,9 @@ namespace Game {
 
 					return object->GetHealth() > value;
 				});
+			} else {
+				YieldThread(thread);
 			}
-
-			YieldThread(thread);
 		});
 
 		thread["WaitForXSeconds"] = sol::yielding([this](sol::this_state L, double seconds, sol::object attributesSnapshotValue, sol::optional<bool> channeling) {
@@ -1712,11 +1683,10 @@ namespace Game {
 			}
 
 			if (seconds > 0) {
-				uint64_t time = utils::get_milliseconds() + static_cast<uint64_t>(seconds * 1000);
-				thread->set_resume_condition([time](lua_State* L, sol::variadic_results& results) { return utils::get_milliseconds() >= time; });
+				YieldThreadUntil(thread, utils::get_milliseconds() + static_cast<uint64_t>(seconds * 1000));
+			} else {
+				YieldThread(thread);
 			}
-
-			YieldThread(thread);
 		});
 
 		thread["WaitUntilTime"] = sol::yielding([this](sol::this_state L, double seconds, sol::object attributesSnapshotValue, sol::optional<bool> channeling) {
@@ -1743,11 +1713,10 @@ namespace Game {
 			}
 
 			if (seconds > 0) {
-				uint64_t time = utils::get_milliseconds() + static_cast<uint64_t>(seconds * 1000);
-				thread->set_resume_condition([time](lua_State* L, sol::variadic_results& results) { return utils::get_milliseconds() >= time; });
+				YieldThreadUntil(thread, utils::get_milliseconds() + static_cast<uint64_t>(seconds * 1000));
+			} else {
+				YieldThread(thread);
 			}
-
-			YieldThread(thread);
 		});
 
 		thread["WaitForProjectile"] = sol::yielding([this](sol::this_state L,
@@ -1846,7 +1815,7 @@ namespace Game {
 				return;
 			}
 
-			auto& objectManager = mGame.GetObjectManager();
+			auto& objectManager = mGame->GetObjectManager();
 			auto projectile = LuaGetObject(objectManager, projectileObjectValue);
 			if (projectile && projectile->HasLocomotionData()) {
 				const auto& locomotion = projectile->GetLocomotionData();
@@ -1894,7 +1863,7 @@ namespace Game {
 					CalculateExpectedGeoCollision(locomotion, parameters);
 				}
 
-				thread->set_resume_condition([&objectManager, id = projectile->GetId(), position = projectile->GetPosition(), range = parameters.mRange](lua_State* L, sol::variadic_results& results) {
+				YieldThreadOn(thread, Game::LuaEvent::Moved, projectile->GetId(), [&objectManager, id = projectile->GetId(), position = projectile->GetPosition(), range = parameters.mRange](lua_State* L, sol::variadic_results& results) {
 					const Game::ObjectPtr& object = objectManager.Get(id);
 					if (!object) {
 						results.push_back({ L, sol::in_place, Game::ObjectPtr() });
@@ -1929,27 +1898,23 @@ namespace Game {
 					results.push_back({ L, sol::in_place, distance });
 					return true;
 				});
+			} else {
+				YieldThread(thread);
 			}
-
-			YieldThread(thread);
 		});
 	}
 
 	void Lua::RegisterGame() {
 		auto gameMetatable = mState.create_table_with();
 
-		// variables
-		gameMetatable["Instance"] = &mGame;
-		gameMetatable["Level"] = mGame.GetChainData().GetLevelIndex();
-
 		// functions
 		gameMetatable["GetPlayer"] = [this](sol::this_state L, uint8_t index) {
-			return mGame.GetPlayerByIndex(index);
+			return mGame->GetPlayerByIndex(index);
 		};
 
 		gameMetatable["Notify"] = [this](sol::this_state L, sol::table serverEventTable) {
-			auto serverEvent = LuaGetServerEvent(mGame.GetObjectManager(), serverEventTable);
-			mGame.SendServerEvent(serverEvent);
+			auto serverEvent = LuaGetServerEvent(mGame->GetObjectManager(), serverEventTable);
+			mGame->SendServerEvent(serverEvent);
 		};
 
 		// meta
@@ -1957,6 +1922,9 @@ namespace Game {
 		gameMetatable[sol::meta_function::index] = gameMetatable;
 
 		mState.create_named_table("Game")[sol::metatable_key] = gameMetatable;
+
+		// Instance and Level are set in Attach.
+		mGameMetatable = gameMetatable;
 	}
 
 	void Lua::RegisterObjectManager() {
@@ -2013,10 +1981,10 @@ namespace Game {
 		player["GetDeployedCharacter"] = &Player::GetDeployedCharacterObject;
 
 		player["Notify"] = [this](sol::this_state L, sol::object playerValue, sol::table serverEventTable) {
-			auto player = LuaGetPlayer(mGame, playerValue);
+			auto player = LuaGetPlayer(*mGame, playerValue);
 			if (player) {
-				auto serverEvent = LuaGetServerEvent(mGame.GetObjectManager(), serverEventTable);
-				mGame.SendServerEvent(player, serverEvent);
+				auto serverEvent = LuaGetServerEvent(mGame->GetObjectManager(), serverEventTable);
+				mGame->SendServerEvent(player, serverEvent);
 			}
 		};
 	}
@@ -2078,7 +2046,7 @@ namespace Game {
 				return;
 			}
 
-			ability->PlayAnimationSequence(mGame);
+			ability->PlayAnimationSequence(*mGame);
 		};
 
 		object["SetAnimationState"] = &LuaFunction::Object::SetAnimationState;
@@ -2109,6 +2077,9 @@ namespace Game {
 		object["IsVisible"] = &Object::IsVisible;
 		object["SetVisible"] = &Object::SetVisible;
 
+		object["IsAlwaysRelevant"] = &Object::IsAlwaysRelevant;
+		object["SetAlwaysRelevant"] = &Object::SetAlwaysRelevant;
+
 		object["IsMarkedForDeletion"] = &Object::IsMarkedForDeletion;
 		object["MarkForDeletion"] = &Object::MarkForDeletion;
 
@@ -2128,7 +2099,7 @@ namespace Game {
 				return;
 			}
 
-			const auto& objectManager = mGame.GetObjectManager();
+			const auto& objectManager = mGame->GetObjectManager();
 
 			auto object = LuaGetObject(objectManager, objectValue);
 			if (!object) {
@@ -2136,8 +2107,28 @@ namespace Game {
 			}
 		};
 
-		object["RequestModifier"] = [this](sol::this_state L, sol::object objectValue, sol::object attackerValue, uint32_t abilityId, int32_t rank) {
-			//
+		object["RequestModifier"] = [this](sol::this_state L, sol::object objectValue, sol::object attackerValue, uint32_t abilityId, int32_t rank, sol::optional<uint32_t> duration, sol::optional<uint32_t> period) {
+			const auto& objectManager = mGame->GetObjectManager();
+
+			auto object = LuaGetObject(objectManager, objectValue);
+			if (object) {
+				auto attacker = LuaGetObject(objectManager, attackerValue);
+				object->RequestModifier(attacker, abilityId, rank, duration.value_or(Modifier::sInfiniteDuration), period.value_or(0));
+			}
+		};
+		object["RemoveModifier"] = [this](sol::this_state L, sol::object objectValue, uint32_t abilityId) {
+			auto object = LuaGetObject(mGame->GetObjectManager(), objectValue);
+			if (object) {
+				return object->RemoveModifier(abilityId);
+			}
+			return false;
+		};
+		object["HasModifier"] = [this](sol::this_state L, sol::object objectValue, uint32_t abilityId) {
+			auto object = LuaGetObject(mGame->GetObjectManager(), objectValue);
+			if (object) {
+				return object->GetModifier(abilityId) != nullptr;
+			}
+			return false;
 		};
 
 		object["AddEffect"] = &LuaFunction::Object::AddEffect;
@@ -2390,7 +2381,7 @@ namespace Game {
             return;
         }
 
-        ability->PlayAnimationSequence(mGame);
+        ability->PlayAnimationSequence(*mGame);
     };
 	}
 
@@ -2451,7 +2442,7 @@ namespace Game {
 		auto triggerVolume = mState.new_usertype<TriggerVolume>("TriggerVolume", sol::no_constructor, sol::base_classes, sol::bases<Object>());
 
 		triggerVolume["Attach"] = [this](sol::this_state L, sol::object triggerValue, sol::object objectValue) {
-			const auto& objectManager = mGame.GetObjectManager();
+			const auto& objectManager = mGame->GetObjectManager();
 
 			auto trigger = LuaGetTrigger(objectManager, triggerValue);
 			auto object = LuaGetObject(objectManager, objectValue);
@@ -2461,7 +2452,7 @@ namespace Game {
 		};
 
 		triggerVolume["Detach"] = [this](sol::this_state L, sol::object triggerValue, sol::object objectValue) {
-			const auto& objectManager = mGame.GetObjectManager();
+			const auto& objectManager = mGame->GetObjectManager();
 
 			auto trigger = LuaGetTrigger(objectManager, triggerValue);
 			auto object = LuaGetObject(objectManager, objectValue);
@@ -0,0 +1,390 @@
+
+// Include
+#include "LuaProfiler.h"
+#include "Lua.h"
+#include "Instance.h"
+
+#include <luajit.h>
+
+#include <algorithm>
+#include <format>
+
+/*
+	Nothing told which ability scripts or which bindings the tick spent its Lua time in. A run of the profiler
+	answers that for one instance, for as long as it was asked to, and costs nothing while it is not running.
+
+	Scripts are sampled by a count hook: every period VM instructions the stack of the running thread is walked
+	and counted under the ability that thread runs for. Native calls are timed through the LuaJIT C function
+	wrapper, every C function the state calls goes through OnCall while a run is on, and is counted under its
+	name at the call site. Neither needs anything from the bindings themselves.
+
+	Hooks and the wrapper are per state in LuaJIT, not per thread, so setting them on the main state covers
+	every thread. Compiled traces call neither, the JIT is off for the length of a run and everything runs in
+	the interpreter; it comes back on, with an empty trace cache, when the run ends. sol2 is built with
+	SOL_EXCEPTIONS_SAFE_PROPAGATION and does not install a wrapper of its own, so there is none to restore.
+*/
+
+namespace {
+	// Registry key of the profiler running on a state.
+	char sRegistryKey;
+}
+
+// Game
+namespace Game {
+	// LuaProfile
+	std::string LuaProfile::GetCollapsedStacks() const {
+		std::string result;
+		for (const auto& [stack, samples] : stacks) {
+			result += std::format("{} {}\n", stack, samples);
+		}
+		return result;
+	}
+
+	std::string LuaProfile::GetCollapsedBindings() const {
+		std::string result;
+		for (const auto& binding : bindings) {
+			const auto time = std::chrono::duration_cast<std::chrono::microseconds>(binding.time).count();
+			result += std::format("{} {}\n", binding.name, time);
+		}
+		return result;
+	}
+
+	std::vector<LuaProfileEntry> LuaProfile::GetTopFunctions(size_t count) const {
+		std::unordered_map<std::string_view, LuaProfileEntry> functions;
+		std::vector<std::string_view> seen;
+		for (const auto& [stack, samples] : stacks) {
+			// The ability is the root of every stack, not a function.
+			auto position = stack.find(';');
+			if (position == std::string::npos) {
+				continue;
+			}
+
+			seen.clear();
+			while (position != std::string::npos) {
+				const auto start = position + 1;
+				position = stack.find(';', start);
+
+				const auto name = std::string_view(stack).substr(start, position == std::string::npos ? std::string::npos : position - start);
+				auto& function = functions[name];
+				if (std::find(seen.begin(), seen.end(), name) == seen.end()) {
+					function.totalSamples += samples;
+					seen.push_back(name);
+				}
+
+				if (position == std::string::npos) {
+					function.selfSamples += samples;
+				}
+			}
+		}
+
+		std::vector<LuaProfileEntry> result;
+		result.reserve(functions.size());
+		for (auto& [name, function] : functions) {
+			function.name = name;
+			result.push_back(std::move(function));
+		}
+
+		std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.selfSamples != rhs.selfSamples ? lhs.selfSamples > rhs.selfSamples : lhs.totalSamples > rhs.totalSamples;
+		});
+		result.resize(std::min(result.size(), count));
+		return result;
+	}
+
+	std::vector<LuaProfileEntry> LuaProfile::GetTopBindings(size_t count) const {
+		std::unordered_map<std::string_view, LuaProfileEntry> merged;
+		for (const auto& binding : bindings) {
+			auto name = std::string_view(binding.name);
+			name = name.substr(name.find(';') + 1);
+
+			auto& entry = merged[name];
+			entry.calls += binding.calls;
+			entry.time += binding.time;
+			entry.maxTime = std::max(entry.maxTime, binding.maxTime);
+		}
+
+		std::vector<LuaProfileEntry> result;
+		result.reserve(merged.size());
+		for (auto& [name, entry] : merged) {
+			entry.name = name;
+			result.push_back(std::move(entry));
+		}
+
+		std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.time > rhs.time;
+		});
+		result.resize(std::min(result.size(), count));
+		return result;
+	}
+
+	std::vector<LuaProfileEntry> LuaProfile::GetTopAbilities(size_t count) const {
+		std::unordered_map<std::string_view, LuaProfileEntry> abilities;
+		for (const auto& [stack, samples] : stacks) {
+			const auto name = std::string_view(stack).substr(0, stack.find(';'));
+
+			abilities[name].totalSamples += samples;
+		}
+
+		for (const auto& binding : bindings) {
+			const auto name = std::string_view(binding.name).substr(0, binding.name.find(';'));
+
+			auto& ability = abilities[name];
+			ability.calls += binding.calls;
+			ability.time += binding.time;
+			ability.maxTime = std::max(ability.maxTime, binding.maxTime);
+		}
+
+		std::vector<LuaProfileEntry> result;
+		result.reserve(abilities.size());
+		for (auto& [name, ability] : abilities) {
+			ability.name = name;
+			result.push_back(std::move(ability));
+		}
+
+		std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.totalSamples != rhs.totalSamples ? lhs.totalSamples > rhs.totalSamples : lhs.time > rhs.time;
+		});
+		result.resize(std::min(result.size(), count));
+		return result;
+	}
+
+	// LuaProfiler
+	LuaProfiler::LuaProfiler(Lua& lua) : mLua(lua) {}
+
+	LuaProfiler::~LuaProfiler() {
+		// Finalizers would still run through the wrapper when the state closes.
+		if (mRunning) {
+			Detach();
+		}
+	}
+
+	void LuaProfiler::Start(Clock::duration duration, uint32_t period) {
+		Stop();
+
+		mStacks.clear();
+		mStackCount = 0;
+		mSamples = 0;
+		mDroppedSamples = 0;
+
+		mBindings.clear();
+		mNames.clear();
+		mNameList.clear();
+		GetName("?");
+
+		mPeriod = std::max<uint32_t>(period, 100);
+		mStart = Clock::now();
+		mEnd = mStart + duration;
+
+		const auto L = mLua.GetState();
+		lua_pushlightuserdata(L, &sRegistryKey);
+		lua_pushlightuserdata(L, this);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+
+		luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);
+
+		lua_pushlightuserdata(L, reinterpret_cast<void*>(&LuaProfiler::OnCall));
+		luaJIT_setmode(L, -1, LUAJIT_MODE_WRAPCFUNC | LUAJIT_MODE_ON);
+		lua_pop(L, 1);
+
+		lua_sethook(L, &LuaProfiler::OnHook, LUA_MASKCOUNT, static_cast<int>(mPeriod));
+		mRunning = true;
+
+		LuaProfile profile;
+		profile.running = true;
+		profile.period = mPeriod;
+		Publish(std::move(profile));
+	}
+
+	void LuaProfiler::Stop() {
+		if (!mRunning) {
+			return;
+		}
+
+		Detach();
+
+		LuaProfile profile;
+		profile.duration = Clock::now() - mStart;
+		profile.period = mPeriod;
+		profile.samples = mSamples;
+		profile.droppedSamples = mDroppedSamples;
+
+		profile.stacks.reserve(mStackCount);
+		for (const auto& [abilityId, stacks] : mStacks) {
+			const auto ability = GetAbilityName(abilityId);
+			for (const auto& [stack, samples] : stacks) {
+				profile.stacks.emplace_back(ability + ';' + stack, samples);
+			}
+		}
+
+		std::sort(profile.stacks.begin(), profile.stacks.end());
+
+		profile.bindings.reserve(mBindings.size());
+		for (const auto& [key, binding] : mBindings) {
+			auto& entry = profile.bindings.emplace_back();
+			entry.name = GetAbilityName(static_cast<uint32_t>(key >> 32)) + ';' + std::string(mNameList[static_cast<uint32_t>(key)]);
+			entry.calls = binding.calls;
+			entry.time = binding.time;
+			entry.maxTime = binding.maxTime;
+		}
+
+		std::sort(profile.bindings.begin(), profile.bindings.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.time > rhs.time;
+		});
+
+		mStacks.clear();
+		mBindings.clear();
+		mNames.clear();
+		mNameList.clear();
+
+		Publish(std::move(profile));
+	}
+
+	void LuaProfiler::Update() {
+		if (mRunning && Clock::now() >= mEnd) {
+			Stop();
+		}
+	}
+
+	void LuaProfiler::Detach() {
+		const auto L = mLua.GetState();
+		lua_sethook(L, nullptr, 0, 0);
+		luaJIT_setmode(L, 0, LUAJIT_MODE_WRAPCFUNC | LUAJIT_MODE_OFF);
+		luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_ON);
+
+		lua_pushlightuserdata(L, &sRegistryKey);
+		lua_pushnil(L);
+		lua_rawset(L, LUA_REGISTRYINDEX);
+		mRunning = false;
+	}
+
+	void LuaProfiler::Publish(LuaProfile profile) {
+		mLua.GetGame().SetLuaProfile(std::make_shared<const LuaProfile>(std::move(profile)));
+	}
+
+	LuaProfiler* LuaProfiler::Get(lua_State* L) {
+		// Leaves the stack as it was, OnCall runs with the arguments of the call on it.
+		lua_pushlightuserdata(L, &sRegistryKey);
+		lua_rawget(L, LUA_REGISTRYINDEX);
+		auto profiler = static_cast<LuaProfiler*>(lua_touserdata(L, -1));
+		lua_pop(L, 1);
+		return profiler;
+	}
+
+	void LuaProfiler::OnHook(lua_State* L, lua_Debug* ar) {
+		if (auto profiler = Get(L)) {
+			profiler->Sample(L);
+		}
+	}
+
+	int LuaProfiler::OnCall(lua_State* L, int (*function)(lua_State*)) {
+		auto profiler = Get(L);
+		if (!profiler) {
+			return function(L);
+		}
+
+		uint32_t name = 0;
+		if (lua_Debug ar; lua_getstack(L, 0, &ar) && lua_getinfo(L, "n", &ar) && ar.name) {
+			name = profiler->GetName(ar.name);
+		}
+
+		// Errors unwind through here as exceptions, yields return like any other call.
+		struct Timer {
+			~Timer() { profiler.Record(L, name, Clock::now() - start); }
+
+			LuaProfiler& profiler;
+			lua_State* L;
+			uint32_t name;
+			Clock::time_point start;
+		} timer { *profiler, L, name, Clock::now() };
+
+		return function(L);
+	}
+
+	void LuaProfiler::Sample(lua_State* L) {
+		static thread_local std::vector<std::string> frames;
+		static thread_local std::string stack;
+
+		mSamples++;
+
+		lua_Debug ar;
+		int depth = 0;
+		for (; depth < sMaxDepth && lua_getstack(L, depth, &ar); ++depth) {
+			lua_getinfo(L, "Sn", &ar);
+			if (frames.size() <= static_cast<size_t>(depth)) {
+				frames.emplace_back();
+			}
+
+			auto& frame = frames[depth];
+			frame.clear();
+			if (*ar.what == 'C') {
+				frame += "[C] ";
+				frame += ar.name ? ar.name : "?";
+			} else {
+				frame += ar.name ? ar.name : (*ar.what == 'm' ? "main" : "?");
+				frame += std::format(" ({}:{})", ar.short_src, ar.linedefined);
+			}
+		}
+
+		if (depth == 0) {
+			return;
+		}
+
+		stack.clear();
+		for (int i = depth; i-- > 0;) {
+			stack += frames[i];
+			if (i > 0) {
+				stack += ';';
+			}
+		}
+
+		auto& stacks = mStacks[GetAbilityId(L)];
+		if (auto it = stacks.find(stack); it != stacks.end()) {
+			it->second++;
+		} else if (mStackCount < sMaxStacks) {
+			stacks.emplace(stack, 1);
+			mStackCount++;
+		} else {
+			mDroppedSamples++;
+		}
+	}
+
+	void LuaProfiler::Record(lua_State* L, uint32_t name, Clock::duration time) {
+		const auto key = (static_cast<uint64_t>(GetAbilityId(L)) << 32) | name;
+
+		auto& binding = mBindings[key];
+		binding.calls++;
+		binding.time += time;
+		binding.maxTime = std::max(binding.maxTime, time);
+	}
+
+	uint32_t LuaProfiler::GetAbilityId(lua_State* L) const {
+		const auto thread = mLua.GetThread(L);
+		return thread ? thread->ability_id() : 0;
+	}
+
+	uint32_t LuaProfiler::GetName(std::string_view name) {
+		if (auto it = mNames.find(name); it != mNames.end()) {
+			return it->second;
+		}
+
+		if (mNames.size() >= sMaxStacks) {
+			return 0;
+		}
+
+		const auto index = static_cast<uint32_t>(mNameList.size());
+		const auto it = mNames.emplace(std::string(name), index).first;
+		mNameList.push_back(it->first);
+		return index;
+	}
+
+	std::string LuaProfiler::GetAbilityName(uint32_t abilityId) const {
+		if (abilityId == 0) {
+			return "[script]";
+		}
+
+		if (const auto ability = mLua.GetAbility(abilityId)) {
+			return ability->GetName();
+		}
+		return std::format("[ability 0x{:08X}]", abilityId);
+	}
+}
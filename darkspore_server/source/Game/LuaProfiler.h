@@ -0,0 +1,145 @@
+
+#ifndef _GAME_LUA_PROFILER_HEADER
+#define _GAME_LUA_PROFILER_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Predefined
+struct lua_State;
+struct lua_Debug;
+
+// Game
+namespace Game {
+	// Predefined
+	class Lua;
+
+	// LuaProfileEntry
+	struct LuaProfileEntry {
+		using Clock = std::chrono::steady_clock;
+
+		std::string name;
+
+		// Samples the function was the innermost frame of, and samples it was anywhere in.
+		uint64_t selfSamples = 0;
+		uint64_t totalSamples = 0;
+
+		// Native calls, their time includes whatever scripts they ran.
+		uint64_t calls = 0;
+		Clock::duration time {};
+		Clock::duration maxTime {};
+	};
+
+	// LuaProfile
+	struct LuaProfile {
+		using Clock = std::chrono::steady_clock;
+
+		bool running = false;
+		Clock::duration duration {};
+
+		// VM instructions between samples.
+		uint32_t period = 0;
+		uint64_t samples = 0;
+		uint64_t droppedSamples = 0;
+
+		// "ability;outer frame;...;inner frame" -> samples
+		std::vector<std::pair<std::string, uint64_t>> stacks;
+
+		// Named "ability;binding", sorted by time.
+		std::vector<LuaProfileEntry> bindings;
+
+		// Collapsed stacks for flamegraph.pl, in samples.
+		std::string GetCollapsedStacks() const;
+
+		// Collapsed (ability, binding) pairs, in microseconds.
+		std::string GetCollapsedBindings() const;
+
+		std::vector<LuaProfileEntry> GetTopFunctions(size_t count) const;
+		std::vector<LuaProfileEntry> GetTopBindings(size_t count) const;
+		std::vector<LuaProfileEntry> GetTopAbilities(size_t count) const;
+	};
+
+	// LuaProfiler
+	class LuaProfiler {
+		public:
+			using Clock = std::chrono::steady_clock;
+
+			static constexpr uint32_t sDefaultPeriod = 10000;
+
+			LuaProfiler(Lua& lua);
+			~LuaProfiler();
+
+			// Samples the state every period VM instructions and times every native call until duration is over.
+			void Start(Clock::duration duration, uint32_t period = sDefaultPeriod);
+			void Stop();
+
+			// Once per tick, ends the run when its time is up.
+			void Update();
+
+		private:
+			struct Binding {
+				uint64_t calls = 0;
+				Clock::duration time {};
+				Clock::duration maxTime {};
+			};
+
+			struct NameHash {
+				using is_transparent = void;
+				size_t operator()(std::string_view value) const { return std::hash<std::string_view> {}(value); }
+			};
+
+			using NameMap = std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>>;
+			using StackMap = std::unordered_map<std::string, uint64_t, NameHash, std::equal_to<>>;
+
+			static LuaProfiler* Get(lua_State* L);
+
+			static void OnHook(lua_State* L, lua_Debug* ar);
+			static int OnCall(lua_State* L, int (*function)(lua_State*));
+
+			void Detach();
+
+			// Hands the profile to the instance, which outlives this state for any reader.
+			void Publish(LuaProfile profile);
+
+			void Sample(lua_State* L);
+			void Record(lua_State* L, uint32_t name, Clock::duration time);
+
+			uint32_t GetAbilityId(lua_State* L) const;
+			uint32_t GetName(std::string_view name);
+
+			std::string GetAbilityName(uint32_t abilityId) const;
+
+		private:
+			// Distinct stacks and binding names kept per run, samples past them are only counted.
+			static constexpr size_t sMaxStacks = 65536;
+			static constexpr int sMaxDepth = 32;
+
+			Lua& mLua;
+
+			Clock::time_point mStart;
+			Clock::time_point mEnd;
+			uint32_t mPeriod = sDefaultPeriod;
+			bool mRunning = false;
+
+			// ability id -> stacks
+			std::unordered_map<uint32_t, StackMap> mStacks;
+			size_t mStackCount = 0;
+			uint64_t mSamples = 0;
+			uint64_t mDroppedSamples = 0;
+
+			// (ability id, name) -> binding
+			std::unordered_map<uint64_t, Binding> mBindings;
+			NameMap mNames;
+			std::vector<std::string_view> mNameList;
+	};
+}
+
+#endif
@@ -0,0 +1,185 @@
+
+// Include
+#include "LuaScheduler.h"
+#include "Lua.h"
+#include "Instance.h"
+#include "Timeline.h"
+
+#include <algorithm>
+
+/*
+	Yielded threads used to sit in one set that was walked every tick, asking each of them through its resume
+	condition whether it could go on. An ability waiting two seconds was asked sixty times to say no.
+
+	A thread now says what it waits for when it yields. Time waits go on the instance timeline and come back
+	once, event waits sit in a list under the event and object they wait on and come back when that event is
+	raised. Only conditions scripts alone can evaluate are still polled every tick. A thread that is woken still
+	checks its resume condition, waking up for an event that did not settle the wait just puts it back to sleep.
+
+	Every wait gets a new id, nothing is ever unscheduled or unsubscribed: a timer or subscription left over
+	from a wait that is over does not match the id of the thread any more and is dropped when it comes up.
+*/
+
+// Game
+namespace Game {
+	// LuaScheduler
+	LuaScheduler::LuaScheduler(Lua& lua) : mLua(lua) {}
+
+	void LuaScheduler::Begin(uint32_t slot, LuaWaitReason reason) {
+		if (slot >= mWaits.size()) {
+			mWaits.resize(static_cast<size_t>(slot) + 1);
+		}
+
+		End(slot);
+
+		auto& wait = mWaits[slot];
+		wait.id = mNextWait++;
+		if (mNextWait == 0) {
+			mNextWait = 1;
+		}
+
+		wait.reason = reason;
+		wait.queued = false;
+		GetCount(reason)++;
+	}
+
+	void LuaScheduler::End(uint32_t slot) {
+		if (slot < mWaits.size() && mWaits[slot].id != 0) {
+			auto& wait = mWaits[slot];
+			GetCount(wait.reason)--;
+			wait.id = 0;
+		}
+	}
+
+	bool LuaScheduler::IsWaiting(uint32_t slot) const {
+		return slot < mWaits.size() && mWaits[slot].id != 0;
+	}
+
+	void LuaScheduler::WakeAt(uint32_t slot, uint64_t time) {
+		if (IsWaiting(slot)) {
+			mLua.GetGame().GetTimeline().Schedule({ time, slot, mWaits[slot].id, TimelineEventType::LuaWake });
+		}
+	}
+
+	void LuaScheduler::Subscribe(uint32_t slot, LuaEvent event, uint32_t objectId) {
+		if (!IsWaiting(slot)) {
+			return;
+		}
+
+		auto& waiters = mSubscribers[GetKey(event, objectId)];
+		if (waiters.size() == waiters.capacity()) {
+			std::erase_if(waiters, [this](const LuaWaiter& waiter) { return !IsCurrent(waiter); });
+		}
+		waiters.push_back({ slot, mWaits[slot].id });
+	}
+
+	void LuaScheduler::Poll(uint32_t slot) {
+		if (IsWaiting(slot)) {
+			mPolled.push_back({ slot, mWaits[slot].id });
+		}
+	}
+
+	void LuaScheduler::Wake(uint32_t slot) {
+		if (IsWaiting(slot)) {
+			Wake(slot, mWaits[slot].id);
+		}
+	}
+
+	void LuaScheduler::Wake(uint32_t slot, uint32_t wait) {
+		if (slot >= mWaits.size()) {
+			return;
+		}
+
+		auto& current = mWaits[slot];
+		if (current.id == wait && !current.queued) {
+			current.queued = true;
+			mReady.push_back({ slot, wait });
+			mWoken++;
+		}
+	}
+
+	void LuaScheduler::Notify(LuaEvent event, uint32_t objectId) {
+		if (mSubscribers.empty()) {
+			return;
+		}
+
+		const auto it = mSubscribers.find(GetKey(event, objectId));
+		if (it == mSubscribers.end()) {
+			return;
+		}
+
+		// Waiters stay until their wait is over, a condition that does not hold yet is checked again on the next event.
+		auto& waiters = it->second;
+		std::erase_if(waiters, [this](const LuaWaiter& waiter) {
+			if (!IsCurrent(waiter)) {
+				return true;
+			}
+
+			Wake(waiter.slot, waiter.wait);
+			return false;
+		});
+
+		if (waiters.empty()) {
+			mSubscribers.erase(it);
+		}
+	}
+
+	void LuaScheduler::OnObjectRemoved(uint32_t objectId) {
+		Notify(LuaEvent::Death, objectId);
+		for (uint8_t event = 0; event < static_cast<uint8_t>(LuaEvent::Count); ++event) {
+			mSubscribers.erase(GetKey(static_cast<LuaEvent>(event), objectId));
+		}
+	}
+
+	void LuaScheduler::Collect(std::vector<LuaWaiter>& ready) {
+		std::erase_if(mPolled, [this](const LuaWaiter& waiter) {
+			if (!IsCurrent(waiter)) {
+				return true;
+			}
+
+			Wake(waiter.slot, waiter.wait);
+			return false;
+		});
+
+		mStats.woken = mWoken;
+		mStats.checked = 0;
+		mWoken = 0;
+
+		for (const auto& waiter : mReady) {
+			auto& wait = mWaits[waiter.slot];
+			if (wait.id == waiter.wait) {
+				wait.queued = false;
+				ready.push_back(waiter);
+				mStats.checked++;
+			}
+		}
+
+		// Wakes from here on, the threads about to resume included, are for the next update.
+		mReady.clear();
+	}
+
+	const LuaStats& LuaScheduler::GetStats() const {
+		return mStats;
+	}
+
+	uint64_t LuaScheduler::GetKey(LuaEvent event, uint32_t objectId) {
+		return (static_cast<uint64_t>(event) << 32) | objectId;
+	}
+
+	bool LuaScheduler::IsCurrent(const LuaWaiter& waiter) const {
+		return waiter.slot < mWaits.size() && mWaits[waiter.slot].id == waiter.wait;
+	}
+
+	uint32_t& LuaScheduler::GetCount(LuaWaitReason reason) {
+		switch (reason) {
+			case LuaWaitReason::Time:
+				return mStats.timeWaits;
+
+			case LuaWaitReason::Event:
+				return mStats.eventWaits;
+
+			default:
+				return mStats.predicateWaits;
+		}
+	}
+}
@@ -0,0 +1,114 @@
+
+#ifndef _GAME_LUA_SCHEDULER_HEADER
+#define _GAME_LUA_SCHEDULER_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Game
+namespace Game {
+	// Predefined
+	class Lua;
+
+	// LuaEvent
+	enum class LuaEvent : uint8_t {
+		// Killed or removed from the instance.
+		Death = 0,
+		Moved,
+		HealthChanged,
+		Count
+	};
+
+	// LuaWaitReason
+	enum class LuaWaitReason : uint8_t {
+		Time = 0,
+		Event,
+		// Checked every tick, scripts waiting on a condition only they can evaluate, or on the next tick.
+		Predicate,
+		Count
+	};
+
+	// LuaWaiter
+	struct LuaWaiter {
+		uint32_t slot;
+		uint32_t wait;
+	};
+
+	// LuaStats
+	struct LuaStats {
+		uint32_t threads = 0;
+		uint32_t timeWaits = 0;
+		uint32_t eventWaits = 0;
+		uint32_t predicateWaits = 0;
+
+		// Last update
+		uint32_t woken = 0;
+		uint32_t checked = 0;
+		uint32_t resumed = 0;
+	};
+
+	// LuaScheduler
+	class LuaScheduler {
+		public:
+			LuaScheduler(Lua& lua);
+
+			// Starts a new wait for the thread in slot, whatever it waited on before no longer wakes it.
+			void Begin(uint32_t slot, LuaWaitReason reason);
+			void End(uint32_t slot);
+
+			bool IsWaiting(uint32_t slot) const;
+			bool IsCurrent(const LuaWaiter& waiter) const;
+
+			// What the current wait of the thread in slot is woken by.
+			void WakeAt(uint32_t slot, uint64_t time);
+			void Subscribe(uint32_t slot, LuaEvent event, uint32_t objectId);
+			void Poll(uint32_t slot);
+
+			// Wakes the current wait of the thread in slot on the next update.
+			void Wake(uint32_t slot);
+
+			// Timeline events come back through here.
+			void Wake(uint32_t slot, uint32_t wait);
+
+			void Notify(LuaEvent event, uint32_t objectId);
+			void OnObjectRemoved(uint32_t objectId);
+
+			// Threads whose wait may be over, their resume condition still decides.
+			void Collect(std::vector<LuaWaiter>& ready);
+
+			const LuaStats& GetStats() const;
+
+		private:
+			struct Wait {
+				uint32_t id = 0;
+				LuaWaitReason reason = LuaWaitReason::Predicate;
+				bool queued = false;
+			};
+
+			static uint64_t GetKey(LuaEvent event, uint32_t objectId);
+
+			uint32_t& GetCount(LuaWaitReason reason);
+
+		private:
+			Lua& mLua;
+
+			// thread slot -> current wait, a wait id is never reused so anything still holding an old one is ignored.
+			std::vector<Wait> mWaits;
+			uint32_t mNextWait = 1;
+
+			// (event, object) -> waiting threads, stale waiters are dropped whenever a list is walked or grows.
+			std::unordered_map<uint64_t, std::vector<LuaWaiter>> mSubscribers;
+
+			std::vector<LuaWaiter> mPolled;
+			std::vector<LuaWaiter> mReady;
+			uint32_t mWoken = 0;
+
+			LuaStats mStats;
+	};
+}
+
+#endif
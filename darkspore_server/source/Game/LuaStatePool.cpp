@@ -0,0 +1,136 @@
+
+// Include
+#include "LuaStatePool.h"
+#include "Lua.h"
+#include "Config.h"
+#include "Main.h"
+
+#include <algorithm>
+
+/*
+	An instance used to make its lua state when it started: open the libraries, register every function, run
+	global.lua, and then run each ability script the first time something used it, in the middle of a fight.
+	States are now made ahead of time on the workers, with every ability GlobalLua loaded already registered,
+	and an instance only has to attach one to itself. Nothing in a state refers to an instance before that,
+	the functions registered with it look the instance up when they are called.
+
+	Builds run one at a time, on one worker, each posting the next until the pool is full, instead of a task
+	per missing state that would sit on the build lock. A build holds that lock until its state is in the pool,
+	so a reload of the global scripts never lands in the middle of one. An instance that finds the pool empty waits for the build
+	in progress, if any, and builds its own state only if that one was taken.
+*/
+
+// Game
+namespace Game {
+	// LuaStatePool
+	decltype(LuaStatePool::sInstance) LuaStatePool::sInstance;
+
+	LuaStatePool& LuaStatePool::Instance() {
+		return sInstance;
+	}
+
+	void LuaStatePool::Fill() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		PostBuild();
+	}
+
+	void LuaStatePool::PostBuild() {
+		const size_t count = Config::GetU32(ConfigKey::CONFIG_GAME_LUA_STATES);
+		if (mStats.building != 0 || mStates.size() >= count) {
+			return;
+		}
+
+		mStats.building = 1;
+		GetApp().GetExecutor().Post([this] {
+			std::lock_guard<std::mutex> buildLock(mBuildMutex);
+			auto lua = Build();
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStates.push_back(std::move(lua));
+			mStats.building = 0;
+			PostBuild();
+		});
+	}
+
+	std::unique_ptr<Lua> LuaStatePool::Acquire(Game::Instance& game) {
+		const auto start = Clock::now();
+
+		const auto take = [this]() -> std::unique_ptr<Lua> {
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mStates.empty()) {
+				return nullptr;
+			}
+
+			auto lua = std::move(mStates.back());
+			mStates.pop_back();
+			mStats.warmAcquires++;
+			return lua;
+		};
+
+		auto lua = take();
+		if (!lua) {
+			std::lock_guard<std::mutex> buildLock(mBuildMutex);
+			lua = take();
+			if (!lua) {
+				lua = Build();
+
+				std::lock_guard<std::mutex> lock(mMutex);
+				mStats.coldAcquires++;
+			}
+		}
+
+		lua->Attach(game);
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStats.lastAcquire = Clock::now() - start;
+		}
+
+		Fill();
+		return lua;
+	}
+
+	void LuaStatePool::Reload() {
+		std::vector<std::unique_ptr<Lua>> states;
+		{
+			std::lock_guard<std::mutex> buildLock(mBuildMutex);
+			GlobalLua::Instance().Reload();
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			states.swap(mStates);
+		}
+
+		// Old states go outside the locks, then the pool fills up again with the new scripts.
+		states.clear();
+		Fill();
+	}
+
+	LuaStatePoolStats LuaStatePool::GetStats() const {
+		std::lock_guard<std::mutex> lock(mMutex);
+		auto stats = mStats;
+		stats.ready = static_cast<uint32_t>(mStates.size());
+		return stats;
+	}
+
+	std::unique_ptr<Lua> LuaStatePool::Build() {
+		const auto start = Clock::now();
+
+		auto lua = std::make_unique<Lua>();
+		lua->Initialize();
+
+		const auto initialized = Clock::now();
+		const auto abilities = lua->PreloadAbilities();
+
+		// The collector is off from Initialize on, an instance should not inherit the garbage of the preload.
+		lua->GetCollector().Collect();
+		const auto end = Clock::now();
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStats.abilities = static_cast<uint32_t>(abilities);
+		mStats.builds++;
+		mStats.lastInit = initialized - start;
+		mStats.lastPreload = end - initialized;
+		mStats.maxBuild = std::max(mStats.maxBuild, end - start);
+		mStats.totalBuild += end - start;
+		return lua;
+	}
+}
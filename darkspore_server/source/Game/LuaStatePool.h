@@ -0,0 +1,80 @@
+
+#ifndef _GAME_LUA_STATE_POOL_HEADER
+#define _GAME_LUA_STATE_POOL_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Game
+namespace Game {
+	// Predefined
+	class Instance;
+	class Lua;
+
+	// LuaStatePoolStats
+	struct LuaStatePoolStats {
+		using Clock = std::chrono::steady_clock;
+
+		uint32_t ready = 0;
+		uint32_t building = 0;
+		uint32_t abilities = 0;
+
+		uint64_t builds = 0;
+		uint64_t warmAcquires = 0;
+		uint64_t coldAcquires = 0;
+
+		// Registration and global.lua, then the ability scripts.
+		Clock::duration lastInit {};
+		Clock::duration lastPreload {};
+		Clock::duration maxBuild {};
+		Clock::duration totalBuild {};
+
+		// How long the last instance waited for its state.
+		Clock::duration lastAcquire {};
+	};
+
+	// LuaStatePool
+	class LuaStatePool {
+		public:
+			using Clock = std::chrono::steady_clock;
+
+			static LuaStatePool& Instance();
+
+			// Builds states on the workers until GAME_LUA_STATES are ready.
+			void Fill();
+
+			// A state with every ability registered, attached to game. Built on the spot if none is ready.
+			std::unique_ptr<Lua> Acquire(Game::Instance& game);
+
+			// Reloads the global scripts, states built from the old ones are thrown away.
+			void Reload();
+
+			LuaStatePoolStats GetStats() const;
+
+		private:
+			// With mMutex held, posts the next build unless one is running or the pool is full.
+			void PostBuild();
+
+			std::unique_ptr<Lua> Build();
+
+		private:
+			static LuaStatePool sInstance;
+
+			std::vector<std::unique_ptr<Lua>> mStates;
+
+			LuaStatePoolStats mStats;
+
+			mutable std::mutex mMutex;
+
+			// One build at a time, and none while GlobalLua reloads.
+			std::mutex mBuildMutex;
+	};
+}
+
+#endif
@@ -0,0 +1,326 @@
+
+// Include
+#include "Narrowphase.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define RECAP_NARROWPHASE_SSE 1
+#	include <emmintrin.h>
+#endif
+
+/*
+	Candidates come out of the spatial index as object boxes, the query volume is a sphere or a box.
+	The hit test runs four candidates per step with SSE2 (part of every x64 target, so no extra build flags),
+	the remainder and other targets use the same math one candidate at a time. Contact details are only
+	worked out for hits, which are rare compared to candidates.
+*/
+
+// Game
+namespace Game {
+	// Narrowphase
+	void Narrowphase::Benchmark() {
+		using Clock = std::chrono::steady_clock;
+
+		constexpr std::array<size_t, 5> candidateCounts { 16, 64, 256, 1024, 4096 };
+		constexpr uint32_t iterations = 10000;
+
+		const auto elapsed = [](Clock::time_point start) {
+			return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+		};
+
+		std::cout << std::format("Narrowphase benchmark (times in microseconds per {} sphere tests)", iterations) << std::endl;
+		std::cout << std::format("{:>10} {:>10} {:>10} {:>10}", "candidates", "hits", "scalar", "batched") << std::endl;
+
+		for (auto candidateCount : candidateCounts) {
+			std::mt19937 random(static_cast<uint32_t>(candidateCount));
+			std::uniform_real_distribution<float> coordinate(-50.f, 50.f);
+			std::uniform_real_distribution<float> extent(0.5f, 3.f);
+
+			Narrowphase narrowphase;
+			std::vector<BoundingBox> boxes;
+			for (size_t i = 0; i < candidateCount; ++i) {
+				BoundingBox box;
+				box.center = glm::vec3(coordinate(random), coordinate(random), coordinate(random));
+				box.extent = glm::vec3(extent(random), extent(random), extent(random));
+
+				boxes.push_back(box);
+				narrowphase.Add(nullptr, box);
+			}
+
+			const BoundingSphere sphere(glm::vec3(0), 20.f);
+
+			std::vector<Contact> contacts;
+			std::vector<const BoundingBox*> hits;
+
+			auto start = Clock::now();
+			for (uint32_t i = 0; i < iterations; ++i) {
+				hits.clear();
+				for (const auto& box : boxes) {
+					if (sphere.Intersects(box)) {
+						hits.push_back(&box);
+					}
+				}
+			}
+			const double scalarTime = elapsed(start);
+
+			start = Clock::now();
+			for (uint32_t i = 0; i < iterations; ++i) {
+				contacts.clear();
+				narrowphase.Test(contacts, sphere);
+			}
+			const double batchedTime = elapsed(start);
+
+			if (hits.size() != contacts.size()) {
+				std::cout << std::format("Narrowphase: {} scalar hits but {} contacts", hits.size(), contacts.size()) << std::endl;
+			}
+
+			std::cout << std::format("{:>10} {:>10} {:>10.1f} {:>10.1f}", candidateCount, contacts.size(), scalarTime, batchedTime) << std::endl;
+		}
+	}
+
+	void Narrowphase::Clear() {
+		mMinX.clear();
+		mMinY.clear();
+		mMinZ.clear();
+		mMaxX.clear();
+		mMaxY.clear();
+		mMaxZ.clear();
+		mObjects.clear();
+	}
+
+	void Narrowphase::Reserve(size_t count) {
+		mMinX.reserve(count);
+		mMinY.reserve(count);
+		mMinZ.reserve(count);
+		mMaxX.reserve(count);
+		mMaxY.reserve(count);
+		mMaxZ.reserve(count);
+		mObjects.reserve(count);
+	}
+
+	void Narrowphase::Add(Object* object, const BoundingBox& boundingBox) {
+		const auto min = boundingBox.GetMin();
+		const auto max = boundingBox.GetMax();
+
+		mMinX.push_back(min.x);
+		mMinY.push_back(min.y);
+		mMinZ.push_back(min.z);
+		mMaxX.push_back(max.x);
+		mMaxY.push_back(max.y);
+		mMaxZ.push_back(max.z);
+		mObjects.push_back(object);
+	}
+
+	size_t Narrowphase::GetCandidateCount() const {
+		return mObjects.size();
+	}
+
+	void Narrowphase::Test(std::vector<Contact>& contacts, const BoundingSphere& sphere) const {
+		const auto count = mObjects.size();
+		const auto& center = sphere.center;
+		const float radiusSquared = sphere.radius * sphere.radius;
+
+		size_t i = 0;
+#ifdef RECAP_NARROWPHASE_SSE
+		const auto centerX = _mm_set1_ps(center.x);
+		const auto centerY = _mm_set1_ps(center.y);
+		const auto centerZ = _mm_set1_ps(center.z);
+		const auto radius = _mm_set1_ps(radiusSquared);
+
+		for (; i + 4 <= count; i += 4) {
+			// Distance from the center to the closest point of each box.
+			const auto dx = _mm_sub_ps(_mm_min_ps(_mm_max_ps(centerX, _mm_loadu_ps(&mMinX[i])), _mm_loadu_ps(&mMaxX[i])), centerX);
+			const auto dy = _mm_sub_ps(_mm_min_ps(_mm_max_ps(centerY, _mm_loadu_ps(&mMinY[i])), _mm_loadu_ps(&mMaxY[i])), centerY);
+			const auto dz = _mm_sub_ps(_mm_min_ps(_mm_max_ps(centerZ, _mm_loadu_ps(&mMinZ[i])), _mm_loadu_ps(&mMaxZ[i])), centerZ);
+
+			const auto distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			for (auto mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(distance, radius))); mask != 0; mask &= mask - 1) {
+				contacts.push_back(GetContact(i + std::countr_zero(mask), sphere));
+			}
+		}
+#endif
+		for (; i < count; ++i) {
+			const float dx = std::min(std::max(center.x, mMinX[i]), mMaxX[i]) - center.x;
+			const float dy = std::min(std::max(center.y, mMinY[i]), mMaxY[i]) - center.y;
+			const float dz = std::min(std::max(center.z, mMinZ[i]), mMaxZ[i]) - center.z;
+			if (dx * dx + dy * dy + dz * dz <= radiusSquared) {
+				contacts.push_back(GetContact(i, sphere));
+			}
+		}
+	}
+
+	void Narrowphase::Test(std::vector<Contact>& contacts, const BoundingBox& box) const {
+		const auto count = mObjects.size();
+		const auto min = box.GetMin();
+		const auto max = box.GetMax();
+
+		size_t i = 0;
+#ifdef RECAP_NARROWPHASE_SSE
+		const auto minX = _mm_set1_ps(min.x);
+		const auto minY = _mm_set1_ps(min.y);
+		const auto minZ = _mm_set1_ps(min.z);
+		const auto maxX = _mm_set1_ps(max.x);
+		const auto maxY = _mm_set1_ps(max.y);
+		const auto maxZ = _mm_set1_ps(max.z);
+
+		for (; i + 4 <= count; i += 4) {
+			const auto x = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&mMinX[i]), maxX), _mm_cmpge_ps(_mm_loadu_ps(&mMaxX[i]), minX));
+			const auto y = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&mMinY[i]), maxY), _mm_cmpge_ps(_mm_loadu_ps(&mMaxY[i]), minY));
+			const auto z = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&mMinZ[i]), maxZ), _mm_cmpge_ps(_mm_loadu_ps(&mMaxZ[i]), minZ));
+			for (auto mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(_mm_and_ps(x, y), z))); mask != 0; mask &= mask - 1) {
+				contacts.push_back(GetContact(i + std::countr_zero(mask), box));
+			}
+		}
+#endif
+		for (; i < count; ++i) {
+			if (mMinX[i] <= max.x && mMaxX[i] >= min.x &&
+				mMinY[i] <= max.y && mMaxY[i] >= min.y &&
+				mMinZ[i] <= max.z && mMaxZ[i] >= min.z) {
+				contacts.push_back(GetContact(i, box));
+			}
+		}
+	}
+
+	void Narrowphase::Sweep(std::vector<Contact>& contacts, const BoundingSphere& sphere, const glm::vec3& movement) const {
+		Sweep(contacts, sphere, glm::vec3(sphere.radius), movement);
+	}
+
+	void Narrowphase::Sweep(std::vector<Contact>& contacts, const BoundingBox& box, const glm::vec3& movement) const {
+		Sweep(contacts, box, box.extent, movement);
+	}
+
+	template<typename Volume>
+	void Narrowphase::Sweep(std::vector<Contact>& contacts, const Volume& volume, const glm::vec3& extent, const glm::vec3& movement) const {
+		const auto first = contacts.size();
+		const auto& origin = volume.center;
+
+		const std::array<const std::vector<float>*, 3> mins { &mMinX, &mMinY, &mMinZ };
+		const std::array<const std::vector<float>*, 3> maxs { &mMaxX, &mMaxY, &mMaxZ };
+
+		for (size_t i = 0, count = mObjects.size(); i < count; ++i) {
+			// Moving point against the grown box, one slab per axis.
+			float enter = 0;
+			float exit = 1;
+			int32_t enterAxis = -1;
+
+			bool hit = true;
+			for (glm::length_t axis = 0; axis < 3 && hit; ++axis) {
+				const float low = (*mins[axis])[i] - extent[axis];
+				const float high = (*maxs[axis])[i] + extent[axis];
+				if (movement[axis] == 0) {
+					hit = origin[axis] >= low && origin[axis] <= high;
+					continue;
+				}
+
+				float slabEnter = (low - origin[axis]) / movement[axis];
+				float slabExit = (high - origin[axis]) / movement[axis];
+				if (slabEnter > slabExit) {
+					std::swap(slabEnter, slabExit);
+				}
+
+				if (slabEnter > enter) {
+					enter = slabEnter;
+					enterAxis = axis;
+				}
+
+				exit = std::min(exit, slabExit);
+				hit = enter <= exit;
+			}
+
+			if (!hit) {
+				continue;
+			}
+
+			if (enterAxis < 0) {
+				// Overlapping before moving at all.
+				contacts.push_back(GetContact(i, volume));
+				continue;
+			}
+
+			const glm::vec3 min((*mins[0])[i], (*mins[1])[i], (*mins[2])[i]);
+			const glm::vec3 max((*maxs[0])[i], (*maxs[1])[i], (*maxs[2])[i]);
+
+			auto& contact = contacts.emplace_back();
+			contact.object = mObjects[i];
+			contact.point = glm::clamp(origin + movement * enter, min, max);
+			contact.normal[enterAxis] = movement[enterAxis] > 0 ? 1.f : -1.f;
+			contact.time = enter;
+		}
+
+		std::stable_sort(contacts.begin() + first, contacts.end(), [](const Contact& lhs, const Contact& rhs) {
+			return lhs.time < rhs.time;
+		});
+	}
+
+	Contact Narrowphase::GetContact(size_t index, const BoundingSphere& sphere) const {
+		const glm::vec3 min(mMinX[index], mMinY[index], mMinZ[index]);
+		const glm::vec3 max(mMaxX[index], mMaxY[index], mMaxZ[index]);
+
+		Contact contact;
+		contact.object = mObjects[index];
+		contact.point = glm::clamp(sphere.center, min, max);
+
+		const auto delta = contact.point - sphere.center;
+		if (const float distance = glm::length(delta); distance > 0) {
+			contact.normal = delta / distance;
+			contact.depth = sphere.radius - distance;
+			return contact;
+		}
+
+		// The center is inside the box, push the box out through its nearest face.
+		const auto toMin = sphere.center - min;
+		const auto toMax = max - sphere.center;
+
+		float nearest = std::numeric_limits<float>::max();
+		for (glm::length_t axis = 0; axis < 3; ++axis) {
+			if (toMin[axis] < nearest) {
+				nearest = toMin[axis];
+				contact.normal = glm::vec3(0);
+				contact.normal[axis] = 1;
+			}
+
+			if (toMax[axis] < nearest) {
+				nearest = toMax[axis];
+				contact.normal = glm::vec3(0);
+				contact.normal[axis] = -1;
+			}
+		}
+
+		contact.depth = nearest + sphere.radius;
+		return contact;
+	}
+
+	Contact Narrowphase::GetContact(size_t index, const BoundingBox& box) const {
+		const glm::vec3 min(mMinX[index], mMinY[index], mMinZ[index]);
+		const glm::vec3 max(mMaxX[index], mMaxY[index], mMaxZ[index]);
+
+		Contact contact;
+		contact.object = mObjects[index];
+		contact.point = glm::clamp(box.center, min, max);
+
+		// Separate along the axis with the least overlap.
+		const auto overlap = glm::min(max, box.GetMax()) - glm::max(min, box.GetMin());
+		const auto direction = (min + max) * 0.5f - box.center;
+
+		contact.depth = std::numeric_limits<float>::max();
+		for (glm::length_t axis = 0; axis < 3; ++axis) {
+			if (overlap[axis] < contact.depth) {
+				contact.depth = overlap[axis];
+				contact.normal = glm::vec3(0);
+				contact.normal[axis] = direction[axis] < 0 ? -1.f : 1.f;
+			}
+		}
+
+		return contact;
+	}
+}
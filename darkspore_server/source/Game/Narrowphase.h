@@ -0,0 +1,69 @@
+
+#ifndef _GAME_NARROWPHASE_HEADER
+#define _GAME_NARROWPHASE_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+#include "Collision.h"
+
+#include <vector>
+
+// Game
+namespace Game {
+	// Contact
+	struct Contact {
+		// Raw handle, valid until the object manager deletes marked objects.
+		Object* object = nullptr;
+
+		// Closest point of the object's box to the volume, and the direction and distance to push the object out along.
+		glm::vec3 point {};
+		glm::vec3 normal {};
+		float depth = 0;
+
+		// Fraction of a sweep's movement at first touch, 0 when already overlapping.
+		float time = 0;
+	};
+
+	// Narrowphase
+	class Narrowphase {
+		public:
+			// Prints batched and scalar test timings for 16 to 4096 candidates.
+			static void Benchmark();
+
+			void Clear();
+			void Reserve(size_t count);
+
+			void Add(Object* object, const BoundingBox& boundingBox);
+
+			size_t GetCandidateCount() const;
+
+			// Appends a contact for every candidate the volume intersects, same rules as the Intersects functions.
+			void Test(std::vector<Contact>& contacts, const BoundingSphere& sphere) const;
+			void Test(std::vector<Contact>& contacts, const BoundingBox& box) const;
+
+			// Appends a contact for every candidate the volume touches while moving, earliest first.
+			// Candidate boxes are grown by the volume, so a sphere is swept with square corners.
+			void Sweep(std::vector<Contact>& contacts, const BoundingSphere& sphere, const glm::vec3& movement) const;
+			void Sweep(std::vector<Contact>& contacts, const BoundingBox& box, const glm::vec3& movement) const;
+
+		private:
+			Contact GetContact(size_t index, const BoundingSphere& sphere) const;
+			Contact GetContact(size_t index, const BoundingBox& box) const;
+
+			template<typename Volume>
+			void Sweep(std::vector<Contact>& contacts, const Volume& volume, const glm::vec3& extent, const glm::vec3& movement) const;
+
+		private:
+			// Candidate boxes, one array per component so a batch is one load each.
+			std::vector<float> mMinX;
+			std::vector<float> mMinY;
+			std::vector<float> mMinZ;
+			std::vector<float> mMaxX;
+			std::vector<float> mMaxY;
+			std::vector<float> mMaxZ;
+
+			std::vector<Object*> mObjects;
+	};
+}
+
+#endif
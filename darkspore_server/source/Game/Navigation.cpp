@@ -0,0 +1,558 @@
+
+// Include
+#include "Navigation.h"
+#include "Level.h"
+#include "Noun.h"
+#include "Config.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <numbers>
+#include <random>
+
+/*
+	Levels only ship markersets, there is no navmesh or collision geometry on the server. The grid is rasterized
+	from the footprints of markers created with collision over the x/y plane (z is up), so pathing goes around
+	placed props and walls but not terrain. Searches are A* on 8 neighbours without cutting blocked corners,
+	resumed across ticks so a crowd asking for paths at once costs a fixed slice of every tick instead of a spike.
+*/
+
+// Game
+namespace Game {
+	// NavigationGrid
+	NavigationGridPtr NavigationGrid::Get(const std::string& name, const Level& level) {
+		static std::mutex mutex;
+		static std::unordered_map<std::string, std::weak_ptr<const NavigationGrid>> grids;
+
+		std::scoped_lock lock(mutex);
+		if (auto it = grids.find(name); it != grids.end()) {
+			if (auto grid = it->second.lock()) {
+				return grid;
+			}
+		}
+
+		const auto& nounDatabase = NounDatabase::Instance();
+
+		glm::vec2 min(std::numeric_limits<float>::max());
+		glm::vec2 max(std::numeric_limits<float>::lowest());
+
+		std::vector<BoundingBox> obstacles;
+		for (const auto& [_, markerset] : level.GetMarkersets()) {
+			for (const auto& marker : markerset.GetMarkers()) {
+				const auto& position = marker->GetPosition();
+				min = glm::min(min, glm::vec2(position));
+				max = glm::max(max, glm::vec2(position));
+
+				if (!marker->HasCollision()) {
+					continue;
+				}
+
+				const auto noun = nounDatabase.Get(marker->GetNoun());
+				if (!noun || noun->IsCreature() || noun->GetBoundingBox().IsPoint()) {
+					continue;
+				}
+
+				const auto& nounBox = noun->GetBoundingBox();
+				const float scale = marker->GetScale() > 0 ? marker->GetScale() : 1.f;
+
+				// Rotation around z turns the footprint, use the box around the turned one.
+				const float angle = glm::radians(marker->GetRotation().z);
+				const float c = std::abs(std::cos(angle));
+				const float s = std::abs(std::sin(angle));
+
+				BoundingBox box;
+				box.center = position + nounBox.center * scale;
+				box.extent = nounBox.extent * scale;
+				box.extent = glm::vec3(c * box.extent.x + s * box.extent.y, s * box.extent.x + c * box.extent.y, box.extent.z);
+				obstacles.push_back(box);
+			}
+		}
+
+		if (min.x > max.x) {
+			std::cout << std::format("Game::NavigationGrid: '{}' has no markers, paths will be straight lines", name) << std::endl;
+			min = glm::vec2(0);
+			max = glm::vec2(0);
+		}
+
+		auto grid = std::make_shared<NavigationGrid>(min - glm::vec2(sMargin), max + glm::vec2(sMargin));
+		for (const auto& obstacle : obstacles) {
+			grid->Block(obstacle);
+		}
+
+		std::cout << std::format("Game::NavigationGrid: Built '{}', {}x{} cells of {:.1f}, {} obstacles",
+			name, grid->mWidth, grid->mHeight, grid->mCellSize, obstacles.size()) << std::endl;
+
+		grids[name] = grid;
+		return grid;
+	}
+
+	NavigationGrid::NavigationGrid(const glm::vec2& min, const glm::vec2& max, float cellSize) : mOrigin(min) {
+		const auto size = glm::max(max - min, glm::vec2(cellSize));
+
+		mCellSize = std::max(cellSize, std::max(size.x, size.y) / sMaxCells);
+		mWidth = std::clamp(static_cast<int32_t>(std::ceil(size.x / mCellSize)), 1, sMaxCells);
+		mHeight = std::clamp(static_cast<int32_t>(std::ceil(size.y / mCellSize)), 1, sMaxCells);
+		mBlocked.resize(static_cast<size_t>(mWidth) * mHeight, 0);
+	}
+
+	void NavigationGrid::Block(const BoundingBox& boundingBox) {
+		const auto min = (glm::vec2(boundingBox.GetMin()) - mOrigin) / mCellSize;
+		const auto max = (glm::vec2(boundingBox.GetMax()) - mOrigin) / mCellSize;
+
+		const int32_t minX = std::max(static_cast<int32_t>(std::floor(min.x)), 0);
+		const int32_t minY = std::max(static_cast<int32_t>(std::floor(min.y)), 0);
+		const int32_t maxX = std::min(static_cast<int32_t>(std::floor(max.x)), mWidth - 1);
+		const int32_t maxY = std::min(static_cast<int32_t>(std::floor(max.y)), mHeight - 1);
+
+		for (int32_t y = minY; y <= maxY; ++y) {
+			for (int32_t x = minX; x <= maxX; ++x) {
+				mBlocked[static_cast<size_t>(y) * mWidth + x] = 1;
+			}
+		}
+	}
+
+	bool NavigationGrid::IsWalkable(int32_t x, int32_t y) const {
+		return x >= 0 && y >= 0 && x < mWidth && y < mHeight && !mBlocked[static_cast<size_t>(y) * mWidth + x];
+	}
+
+	bool NavigationGrid::IsWalkable(uint32_t cell) const {
+		return cell < mBlocked.size() && !mBlocked[cell];
+	}
+
+	uint32_t NavigationGrid::GetCell(const glm::vec3& position) const {
+		const auto local = (glm::vec2(position) - mOrigin) / mCellSize;
+		const int32_t x = std::clamp(static_cast<int32_t>(std::floor(local.x)), 0, mWidth - 1);
+		const int32_t y = std::clamp(static_cast<int32_t>(std::floor(local.y)), 0, mHeight - 1);
+		return static_cast<uint32_t>(y * mWidth + x);
+	}
+
+	glm::vec2 NavigationGrid::GetCellCenter(uint32_t cell) const {
+		const auto x = static_cast<float>(cell % mWidth);
+		const auto y = static_cast<float>(cell / mWidth);
+		return mOrigin + (glm::vec2(x, y) + 0.5f) * mCellSize;
+	}
+
+	uint32_t NavigationGrid::GetNearestWalkableCell(uint32_t cell) const {
+		constexpr int32_t maxRing = 4;
+		if (IsWalkable(cell)) {
+			return cell;
+		}
+
+		const int32_t cellX = static_cast<int32_t>(cell % mWidth);
+		const int32_t cellY = static_cast<int32_t>(cell / mWidth);
+		for (int32_t ring = 1; ring <= maxRing; ++ring) {
+			for (int32_t y = cellY - ring; y <= cellY + ring; ++y) {
+				for (int32_t x = cellX - ring; x <= cellX + ring; ++x) {
+					// Only the border of the ring, the inside was checked already.
+					if (std::abs(x - cellX) != ring && std::abs(y - cellY) != ring) {
+						continue;
+					}
+
+					if (IsWalkable(x, y)) {
+						return static_cast<uint32_t>(y * mWidth + x);
+					}
+				}
+			}
+		}
+		return sInvalidCell;
+	}
+
+	// Pathfinder
+	void Pathfinder::Benchmark() {
+		using Clock = std::chrono::steady_clock;
+
+		constexpr std::array<uint32_t, 3> agentCounts { 100, 300, 600 };
+		constexpr uint32_t groupSize = 20;
+
+		const auto elapsed = [](Clock::time_point start) {
+			return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+		};
+
+		// A 1024 unit square level with scattered props and a few long walls.
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> coordinate(-500.f, 500.f);
+		std::uniform_real_distribution<float> size(2.f, 12.f);
+
+		auto grid = std::make_shared<NavigationGrid>(glm::vec2(-512.f), glm::vec2(512.f));
+		for (uint32_t i = 0; i < 600; ++i) {
+			const glm::vec3 center(coordinate(random), coordinate(random), 0);
+			const glm::vec3 extent(size(random), size(random), 1);
+			grid->Block(BoundingBox(center - extent, center + extent));
+		}
+
+		for (int32_t i = -3; i <= 3; ++i) {
+			const float offset = static_cast<float>(i) * 120.f;
+			grid->Block(BoundingBox(glm::vec3(-400.f, offset - 2.f, -1), glm::vec3(300.f, offset + 2.f, 1)));
+		}
+
+		Pathfinder pathfinder;
+		pathfinder.SetGrid(grid);
+
+		std::cout << std::format("Pathfinding benchmark ({}x{} cells, {} us budget per tick, times in milliseconds)",
+			grid->GetWidth(), grid->GetHeight(), pathfinder.mBudget) << std::endl;
+		std::cout << std::format("{:>8} {:>8} {:>8} {:>10} {:>10} {:>12} {:>10}",
+			"agents", "ticks", "found", "max tick", "total", "unbudgeted", "repeat") << std::endl;
+
+		for (auto agentCount : agentCounts) {
+			// Agents spawn in groups and chase one of four players, like a horde would.
+			std::array<glm::vec3, 4> players {};
+			for (auto& player : players) {
+				player = glm::vec3(coordinate(random), coordinate(random), 0);
+			}
+
+			std::vector<std::pair<glm::vec3, glm::vec3>> requests;
+			std::uniform_real_distribution<float> jitter(-3.f, 3.f);
+			for (uint32_t i = 0; i < agentCount; i += groupSize) {
+				const glm::vec3 spawn(coordinate(random), coordinate(random), 0);
+				for (uint32_t j = 0; j < groupSize; ++j) {
+					requests.emplace_back(spawn + glm::vec3(jitter(random), jitter(random), 0), players[(i + j) % players.size()]);
+				}
+			}
+
+			const auto run = [&](uint64_t budget, uint32_t& ticks, uint32_t& found, double& maxTick) {
+				pathfinder.SetGrid(grid);
+				pathfinder.mBudget = budget;
+
+				uint32_t id = 1;
+				for (const auto& [from, to] : requests) {
+					pathfinder.Request(id++, from, to);
+				}
+
+				ticks = 0;
+				maxTick = 0;
+				while (pathfinder.GetPendingCount() > 0) {
+					const auto start = Clock::now();
+					pathfinder.Update();
+					maxTick = std::max(maxTick, elapsed(start));
+					++ticks;
+				}
+
+				found = 0;
+				for (uint32_t i = 1; i < id; ++i) {
+					PathPtr path;
+					found += pathfinder.TakePath(i, path) == PathStatus::Found;
+				}
+			};
+
+			const auto budget = pathfinder.mBudget;
+
+			uint32_t ticks, found;
+			double maxTick;
+
+			auto start = Clock::now();
+			run(budget, ticks, found, maxTick);
+			const double total = elapsed(start);
+
+			uint32_t unbudgetedTicks, unbudgetedFound;
+			double unbudgetedTime;
+			run(std::numeric_limits<uint64_t>::max(), unbudgetedTicks, unbudgetedFound, unbudgetedTime);
+
+			// Same requests again without clearing the cache.
+			pathfinder.mBudget = budget;
+			uint32_t id = 1;
+			start = Clock::now();
+			for (const auto& [from, to] : requests) {
+				pathfinder.Request(id++, from, to);
+			}
+			while (pathfinder.GetPendingCount() > 0) {
+				pathfinder.Update();
+			}
+			const double repeat = elapsed(start);
+
+			std::cout << std::format("{:>8} {:>8} {:>8} {:>10.2f} {:>10.2f} {:>12.2f} {:>10.2f}",
+				agentCount, ticks, found, maxTick / 1000.0, total / 1000.0, unbudgetedTime / 1000.0, repeat / 1000.0) << std::endl;
+
+			pathfinder.mBudget = budget;
+		}
+	}
+
+	Pathfinder::Pathfinder() {
+		mBudget = Config::GetU32(ConfigKey::CONFIG_GAME_PATH_BUDGET);
+	}
+
+	void Pathfinder::SetGrid(NavigationGridPtr grid) {
+		mGrid = std::move(grid);
+
+		mQueue.clear();
+		mResults.clear();
+		mCache.clear();
+		mOpen.clear();
+		mSearching = false;
+
+		const size_t cellCount = mGrid ? static_cast<size_t>(mGrid->GetWidth()) * mGrid->GetHeight() : 0;
+		mCost.assign(cellCount, 0);
+		mParent.assign(cellCount, NavigationGrid::sInvalidCell);
+		mVisited.assign(cellCount, 0);
+		mClosed.assign(cellCount, 0);
+		mStamp = 0;
+	}
+
+	const NavigationGridPtr& Pathfinder::GetGrid() const {
+		return mGrid;
+	}
+
+	PathStatus Pathfinder::Request(uint32_t id, const glm::vec3& start, const glm::vec3& goal) {
+		auto& result = mResults[id];
+		result.path.reset();
+		result.sequence = ++mSequence;
+
+		if (!mGrid) {
+			result.status = PathStatus::Unreachable;
+			return result.status;
+		}
+
+		const auto startCell = mGrid->GetCell(start);
+		const auto goalCell = mGrid->GetNearestWalkableCell(mGrid->GetCell(goal));
+		if (goalCell == NavigationGrid::sInvalidCell) {
+			result.status = PathStatus::Unreachable;
+			return result.status;
+		}
+
+		if (startCell == goalCell) {
+			result.path = std::make_shared<const Path>();
+			result.status = PathStatus::Found;
+			return result.status;
+		}
+
+		if (GetCachedPath(startCell, goalCell, result)) {
+			return result.status;
+		}
+
+		result.status = PathStatus::Pending;
+		mQueue.push_back({ id, result.sequence, startCell, goalCell });
+		return result.status;
+	}
+
+	void Pathfinder::Cancel(uint32_t id) {
+		// Queued requests go stale and are skipped when they come up.
+		mResults.erase(id);
+	}
+
+	PathStatus Pathfinder::TakePath(uint32_t id, PathPtr& path) {
+		auto it = mResults.find(id);
+		if (it == mResults.end()) {
+			return PathStatus::None;
+		}
+
+		const auto status = it->second.status;
+		if (status != PathStatus::Pending) {
+			path = std::move(it->second.path);
+			mResults.erase(it);
+		}
+		return status;
+	}
+
+	void Pathfinder::Update() {
+		using Clock = std::chrono::steady_clock;
+		if (!mGrid) {
+			return;
+		}
+
+		const auto deadline = Clock::now() + std::chrono::microseconds(std::min<uint64_t>(mBudget, 60'000'000));
+		do {
+			if (!mSearching) {
+				if (mQueue.empty()) {
+					break;
+				}
+
+				const auto request = mQueue.front();
+				mQueue.pop_front();
+				if (!IsCurrent(request)) {
+					continue;
+				}
+
+				// Another agent may have asked for the same path while this one waited.
+				if (GetCachedPath(request.start, request.goal, mResults[request.id])) {
+					continue;
+				}
+
+				Begin(request);
+			}
+
+			Step();
+		} while (Clock::now() < deadline);
+	}
+
+	size_t Pathfinder::GetPendingCount() const {
+		return mQueue.size() + (mSearching ? 1 : 0);
+	}
+
+	uint64_t Pathfinder::GetCacheKey(uint32_t start, uint32_t goal) {
+		return (static_cast<uint64_t>(start) << 32) | goal;
+	}
+
+	void Pathfinder::Begin(const PathRequest& request) {
+		if (++mStamp == 0) {
+			// Wrapped around, old stamps could match again.
+			std::fill(mVisited.begin(), mVisited.end(), 0);
+			std::fill(mClosed.begin(), mClosed.end(), 0);
+			mStamp = 1;
+		}
+
+		mCurrent = request;
+		mSearching = true;
+		mExpansions = 0;
+
+		mOpen.clear();
+		mOpen.push_back({ GetHeuristic(request.start), request.start });
+		mCost[request.start] = 0;
+		mParent[request.start] = NavigationGrid::sInvalidCell;
+		mVisited[request.start] = mStamp;
+	}
+
+	bool Pathfinder::Step() {
+		constexpr float diagonalCost = std::numbers::sqrt2_v<float>;
+		constexpr std::array<std::pair<int32_t, int32_t>, 8> neighbours {{
+			{ 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 }
+		}};
+
+		const auto compare = [](const OpenNode& lhs, const OpenNode& rhs) { return lhs.f > rhs.f; };
+		if (!IsCurrent(mCurrent)) {
+			mSearching = false;
+			return true;
+		}
+
+		const auto& grid = *mGrid;
+		const auto width = grid.GetWidth();
+		for (uint32_t i = 0; i < sClockInterval; ++i) {
+			if (mOpen.empty()) {
+				Finish(PathStatus::Unreachable);
+				return true;
+			}
+
+			if (mExpansions >= sMaxExpansions) {
+				Finish(PathStatus::Unreachable, true);
+				return true;
+			}
+
+			std::pop_heap(mOpen.begin(), mOpen.end(), compare);
+			const auto cell = mOpen.back().cell;
+			mOpen.pop_back();
+
+			if (mClosed[cell] == mStamp) {
+				continue;
+			}
+
+			mClosed[cell] = mStamp;
+			if (cell == mCurrent.goal) {
+				Finish(PathStatus::Found);
+				return true;
+			}
+
+			++mExpansions;
+
+			const int32_t x = static_cast<int32_t>(cell) % width;
+			const int32_t y = static_cast<int32_t>(cell) / width;
+			for (const auto& [dx, dy] : neighbours) {
+				const int32_t nx = x + dx;
+				const int32_t ny = y + dy;
+				if (!grid.IsWalkable(nx, ny)) {
+					continue;
+				}
+
+				const bool diagonal = dx != 0 && dy != 0;
+				if (diagonal && (!grid.IsWalkable(x + dx, y) || !grid.IsWalkable(x, y + dy))) {
+					continue;
+				}
+
+				const auto next = static_cast<uint32_t>(ny * width + nx);
+				if (mClosed[next] == mStamp) {
+					continue;
+				}
+
+				const float cost = mCost[cell] + (diagonal ? diagonalCost : 1.f);
+				if (mVisited[next] != mStamp || cost < mCost[next]) {
+					mVisited[next] = mStamp;
+					mCost[next] = cost;
+					mParent[next] = cell;
+
+					mOpen.push_back({ cost + GetHeuristic(next), next });
+					std::push_heap(mOpen.begin(), mOpen.end(), compare);
+				}
+			}
+		}
+		return false;
+	}
+
+	void Pathfinder::Finish(PathStatus status, bool givenUp) {
+		mSearching = false;
+		mOpen.clear();
+
+		PathPtr path;
+		if (status == PathStatus::Found) {
+			path = BuildPath(mCurrent.goal);
+		}
+
+		if (mCache.size() >= sMaxCachedPaths) {
+			mCache.clear();
+		}
+
+		// Unreachable goals are cached too, as an empty pointer, so nobody searches them again.
+		// One given up on at sMaxExpansions is not known to be unreachable, and is searched again after a while.
+		auto& cached = mCache[GetCacheKey(mCurrent.start, mCurrent.goal)];
+		cached.path = path;
+		cached.expires = givenUp ? std::chrono::steady_clock::now() + sGivenUpLifetime : std::chrono::steady_clock::time_point::max();
+
+		auto& result = mResults[mCurrent.id];
+		result.path = std::move(path);
+		result.status = status;
+	}
+
+	bool Pathfinder::GetCachedPath(uint32_t start, uint32_t goal, PathResult& result) {
+		auto it = mCache.find(GetCacheKey(start, goal));
+		if (it == mCache.end()) {
+			return false;
+		}
+
+		if (it->second.expires <= std::chrono::steady_clock::now()) {
+			mCache.erase(it);
+			return false;
+		}
+
+		result.path = it->second.path;
+		result.status = result.path ? PathStatus::Found : PathStatus::Unreachable;
+		return true;
+	}
+
+	PathPtr Pathfinder::BuildPath(uint32_t goal) const {
+		static thread_local std::vector<uint32_t> cells;
+
+		cells.clear();
+		for (auto cell = goal; cell != NavigationGrid::sInvalidCell; cell = mParent[cell]) {
+			cells.push_back(cell);
+		}
+		std::reverse(cells.begin(), cells.end());
+
+		// Skip the start cell and keep only the cells where the direction changes.
+		const auto direction = [](uint32_t from, uint32_t to) {
+			return static_cast<int64_t>(to) - static_cast<int64_t>(from);
+		};
+
+		auto path = std::make_shared<Path>();
+		for (size_t i = 1; i < cells.size(); ++i) {
+			if (i + 1 == cells.size() || direction(cells[i - 1], cells[i]) != direction(cells[i], cells[i + 1])) {
+				path->push_back(mGrid->GetCellCenter(cells[i]));
+			}
+		}
+		return path;
+	}
+
+	bool Pathfinder::IsCurrent(const PathRequest& request) const {
+		const auto it = mResults.find(request.id);
+		return it != mResults.end() && it->second.sequence == request.sequence && it->second.status == PathStatus::Pending;
+	}
+
+	float Pathfinder::GetHeuristic(uint32_t cell) const {
+		// Octile distance, exact on an empty grid.
+		const auto width = static_cast<uint32_t>(mGrid->GetWidth());
+		const auto dx = static_cast<float>(std::abs(static_cast<int32_t>(cell % width) - static_cast<int32_t>(mCurrent.goal % width)));
+		const auto dy = static_cast<float>(std::abs(static_cast<int32_t>(cell / width) - static_cast<int32_t>(mCurrent.goal / width)));
+		return dx + dy + (std::numbers::sqrt2_v<float> - 2.f) * std::min(dx, dy);
+	}
+}
@@ -0,0 +1,181 @@
+
+#ifndef _GAME_NAVIGATION_HEADER
+#define _GAME_NAVIGATION_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+#include "Collision.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Game
+namespace Game {
+	class Level;
+
+	// NavigationGrid
+	class NavigationGrid {
+		// Cells grow past this size when a level would need more than sMaxCells per axis.
+		static constexpr float sCellSize = 2.f;
+		static constexpr int32_t sMaxCells = 512;
+
+		// Walkable space kept around the outermost markers.
+		static constexpr float sMargin = 16.f;
+
+		public:
+			static constexpr uint32_t sInvalidCell = ~0u;
+
+			// Built once per level from every markerset marker that has collision, shared by all instances playing it.
+			static std::shared_ptr<const NavigationGrid> Get(const std::string& name, const Level& level);
+
+			NavigationGrid(const glm::vec2& min, const glm::vec2& max, float cellSize = sCellSize);
+
+			void Block(const BoundingBox& boundingBox);
+
+			int32_t GetWidth() const { return mWidth; }
+			int32_t GetHeight() const { return mHeight; }
+			float GetCellSize() const { return mCellSize; }
+
+			bool IsWalkable(int32_t x, int32_t y) const;
+			bool IsWalkable(uint32_t cell) const;
+
+			// Positions outside the grid are clamped to its border.
+			uint32_t GetCell(const glm::vec3& position) const;
+			glm::vec2 GetCellCenter(uint32_t cell) const;
+
+			// Closest walkable cell within a few rings, sInvalidCell if there is none.
+			uint32_t GetNearestWalkableCell(uint32_t cell) const;
+
+		private:
+			glm::vec2 mOrigin;
+
+			float mCellSize;
+
+			int32_t mWidth;
+			int32_t mHeight;
+
+			std::vector<uint8_t> mBlocked;
+	};
+
+	using NavigationGridPtr = std::shared_ptr<const NavigationGrid>;
+
+	// PathStatus
+	enum class PathStatus : uint8_t {
+		None = 0,
+		Pending,
+		Found,
+		Unreachable
+	};
+
+	// Path, waypoints from the first cell after the start up to the goal cell.
+	using Path = std::vector<glm::vec2>;
+	using PathPtr = std::shared_ptr<const Path>;
+
+	// Pathfinder
+	class Pathfinder {
+		// A search that expands this many cells is given up as unreachable.
+		static constexpr uint32_t sMaxExpansions = 32768;
+
+		// The clock is only read every this many expansions.
+		static constexpr uint32_t sClockInterval = 64;
+
+		// Cached paths are dropped all at once when the cache reaches this size.
+		static constexpr size_t sMaxCachedPaths = 2048;
+
+		// How long a search given up at sMaxExpansions answers for its start and goal.
+		static constexpr std::chrono::seconds sGivenUpLifetime { 2 };
+
+		public:
+			// Prints how many ticks it takes to serve hundreds of agents asking for paths on the same tick.
+			static void Benchmark();
+
+			Pathfinder();
+
+			void SetGrid(NavigationGridPtr grid);
+			const NavigationGridPtr& GetGrid() const;
+
+			// Replaces any request the object still has pending, answered from the cache right away when possible.
+			PathStatus Request(uint32_t id, const glm::vec3& start, const glm::vec3& goal);
+			void Cancel(uint32_t id);
+
+			// Hands the result over, the object's entry is dropped once it is no longer pending.
+			PathStatus TakePath(uint32_t id, PathPtr& path);
+
+			// Works on queued requests until the time budget for this tick is used up.
+			void Update();
+
+			size_t GetPendingCount() const;
+
+		private:
+			struct PathRequest {
+				uint32_t id;
+				uint32_t sequence;
+				uint32_t start;
+				uint32_t goal;
+			};
+
+			struct PathResult {
+				PathPtr path;
+				uint32_t sequence = 0;
+				PathStatus status = PathStatus::None;
+			};
+
+			struct CachedPath {
+				PathPtr path; // empty when unreachable
+				std::chrono::steady_clock::time_point expires = std::chrono::steady_clock::time_point::max();
+			};
+
+			struct OpenNode {
+				float f;
+				uint32_t cell;
+			};
+
+			static uint64_t GetCacheKey(uint32_t start, uint32_t goal);
+
+			void Begin(const PathRequest& request);
+			bool Step();
+			void Finish(PathStatus status, bool givenUp = false);
+
+			// Fills the result from the cache, expired entries are dropped.
+			bool GetCachedPath(uint32_t start, uint32_t goal, PathResult& result);
+
+			PathPtr BuildPath(uint32_t goal) const;
+
+			bool IsCurrent(const PathRequest& request) const;
+
+			float GetHeuristic(uint32_t cell) const;
+
+		private:
+			NavigationGridPtr mGrid;
+
+			std::deque<PathRequest> mQueue;
+			std::unordered_map<uint32_t, PathResult> mResults;
+			std::unordered_map<uint64_t, CachedPath> mCache;
+
+			// Search in progress, cost and parent are only valid where mVisited holds the current search stamp, same for mClosed.
+			std::vector<OpenNode> mOpen;
+			std::vector<float> mCost;
+			std::vector<uint32_t> mParent;
+			std::vector<uint32_t> mVisited;
+			std::vector<uint32_t> mClosed;
+
+			PathRequest mCurrent {};
+
+			uint64_t mBudget = 0;
+
+			uint32_t mStamp = 0;
+			uint32_t mSequence = 0;
+			uint32_t mExpansions = 0;
+
+			bool mSearching = false;
+	};
+}
+
+#endif
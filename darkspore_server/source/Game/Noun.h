@@ -7,10 +7,12 @@
 #include "Core/Utils/Functions.h"
 
 #include <array>
+#include <initializer_list>
 #include <memory>
 #include <map>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 // Game
 namespace Game {
@@ -584,6 +586,91 @@ namespace Game {
 		BossPortal				= 0xC1B461BC
 	};
 
+	// NounTypeMask
+	class NounTypeMask {
+		// Types the enum does not know about (from data or Lua) all share the last bit.
+		static constexpr uint64_t sUnknownBit = 1ull << 63;
+
+		public:
+			// An empty mask accepts every type, like an empty type list.
+			constexpr NounTypeMask() = default;
+			constexpr NounTypeMask(NounType type) : mBits(GetBit(type)) {}
+			constexpr NounTypeMask(std::initializer_list<NounType> types) {
+				for (auto type : types) {
+					mBits |= GetBit(type);
+				}
+			}
+
+			static NounTypeMask FromTypes(const std::vector<NounType>& types) {
+				NounTypeMask mask;
+				for (auto type : types) {
+					mask.mBits |= GetBit(type);
+				}
+				return mask;
+			}
+
+			constexpr bool Accepts(NounType type) const { return Accepts(GetBit(type)); }
+			constexpr bool Accepts(uint64_t bit) const { return mBits == 0 || (mBits & bit) != 0; }
+
+			constexpr NounTypeMask operator|(NounTypeMask other) const {
+				NounTypeMask mask;
+				mask.mBits = mBits | other.mBits;
+				return mask;
+			}
+
+			static constexpr uint64_t GetBit(NounType type) {
+				switch (type) {
+					case NounType::Creature: return 1ull << 0;
+					case NounType::Vehicle: return 1ull << 1;
+					case NounType::Obstacle: return 1ull << 2;
+					case NounType::SpawnPoint: return 1ull << 3;
+					case NounType::PathPoint: return 1ull << 4;
+					case NounType::Trigger: return 1ull << 5;
+					case NounType::PointLight: return 1ull << 6;
+					case NounType::SpotLight: return 1ull << 7;
+					case NounType::LineLight: return 1ull << 8;
+					case NounType::ParallelLight: return 1ull << 9;
+					case NounType::HemisphereLight: return 1ull << 10;
+					case NounType::Animator: return 1ull << 11;
+					case NounType::Animated: return 1ull << 12;
+					case NounType::GraphicsControl: return 1ull << 13;
+					case NounType::Material: return 1ull << 14;
+					case NounType::Flora: return 1ull << 15;
+					case NounType::LevelshopObject: return 1ull << 16;
+					case NounType::Terrain: return 1ull << 17;
+					case NounType::Weapon: return 1ull << 18;
+					case NounType::Building: return 1ull << 19;
+					case NounType::Handle: return 1ull << 20;
+					case NounType::HealthOrb: return 1ull << 21;
+					case NounType::ManaOrb: return 1ull << 22;
+					case NounType::ResurrectOrb: return 1ull << 23;
+					case NounType::Movie: return 1ull << 24;
+					case NounType::Loot: return 1ull << 25;
+					case NounType::PlacableEffect: return 1ull << 26;
+					case NounType::LuaJob: return 1ull << 27;
+					case NounType::AbilityObject: return 1ull << 28;
+					case NounType::LevelExitPoint: return 1ull << 29;
+					case NounType::Decal: return 1ull << 30;
+					case NounType::Water: return 1ull << 31;
+					case NounType::Grass: return 1ull << 32;
+					case NounType::Door: return 1ull << 33;
+					case NounType::Crystal: return 1ull << 34;
+					case NounType::Interactable: return 1ull << 35;
+					case NounType::Projectile: return 1ull << 36;
+					case NounType::DestructibleOrnament: return 1ull << 37;
+					case NounType::MapCamera: return 1ull << 38;
+					case NounType::Occluder: return 1ull << 39;
+					case NounType::SplineCamera: return 1ull << 40;
+					case NounType::SplineCameraNode: return 1ull << 41;
+					case NounType::BossPortal: return 1ull << 42;
+					default: return sUnknownBit;
+				}
+			}
+
+		private:
+			uint64_t mBits = 0;
+	};
+
 	// PresetExtents
 	enum class PresetExtents : uint32_t {
 		None = 0,
@@ -4,12 +4,15 @@
 #include "ObjectManager.h"
 #include "Instance.h"
 #include "Catalyst.h"
+#include "AIScheduler.h"
 
 #include "SporeNet/Part.h"
 
 #include "Core/Utils/Functions.h"
 #include "Core/Utils/Log.h"
 
+#include <algorithm>
+
 // magic numbers
 constexpr std::array<float, 19> magicNumbers {
 	1.f, // DamagePerPointOfStrength
@@ -380,10 +383,34 @@ namespace Game {
 	}
 
 	// Modifier
-	Modifier::Modifier(const ObjectPtr& object, uint32_t id) : mObject(object), mId(id) {
+	Modifier::Modifier(uint32_t id, uint32_t casterId) : mId(id), mCasterId(casterId) {
 		// 
 	}
 
+	uint32_t Modifier::GetId() const {
+		return mId;
+	}
+
+	uint32_t Modifier::GetCasterId() const {
+		return mCasterId;
+	}
+
+	const AbilityPtr& Modifier::GetAbility() const {
+		return mAbility;
+	}
+
+	void Modifier::SetAbility(AbilityPtr ability) {
+		mAbility = std::move(ability);
+	}
+
+	int32_t Modifier::GetRank() const {
+		return mRank;
+	}
+
+	void Modifier::SetRank(int32_t rank) {
+		mRank = rank;
+	}
+
 	uint32_t Modifier::GetDuration() const {
 		return mDuration;
 	}
@@ -392,11 +419,34 @@ namespace Game {
 		mDuration = duration;
 	}
 
-	void Modifier::ResetDuration() {
-		mTimestamp = mObject->GetGame().GetTime();
+	void Modifier::ResetDuration(uint64_t time) {
+		mTimestamp = time;
 		mDirty = true;
 	}
 
+	uint64_t Modifier::GetEndTime() const {
+		if (mDuration == sInfiniteDuration) {
+			return std::numeric_limits<uint64_t>::max();
+		}
+		return mTimestamp + mDuration;
+	}
+
+	uint32_t Modifier::GetPeriod() const {
+		return mPeriod;
+	}
+
+	void Modifier::SetPeriod(uint32_t period) {
+		mPeriod = period;
+	}
+
+	uint64_t Modifier::GetNextTickTime() const {
+		return mNextTickTime;
+	}
+
+	void Modifier::SetNextTickTime(uint64_t time) {
+		mNextTickTime = time;
+	}
+
 	uint8_t Modifier::GetStackCount() const {
 		return mStackCount;
 	}
@@ -406,13 +456,75 @@ namespace Game {
 		mDirty = true;
 	}
 
+	// AggroTable
+	bool AggroTable::IsEmpty() const {
+		return mEntries.empty();
+	}
+
+	float AggroTable::Get(uint32_t id) const {
+		const auto it = std::lower_bound(mEntries.begin(), mEntries.end(), id, [](const auto& entry, uint32_t value) {
+			return entry.first < value;
+		});
+		return (it != mEntries.end() && it->first == id) ? it->second : 0.f;
+	}
+
+	void AggroTable::Add(uint32_t id, float amount) {
+		auto it = std::lower_bound(mEntries.begin(), mEntries.end(), id, [](const auto& entry, uint32_t value) {
+			return entry.first < value;
+		});
+
+		if (it != mEntries.end() && it->first == id) {
+			it->second += amount;
+		} else {
+			mEntries.emplace(it, id, amount);
+		}
+	}
+
+	void AggroTable::Remove(uint32_t id) {
+		const auto it = std::lower_bound(mEntries.begin(), mEntries.end(), id, [](const auto& entry, uint32_t value) {
+			return entry.first < value;
+		});
+
+		if (it != mEntries.end() && it->first == id) {
+			mEntries.erase(it);
+		}
+	}
+
+	void AggroTable::Clear() {
+		mEntries.clear();
+	}
+
+	uint32_t AggroTable::GetHighest() const {
+		const auto it = std::max_element(mEntries.begin(), mEntries.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.second < rhs.second;
+		});
+		return it != mEntries.end() ? it->first : 0;
+	}
+
 	// AI
 	AI::AI(const ObjectPtr& object) : mObject(object) {
 		// TODO: Make some booleans to determine if certain variables are accessable
+		mThinkPhase = AIScheduler::GetThinkPhase(object->GetId());
+	}
+
+	const ObjectPtr& AI::GetObject() const {
+		return mObject;
+	}
+
+	uint32_t AI::GetThinkPhase() const {
+		return mThinkPhase;
 	}
 
-	void AI::OnTick() {
-		if (!SearchForTarget()) {
+	bool AI::IsInCombat() const {
+		return mTargetObject || !mAggro.IsEmpty();
+	}
+
+	void AI::AddAggro(uint32_t id, float amount) {
+		mAggro.Add(id, amount);
+	}
+
+	void AI::OnTick(AIScheduler& scheduler, float playerDistance) {
+		if (!SearchForTarget(scheduler, playerDistance)) {
 			return;
 		}
 
@@ -434,7 +546,7 @@ namespace Game {
 		}
 	}
 
-	bool AI::SearchForTarget() {
+	bool AI::SearchForTarget(AIScheduler& scheduler, float playerDistance) {
 		if (mTargetObject) {
 			return true;
 		}
@@ -447,14 +559,30 @@ namespace Game {
 #if 1
 		const auto& objectManager = mObject->GetObjectManager();
 
+		// Whoever hurt us the most comes first, wherever they are.
+		while (!mAggro.IsEmpty()) {
+			const auto id = mAggro.GetHighest();
+			if (auto attacker = objectManager.Get(id); attacker && !attacker->IsMarkedForDeletion()) {
+				mTargetObject = std::move(attacker);
+				return true;
+			}
+			mAggro.Remove(id);
+		}
+
+		// Only players are picked up below, skip the query while all of them are out of reach.
 		const auto searchRadius = data->GetAggroRange();
-		const auto& objects = objectManager.GetObjectsInRadius(BoundingSphere(mObject->GetPosition(), searchRadius), { NounType::Creature });
-		for (const auto& possibleTarget : objects) {
+		if (playerDistance > searchRadius) {
+			return false;
+		}
+
+		scheduler.OnTargetSearch();
+		objectManager.VisitObjectsInRadius(BoundingSphere(mObject->GetPosition(), searchRadius), NounType::Creature, [this](const ObjectPtr& possibleTarget) {
 			if (possibleTarget->IsPlayerControlled()) {
 				mTargetObject = possibleTarget;
-				break;
+				return false;
 			}
-		}
+			return true;
+		});
 #endif
 		if (mTargetObject) {
 			return true;
@@ -663,7 +791,7 @@ namespace Game {
 			}
 		} else {
 			// All nonplayer objects should have an AI object
-			mAI = std::make_unique<AI>(shared_from_this());
+			mAI = mManager.GetPools().MakeUnique<AI>(shared_from_this());
 
 			const auto& data = mNoun->GetNonPlayerClassData();
 			if (!data) {
@@ -761,7 +889,7 @@ namespace Game {
 		}
 
 		if (mAI) {
-			mAI->OnTick();
+			mManager.GetAIScheduler().Run(*mAI);
 		}
 	}
 
@@ -807,7 +935,7 @@ namespace Game {
 
 	const std::unique_ptr<CombatantData>& Object::CreateCombatantData() {
 		if (!mCombatantData) {
-			mCombatantData = std::make_unique<CombatantData>();
+			mCombatantData = mManager.GetPools().MakeUnique<CombatantData>();
 			SetFlags(GetFlags() | Flags::UpdateCombatant);
 		}
 		return GetCombatantData();
@@ -823,7 +951,7 @@ namespace Game {
 
 	const std::unique_ptr<InteractableData>& Object::CreateInteractableData() {
 		if (!mInteractableData) {
-			mInteractableData = std::make_unique<InteractableData>(shared_from_this());
+			mInteractableData = mManager.GetPools().MakeUnique<InteractableData>(shared_from_this());
 			SetFlags(GetFlags() | Flags::UpdateInteractableData);
 		}
 		return GetInteractableData();
@@ -847,7 +975,7 @@ namespace Game {
 
 	const std::unique_ptr<LootData>& Object::CreateLootData() {
 		if (!mLootData) {
-			mLootData = std::make_unique<LootData>(shared_from_this());
+			mLootData = mManager.GetPools().MakeUnique<LootData>(shared_from_this());
 			SetFlags(GetFlags() | Flags::UpdateLootData);
 		}
 		return GetLootData();
@@ -863,7 +991,7 @@ namespace Game {
 
 	const std::unique_ptr<Locomotion>& Object::CreateLocomotionData() {
 		if (!mLocomotionData) {
-			mLocomotionData = std::make_unique<Locomotion>(shared_from_this());
+			mLocomotionData = mManager.GetPools().MakeUnique<Locomotion>(shared_from_this());
 			SetFlags(GetFlags() | Flags::UpdateLocomotion);
 		}
 		return GetLocomotionData();
@@ -879,7 +1007,7 @@ namespace Game {
 
 	const std::unique_ptr<AgentBlackboard>& Object::CreateAgentBlackboardData() {
 		if (!mAgentBlackboardData) {
-			mAgentBlackboardData = std::make_unique<AgentBlackboard>(shared_from_this());
+			mAgentBlackboardData = mManager.GetPools().MakeUnique<AgentBlackboard>(shared_from_this());
 			SetFlags(GetFlags() | Flags::UpdateAgentBlackboardData);
 		}
 		return GetAgentBlackboardData();
@@ -1020,7 +1148,7 @@ namespace Game {
 	float Object::GetCurrentSpeed() const {
 		auto speed = mLinearVelocity;
 		if (mMovementType != MovementType::Default && HasAttributeData()) {
-			speed *= GetAttributeValue(AttributeType::MovementSpeedBuff) + 1.0f;
+			speed *= mAttributes->GetDerivedValue(DerivedAttribute::MovementSpeedScale);
 		}
 		return glm::length(speed);
 	}
@@ -1030,41 +1158,77 @@ namespace Game {
 			return 0;
 		}
 
-		AttributeType attribute = AttributeType::NonCombatSpeed;
+		DerivedAttribute attribute = DerivedAttribute::NonCombatMovementSpeed;
 		if (IsInCombat()) { // || GetGame().GetType() == GameType::Arena
-			attribute = AttributeType::CombatSpeed;
+			attribute = DerivedAttribute::CombatMovementSpeed;
 		}
 
-		return (GetAttributeValue(attribute) + 1.f) * GetAttributeValue(AttributeType::MovementSpeedBuff);
+		return mAttributes->GetDerivedValue(attribute);
 	}
 
 	// Physics
-	std::vector<ObjectPtr> Object::GetCollidingObjectsWith(const CollisionVolume& collisionVolume, const std::vector<NounType>& types) const {
-		static thread_local BoundingSphere localSphere {};
-		static thread_local BoundingBox localBox {};
+	void Object::GetCollidingObjectsWith(std::vector<Contact>& contacts, const CollisionVolume& collisionVolume, NounTypeMask types) const {
+		static thread_local Narrowphase narrowphase;
 
-		std::vector<ObjectPtr> result;
+		const auto gather = [this](const ObjectPtr& object) {
+			if (object.get() != this) {
+				narrowphase.Add(object.get(), object->GetBoundingBox());
+			}
+		};
+
+		narrowphase.Clear();
 		switch (collisionVolume.GetShape()) {
 			case CollisionShape::Sphere: {
-				localSphere.center = mBoundingBox.center;
-				localSphere.radius = collisionVolume.GetSphereRadius();
-				mManager.GetObjectsInRadius(localSphere, types);
+				const BoundingSphere sphere(mBoundingBox.center, collisionVolume.GetSphereRadius());
+				mManager.VisitObjectsInRegion(BoundingBox(sphere.center - sphere.radius, sphere.center + sphere.radius), types, gather);
+				narrowphase.Test(contacts, sphere);
 
 				// Line of sight for sphere
 				break;
 			}
 
 			case CollisionShape::Box: {
-				localBox.center = mBoundingBox.center;
-				localBox.extent = collisionVolume.GetBoxExtents();
-				mManager.GetObjectsInRegion(localBox, types);
+				BoundingBox box;
+				box.center = mBoundingBox.center;
+				box.extent = collisionVolume.GetBoxExtents();
+				mManager.VisitObjectsInRegion(box, types, gather);
+				narrowphase.Test(contacts, box);
 
 				// Line of sight for box
 				break;
 			}
 		}
+	}
+
+	void Object::GetSweptCollisions(std::vector<Contact>& contacts, const CollisionVolume& collisionVolume, const glm::vec3& movement, NounTypeMask types) const {
+		static thread_local Narrowphase narrowphase;
+
+		const auto extent = collisionVolume.GetShape() == CollisionShape::Sphere ? glm::vec3(collisionVolume.GetSphereRadius()) : collisionVolume.GetBoxExtents();
+		const auto& start = mBoundingBox.center;
+		const auto end = start + movement;
+
+		// Everything the volume passes over this move.
+		narrowphase.Clear();
+		mManager.VisitObjectsInRegion(BoundingBox(glm::min(start, end) - extent, glm::max(start, end) + extent), types, [this](const ObjectPtr& object) {
+			if (object.get() != this) {
+				narrowphase.Add(object.get(), object->GetBoundingBox());
+			}
+		});
+
+		switch (collisionVolume.GetShape()) {
+			case CollisionShape::Sphere: {
+				narrowphase.Sweep(contacts, BoundingSphere(start, collisionVolume.GetSphereRadius()), movement);
+				break;
+			}
 
-		return result;
+			case CollisionShape::Box: {
+				BoundingBox box;
+				box.center = start;
+				box.extent = extent;
+				narrowphase.Sweep(contacts, box, movement);
+				break;
+			}
+		}
 	}
 
 	bool Object::IsColliding() const {
@@ -1082,7 +1246,17 @@ namespace Game {
 			return false;
 		}
 
-		return !GetCollidingObjectsWith(*otherCollision, {}).empty();
+		// Level geometry only, creatures are what the creature collision volume is for.
+		static constexpr NounTypeMask geometry { NounType::Obstacle, NounType::Building };
+		static thread_local std::vector<Contact> contacts;
+
+		contacts.clear();
+		GetCollidingObjectsWith(contacts, *otherCollision, geometry);
+
+		const auto owner = GetOwnerObject();
+		return std::any_of(contacts.begin(), contacts.end(), [&owner](const Contact& contact) {
+			return contact.object != owner.get();
+		});
 	}
 
 	// Effects
@@ -1092,7 +1266,7 @@ namespace Game {
 		}
 
 		if (!mEffects) {
-			mEffects = std::make_unique<EffectList>();
+			mEffects = mManager.GetPools().MakeUnique<EffectList>();
 		}
 		return mEffects->Add(effect);
 	}
@@ -1114,30 +1288,46 @@ namespace Game {
 	// Cooldown
 	bool Object::HasCooldown(uint32_t abilityId) const {
 		// TODO: check if ability has global cooldown
-		if (auto it = mCooldowns.find(abilityId); it != mCooldowns.end()) {
+		const auto it = std::lower_bound(mCooldowns.begin(), mCooldowns.end(), abilityId, [](const auto& entry, uint32_t value) {
+			return entry.first < value;
+		});
+
+		if (it != mCooldowns.end() && it->first == abilityId) {
 			return std::get<0>(it->second) > GetGame().GetTime();
 		}
 		return false;
 	}
 
 	Cooldown Object::AddCooldown(uint32_t abilityId, uint32_t milliseconds) {
-		const auto time = GetGame().GetTime();
-		const auto& [it, inserted] = mCooldowns.try_emplace(abilityId);
-		if (inserted || time > std::get<0>(it->second)) {
+		auto& game = GetGame();
+		const auto time = game.GetTime();
+
+		auto it = std::lower_bound(mCooldowns.begin(), mCooldowns.end(), abilityId, [](const auto& entry, uint32_t value) {
+			return entry.first < value;
+		});
+
+		if (it == mCooldowns.end() || it->first != abilityId) {
+			it = mCooldowns.emplace(it, abilityId, std::make_tuple(time + milliseconds, milliseconds));
+		} else if (time > std::get<0>(it->second)) {
 			it->second = std::make_tuple(time + milliseconds, milliseconds);
 		} else {
 			const auto& [end, duration] = it->second;
 			const auto newDuration = static_cast<uint32_t>(end - time + milliseconds);
 			it->second = std::make_tuple(end - duration + newDuration, newDuration);
 		}
+
+		game.GetTimeline().Schedule({ std::get<0>(it->second), mId, abilityId, TimelineEventType::CooldownEnd });
 		return it->second;
 	}
 
 	Cooldown Object::RemoveCooldown(uint32_t abilityId, uint32_t milliseconds) {
 		Cooldown cooldown;
-		if (auto it = mCooldowns.find(abilityId); it != mCooldowns.end()) {
-			const auto time = GetGame().GetTime();
-			
+
+		const auto it = std::lower_bound(mCooldowns.begin(), mCooldowns.end(), abilityId, [](const auto& entry, uint32_t value) {
+			return entry.first < value;
+		});
+
+		if (it != mCooldowns.end() && it->first == abilityId) {
 			auto& [end, duration] = it->second;
 			if (milliseconds >= duration) {
 				mCooldowns.erase(it);
@@ -1145,6 +1335,8 @@ namespace Game {
 				end -= milliseconds;
 				duration -= milliseconds;
 				cooldown = it->second;
+
+				GetGame().GetTimeline().Schedule({ end, mId, abilityId, TimelineEventType::CooldownEnd });
 			}
 		}
 		return cooldown;
@@ -1154,6 +1346,104 @@ namespace Game {
 		return Cooldown {};
 	}
 
+	// Modifiers
+	const Modifier* Object::GetModifier(uint32_t id) const {
+		const auto it = std::lower_bound(mModifiers.begin(), mModifiers.end(), id, [](const Modifier& modifier, uint32_t value) {
+			return modifier.GetId() < value;
+		});
+
+		if (it != mModifiers.end() && it->GetId() == id) {
+			return &(*it);
+		}
+		return nullptr;
+	}
+
+	bool Object::RemoveModifier(uint32_t id) {
+		const auto it = std::lower_bound(mModifiers.begin(), mModifiers.end(), id, [](const Modifier& modifier, uint32_t value) {
+			return modifier.GetId() < value;
+		});
+
+		if (it == mModifiers.end() || it->GetId() != id) {
+			return false;
+		}
+
+		// Erased before calling into lua, the script may add or remove modifiers itself.
+		const auto ability = it->GetAbility();
+		mModifiers.erase(it);
+
+		if (ability) {
+			ability->Deactivate(shared_from_this());
+		}
+		return true;
+	}
+
+	void Object::OnTimelineEvent(const TimelineEvent& event) {
+		// Events are never cancelled, anything that was removed or rescheduled since no longer matches the event time.
+		switch (event.type) {
+			case TimelineEventType::CooldownEnd: {
+				const auto it = std::lower_bound(mCooldowns.begin(), mCooldowns.end(), event.id, [](const auto& entry, uint32_t value) {
+					return entry.first < value;
+				});
+
+				if (it != mCooldowns.end() && it->first == event.id && std::get<0>(it->second) == event.time) {
+					mCooldowns.erase(it);
+					GetGame().SendCooldownUpdate(shared_from_this(), event.id, 0, 0);
+				}
+				break;
+			}
+
+			case TimelineEventType::ModifierExpire: {
+				const auto it = std::lower_bound(mModifiers.begin(), mModifiers.end(), event.id, [](const Modifier& modifier, uint32_t value) {
+					return modifier.GetId() < value;
+				});
+
+				if (it == mModifiers.end() || it->GetId() != event.id || it->GetEndTime() != event.time) {
+					break;
+				}
+
+				// A tick due at the end still happens, its event was scheduled after this one and would find the modifier gone.
+				if (it->GetPeriod() > 0 && it->GetNextTickTime() == event.time) {
+					it->SetNextTickTime(event.time + it->GetPeriod());
+					if (const auto ability = it->GetAbility()) {
+						const auto caster = mManager.Get(it->GetCasterId());
+						ability->Tick(shared_from_this(), caster, GetPosition(), it->GetRank());
+					}
+
+					// The tick may have refreshed or removed it.
+					if (const auto modifier = GetModifier(event.id); !modifier || modifier->GetEndTime() != event.time) {
+						break;
+					}
+				}
+
+				RemoveModifier(event.id);
+				break;
+			}
+
+			case TimelineEventType::ModifierTick: {
+				const auto it = std::lower_bound(mModifiers.begin(), mModifiers.end(), event.id, [](const Modifier& modifier, uint32_t value) {
+					return modifier.GetId() < value;
+				});
+
+				if (it == mModifiers.end() || it->GetId() != event.id || it->GetPeriod() == 0 || it->GetNextTickTime() != event.time) {
+					break;
+				}
+
+				// Past the end the next tick is only remembered, a refresh picks the rhythm up from there.
+				const auto nextTickTime = event.time + it->GetPeriod();
+				it->SetNextTickTime(nextTickTime);
+				if (nextTickTime <= it->GetEndTime()) {
+					GetGame().GetTimeline().Schedule({ nextTickTime, mId, event.id, TimelineEventType::ModifierTick });
+				}
+
+				if (const auto ability = it->GetAbility()) {
+					const auto caster = mManager.Get(it->GetCasterId());
+					ability->Tick(shared_from_this(), caster, GetPosition(), it->GetRank());
+				}
+				break;
+			}
+		}
+	}
+
 	// Properties
 	float Object::GetAttributeValue(uint8_t idx) const {
 		if (mAttributes) {
@@ -1168,7 +1458,7 @@ namespace Game {
 
 	void Object::SetAttributeValue(uint8_t idx, float value) {
 		if (!mAttributes) {
-			mAttributes = std::make_unique<Attributes>();
+			mAttributes = mManager.GetPools().MakeUnique<Attributes>();
 			mAttributes->SetOwnerObject(shared_from_this());
 		}
 		mAttributes->SetValue(idx, value);
@@ -1214,7 +1504,11 @@ namespace Game {
 
 	void Object::SetHealth(float newHealth) {
 		if (HasCombatantData()) {
-			mCombatantData->mHitPoints = std::max<float>(0, std::min<float>(newHealth, GetMaxHealth()));
+			const auto hitPoints = std::max<float>(0, std::min<float>(newHealth, GetMaxHealth()));
+			if (hitPoints != mCombatantData->mHitPoints) {
+				mCombatantData->mHitPoints = hitPoints;
+				GetGame().OnLuaEvent(LuaEvent::HealthChanged, mId);
+			}
 			SetFlags(GetFlags() | Flags::UpdateCombatant);
 		}
 	}
@@ -1350,12 +1644,27 @@ namespace Game {
 
 	void Object::SetDirty(bool dirty) {
 		if (dirty) {
+			if (!IsDirty()) {
+				mManager.OnObjectMoved(mId);
+			}
 			SetFlags(GetFlags() | Flags::Dirty);
 		} else {
 			SetFlags(GetFlags() & ~Flags::Dirty);
 		}
 	}
 
+	bool Object::IsAlwaysRelevant() const {
+		return mFlags & Flags::AlwaysRelevant;
+	}
+
+	void Object::SetAlwaysRelevant(bool alwaysRelevant) {
+		if (alwaysRelevant) {
+			SetFlags(GetFlags() | Flags::AlwaysRelevant);
+		} else {
+			SetFlags(GetFlags() & ~Flags::AlwaysRelevant);
+		}
+	}
+
 	bool Object::IsMarkedForDeletion() const {
 		return mFlags & Flags::MarkedForDeletion;
 	}
@@ -1390,18 +1699,30 @@ namespace Game {
 
 			critical = CheckCritical(attackerAttributes);
 			if (critical) {
-				auto criticalIncrease = attackerAttributes->GetValue(AttributeType::CriticalDamageIncrease);
-				damage *= criticalIncrease + 1;
+				damage *= attackerAttributes->GetDerivedValue(DerivedAttribute::CriticalDamageScale);
 			}
 		}
 		
+		uint32_t attackerId = 0;
+		if (attackerAttributes) {
+			if (const auto& attacker = attackerAttributes->GetOwnerObject()) {
+				attackerId = attacker->GetId();
+			}
+		}
+
+		bool killingBlow = false;
 		if (damage > 0) {
-			SetHealth(GetHealth() - damage);
-			if (GetHealth() <= 0) {
-				GetGame().OnObjectDeath(shared_from_this(), critical, false);
+			if (mAI && attackerId != 0) {
+				mAI->AddAggro(attackerId, damage);
 			}
+
+			// Objects without combatant data die to any hit, others only to the one that takes their last hit points.
+			const auto health = GetHealth();
+			SetHealth(health - damage);
+			killingBlow = !HasCombatantData() || (health > 0 && GetHealth() <= 0);
 		}
 
+		GetGame().GetCombatResolver().QueueDamage(shared_from_this(), attackerId, damage, critical, killingBlow, direction);
 		return { true, damage, critical };
 	}
 
@@ -1433,9 +1754,10 @@ namespace Game {
 					}
 				}
 
-				multiplier += attackerAttributes->GetValue(AttributeType::HealIncrease);
 				if (utils::enum_helper<Descriptors>::test(descriptors, Descriptors::IsHoT)) {
-					multiplier += attackerAttributes->GetValue(AttributeType::HoTDoneIncrease);
+					multiplier = attackerAttributes->GetDerivedValue(DerivedAttribute::HoTHealScale);
+				} else {
+					multiplier = attackerAttributes->GetDerivedValue(DerivedAttribute::HealScale);
 				}
 			}
 
@@ -1448,7 +1770,9 @@ namespace Game {
 			}
 		}
 
-		value *= 1.f - GetAttributeValue(AttributeType::HealingReduction);
+		if (mAttributes) {
+			value *= mAttributes->GetDerivedValue(DerivedAttribute::HealingTakenScale);
+		}
 
 		float maxHealth = GetMaxHealth();
 		float health = GetHealth();
@@ -1469,6 +1793,14 @@ if (health <= 0) {
 			DistributeDamageAmongSquad(remainder);
 		}
 
+		uint32_t healerId = 0;
+		if (attackerAttributes) {
+			if (const auto& healer = attackerAttributes->GetOwnerObject()) {
+				healerId = healer->GetId();
+			}
+		}
+
+		GetGame().GetCombatResolver().QueueHeal(shared_from_this(), healerId, value, critical);
 		return { value, critical };
 	}
 
@@ -1590,8 +1922,53 @@ if (health <= 0) {
 
 	}
 
-	void Object::RequestModifier(const ObjectPtr& attacker) {
+	void Object::RequestModifier(const ObjectPtr& caster, uint32_t id, int32_t rank, uint32_t duration, uint32_t period) {
+		if (id == 0) {
+			return;
+		}
+
+		auto& game = GetGame();
+		auto& timeline = game.GetTimeline();
+
+		const auto time = game.GetTime();
+
+		auto it = std::lower_bound(mModifiers.begin(), mModifiers.end(), id, [](const Modifier& modifier, uint32_t value) {
+			return modifier.GetId() < value;
+		});
+
+		const bool added = it == mModifiers.end() || it->GetId() != id;
+		if (added) {
+			it = mModifiers.emplace(it, id, caster ? caster->GetId() : 0);
+			it->SetAbility(game.GetLua().GetAbility(id));
+		}
+
+		// Ticks are only scheduled up to the end time, whatever lies past it is not on the timeline.
+		const auto previousEndTime = added ? time : it->GetEndTime();
 
+		it->SetRank(rank);
+		it->SetStackCount(static_cast<uint8_t>(std::min<uint32_t>(it->GetStackCount() + 1, 0xFF)));
+		it->SetDuration(duration);
+		it->ResetDuration(time);
+		if (duration != Modifier::sInfiniteDuration) {
+			timeline.Schedule({ it->GetEndTime(), mId, id, TimelineEventType::ModifierExpire });
+		}
+
+		// A refresh keeps the tick rhythm of the running modifier, and restarts it if it ran past the old end.
+		if (added || it->GetPeriod() != period) {
+			it->SetPeriod(period);
+			it->SetNextTickTime(period > 0 ? time + period : 0);
+			if (period > 0 && it->GetNextTickTime() <= it->GetEndTime()) {
+				timeline.Schedule({ it->GetNextTickTime(), mId, id, TimelineEventType::ModifierTick });
+			}
+		} else if (period > 0 && it->GetNextTickTime() > previousEndTime && it->GetNextTickTime() <= it->GetEndTime()) {
+			timeline.Schedule({ it->GetNextTickTime(), mId, id, TimelineEventType::ModifierTick });
+		}
+
+		if (added) {
+			if (const auto ability = it->GetAbility()) {
+				ability->Activate(shared_from_this());
+			}
+		}
 	}
 
 	void Object::OnChangeHealth(float healthChange) {
@@ -1760,38 +2137,40 @@ if (health <= 0) {
 		stream.SetWriteOffset(writeOffset + size);
 	}
 
-	void Object::WriteReflection(RakNet::BitStream& stream) const {
+	void Object::WriteReflection(RakNet::BitStream& stream, bool full) const {
+		const auto dataBits = full ? decltype(mDataBits)().set() : mDataBits;
+
 		RakNet::reflection_serializer<23> reflector(stream);
 		reflector.begin();
-		if (mDataBits.any()) {
-			if (mDataBits.test(0)) { reflector.write<0>(mTeam); }
-			if (mDataBits.test(1)) { reflector.write<1>(mbPlayerControlled); }
-			if (mDataBits.test(2)) { reflector.write<2>(mInputSyncStamp); }
-			if (mDataBits.test(3)) { reflector.write<3>(mPlayerIndex); }
-			if (mDataBits.test(4)) { reflector.write<4>(mLinearVelocity); }
-			if (mDataBits.test(5)) { reflector.write<5>(mAngularVelocity); }
-			if (mDataBits.test(6)) { reflector.write<6>(GetPosition()); }
-			if (mDataBits.test(7)) { reflector.write<7>(mOrientation); }
-			if (mDataBits.test(8)) { reflector.write<8>(mScale); }
-			if (mDataBits.test(9)) { reflector.write<9>(mMarkerScale); }
-			if (mDataBits.test(10)) { reflector.write<10>(mLastAnimationState); }
-			if (mDataBits.test(11)) { reflector.write<11>(mLastAnimationPlayTime); }
-			if (mDataBits.test(12)) { reflector.write<12>(mOverrideMoveIdleAnimationState); }
-			if (mDataBits.test(13)) { reflector.write<13>(mGraphicsState); }
-			if (mDataBits.test(14)) { reflector.write<14>(mGraphicsStateStartTime); }
-			if (mDataBits.test(15)) { reflector.write<15>(mNewGraphicsStateStartTime); }
-			if (mDataBits.test(16)) { reflector.write<16>(mVisible); }
-			if (mDataBits.test(17)) { reflector.write<17>(mbHasCollision); }
-
-			if (mDataBits.test(18)) {
+		if (dataBits.any()) {
+			if (dataBits.test(0)) { reflector.write<0>(mTeam); }
+			if (dataBits.test(1)) { reflector.write<1>(mbPlayerControlled); }
+			if (dataBits.test(2)) { reflector.write<2>(mInputSyncStamp); }
+			if (dataBits.test(3)) { reflector.write<3>(mPlayerIndex); }
+			if (dataBits.test(4)) { reflector.write<4>(mLinearVelocity); }
+			if (dataBits.test(5)) { reflector.write<5>(mAngularVelocity); }
+			if (dataBits.test(6)) { reflector.write<6>(GetPosition()); }
+			if (dataBits.test(7)) { reflector.write<7>(mOrientation); }
+			if (dataBits.test(8)) { reflector.write<8>(mScale); }
+			if (dataBits.test(9)) { reflector.write<9>(mMarkerScale); }
+			if (dataBits.test(10)) { reflector.write<10>(mLastAnimationState); }
+			if (dataBits.test(11)) { reflector.write<11>(mLastAnimationPlayTime); }
+			if (dataBits.test(12)) { reflector.write<12>(mOverrideMoveIdleAnimationState); }
+			if (dataBits.test(13)) { reflector.write<13>(mGraphicsState); }
+			if (dataBits.test(14)) { reflector.write<14>(mGraphicsStateStartTime); }
+			if (dataBits.test(15)) { reflector.write<15>(mNewGraphicsStateStartTime); }
+			if (dataBits.test(16)) { reflector.write<16>(mVisible); }
+			if (dataBits.test(17)) { reflector.write<17>(mbHasCollision); }
+
+			if (dataBits.test(18)) {
 				const auto& owner = GetOwnerObject();
 				reflector.write<18>(owner ? owner->GetId() : 0);
 			}
 
-			if (mDataBits.test(19)) { reflector.write<19>(mMovementType); }
-			if (mDataBits.test(20)) { reflector.write<20>(mDisableRepulsion); }
-			if (mDataBits.test(21)) { reflector.write<21>(mInteractableState); }
-			if (mDataBits.test(22)) { reflector.write<22>(mMarkerId); }
+			if (dataBits.test(19)) { reflector.write<19>(mMovementType); }
+			if (dataBits.test(20)) { reflector.write<20>(mDisableRepulsion); }
+			if (dataBits.test(21)) { reflector.write<21>(mInteractableState); }
+			if (dataBits.test(22)) { reflector.write<22>(mMarkerId); }
 		}
 		reflector.end();
 	}
@@ -1804,6 +2183,14 @@ if (health <= 0) {
 		return (mFlags & Object::UpdateFlags) || mDataBits.any();
 	}
 
+	void Object::ReleaseComponents() {
+		mAI.reset();
+		mLocomotionData.reset();
+		mAgentBlackboardData.reset();
+		mLootData.reset();
+		mInteractableData.reset();
+	}
+
 	uint16_t Object::GetFlags() const {
 		return mFlags;
 	}
@@ -7,6 +7,10 @@
 #include "Attributes.h"
 #include "Locomotion.h"
 #include "Lua.h"
+#include "SpatialIndex.h"
+#include "Narrowphase.h"
+#include "Timeline.h"
+#include "ObjectPool.h"
 
 #include <map>
 #include <tuple>
@@ -21,6 +25,7 @@ namespace Game {
 
 	class Object;
 	class ObjectManager;
+	class AIScheduler;
 
 	using ObjectPtr = std::shared_ptr<Object>;
 
@@ -33,7 +38,7 @@ namespace Game {
 	};
 
 	// EffectList
-	class EffectList {
+	class EffectList : public Pooled {
 		public:
 			uint8_t Add(uint32_t effect);
 			uint8_t Remove(uint32_t effect);
@@ -57,7 +62,7 @@ namespace Game {
 	};
 
 	// CombatantData
-	class CombatantData {
+	class CombatantData : public Pooled {
 		public:
 			void WriteTo(RakNet::BitStream& stream) const;
 			void WriteReflection(RakNet::BitStream& stream) const;
@@ -74,7 +79,7 @@ namespace Game {
 	};
 
 	// InteractableData
-	class InteractableData {
+	class InteractableData : public Pooled {
 		public:
 			InteractableData(const ObjectPtr& object);
 
@@ -102,7 +107,7 @@ namespace Game {
 	};
 
 	// LootData
-	class LootData {
+	class LootData : public Pooled {
 		public:
 			LootData(const ObjectPtr& object);
 
@@ -152,7 +157,7 @@ namespace Game {
 	};
 
 	// AgentBlackboard
-	class AgentBlackboard {
+	class AgentBlackboard : public Pooled {
 		public:
 			AgentBlackboard(const ObjectPtr& object);
 
@@ -189,23 +194,48 @@ namespace Game {
 	// Modifier
 	class Modifier {
 		public:
-			Modifier(const ObjectPtr& object, uint32_t id);
+			static constexpr uint32_t sInfiniteDuration = 0xFFFFFFFF;
+
+			Modifier(uint32_t id, uint32_t casterId);
+
+			uint32_t GetId() const;
+			uint32_t GetCasterId() const;
+
+			const AbilityPtr& GetAbility() const;
+			void SetAbility(AbilityPtr ability);
+
+			int32_t GetRank() const;
+			void SetRank(int32_t rank);
 
 			uint32_t GetDuration() const;
 			void SetDuration(uint32_t duration);
-			void ResetDuration();
+			void ResetDuration(uint64_t time);
+
+			// Game time the modifier runs out, never for infinite durations.
+			uint64_t GetEndTime() const;
+
+			// Milliseconds between periodic ticks, 0 for modifiers that do not tick.
+			uint32_t GetPeriod() const;
+			void SetPeriod(uint32_t period);
+
+			uint64_t GetNextTickTime() const;
+			void SetNextTickTime(uint64_t time);
 
 			uint8_t GetStackCount() const;
 			void SetStackCount(uint8_t count);
 
 		private:
-			ObjectPtr mObject;
-			ObjectPtr mTargetObject;
+			AbilityPtr mAbility;
 
 			uint64_t mTimestamp = 0;
+			uint64_t mNextTickTime = 0;
 
 			uint32_t mId = 0;
-			uint32_t mDuration = 0xFFFFFFFF;
+			uint32_t mCasterId = 0;
+			uint32_t mDuration = sInfiniteDuration;
+			uint32_t mPeriod = 0;
+
+			int32_t mRank = 0;
 
 			uint8_t mStackCount = 0;
 
@@ -213,25 +243,53 @@ namespace Game {
 			bool mDirty = true;
 	};
 
+	// AggroTable
+	class AggroTable {
+		public:
+			bool IsEmpty() const;
+
+			float Get(uint32_t id) const;
+			void Add(uint32_t id, float amount);
+			void Remove(uint32_t id);
+			void Clear();
+
+			// Id with the most aggro, 0 when empty.
+			uint32_t GetHighest() const;
+
+		private:
+			// Sorted by id. An agent is rarely hit by more than a handful of objects, a flat array beats a node per entry.
+			std::vector<std::pair<uint32_t, float>> mEntries;
+	};
+
 	// AI
-	class AI {
+	class AI : public Pooled {
 		public:
 			AI(const ObjectPtr& object);
 
-			void OnTick();
+			const ObjectPtr& GetObject() const;
+
+			uint32_t GetThinkPhase() const;
+			bool IsInCombat() const;
+
+			void AddAggro(uint32_t id, float amount);
+
+			// Called by the scheduler on the agent's think ticks only.
+			void OnTick(AIScheduler& scheduler, float playerDistance);
 
 		private:
-			bool SearchForTarget();
+			bool SearchForTarget(AIScheduler& scheduler, float playerDistance);
 
 			bool UseAbility(uint32_t id);
 			void UseAbility();
 
 		private:
-			std::map<uint32_t, float> mAggroMap;
+			AggroTable mAggro;
 
 			ObjectPtr mObject;
 			ObjectPtr mTargetObject;
 
+			uint32_t mThinkPhase = 0;
+
 			uint8_t mNode = 0;
 			uint8_t mGambit = 0;
 
@@ -269,7 +327,7 @@ namespace Game {
 	}
 
 	// Object
-	class Object : public std::enable_shared_from_this<Object> {
+	class Object : public std::enable_shared_from_this<Object>, public Pooled {
 		public:
 			enum Flags : uint16_t {
 				None							= 0,
@@ -282,6 +340,7 @@ namespace Game {
 				UpdateAgentBlackboardData		= 1 << 6,
 				UpdateInteractableData			= 1 << 7,
 				UpdateLocomotion				= 1 << 8,
+				AlwaysRelevant					= 1 << 9,
 
 				UpdateFlags = UpdateCombatant | UpdateAttributes | UpdateLootData | UpdateAgentBlackboardData | UpdateInteractableData | UpdateLocomotion
 			};
@@ -372,7 +431,8 @@ namespace Game {
 			float GetModifiedMovementSpeed() const;
 			
 			// Physics
-			std::vector<ObjectPtr> GetCollidingObjectsWith(const CollisionVolume& collisionVolume, const std::vector<NounType>& types) const;
+			void GetCollidingObjectsWith(std::vector<Contact>& contacts, const CollisionVolume& collisionVolume, NounTypeMask types) const;
+			void GetSweptCollisions(std::vector<Contact>& contacts, const CollisionVolume& collisionVolume, const glm::vec3& movement, NounTypeMask types) const;
 			bool IsColliding() const;
 
 			// Effects
@@ -386,6 +446,13 @@ namespace Game {
 			Cooldown RemoveCooldown(uint32_t abilityId, uint32_t milliseconds);
 			Cooldown ScaleCooldown(uint32_t abilityId, float scale);
 
+			// Modifiers
+			const Modifier* GetModifier(uint32_t id) const;
+			bool RemoveModifier(uint32_t id);
+
+			// Called by the instance for every timeline event due for this object.
+			void OnTimelineEvent(const TimelineEvent& event);
+
 			// Properties
 			float GetAttributeValue(uint8_t idx) const;
 			float GetAttributeValue(AttributeType type) const;
@@ -440,6 +507,10 @@ namespace Game {
 			bool IsDirty() const;
 			void SetDirty(bool dirty);
 
+			// Replicated to every client regardless of distance (bosses, objectives, ...)
+			bool IsAlwaysRelevant() const;
+			void SetAlwaysRelevant(bool alwaysRelevant);
+
 			bool IsMarkedForDeletion() const;
 			void MarkForDeletion();
 
@@ -474,7 +545,8 @@ namespace Game {
 			);
 			
 			void RequestAbility(const AbilityPtr& ability, const ObjectPtr& attacker);
-			void RequestModifier(const ObjectPtr& attacker);
+			// Requesting an active modifier again adds a stack and restarts its duration.
+			void RequestModifier(const ObjectPtr& caster, uint32_t id, int32_t rank, uint32_t duration, uint32_t period);
 
 			void OnChangeHealth(float healthChange);
 			void OnChangeMana(float manaChange);
@@ -500,13 +572,18 @@ namespace Game {
 
 			// Network & reflection
 			void WriteTo(RakNet::BitStream& stream) const;
-			void WriteReflection(RakNet::BitStream& stream) const;
+
+			// full writes every field instead of the dirty ones, for clients that never received this object.
+			void WriteReflection(RakNet::BitStream& stream, bool full = false) const;
 
 			void ResetUpdateBits();
 
 		protected:
 			bool NeedUpdate() const;
 
+			// Components with a reference back to the object are dropped on deletion, or nothing with AI, locomotion or loot would ever be freed.
+			void ReleaseComponents();
+
 			uint16_t GetFlags() const;
 			void SetFlags(uint16_t flags);
 
@@ -521,8 +598,9 @@ namespace Game {
 
 			BoundingBox mBoundingBox;
 
-			std::unordered_map<uint32_t, std::shared_ptr<Modifier>> mModifiers;
-			std::map<uint32_t, Cooldown> mCooldowns;
+			// Both sorted by id, expiry is scheduled on the instance timeline instead of being polled.
+			std::vector<Modifier> mModifiers;
+			std::vector<std::pair<uint32_t, Cooldown>> mCooldowns;
 
 			std::unique_ptr<EffectList> mEffects;
 			std::unique_ptr<Attributes> mAttributes;
@@ -577,10 +655,12 @@ namespace Game {
 
 			friend class Instance;
 			friend class ObjectManager;
+			friend class InterestManager;
 			friend class InteractableData;
 			friend class LootData;
 			friend class AgentBlackboard;
 			friend class Locomotion;
+			friend class LagCompensation;
 	};
 }
 
@@ -41,29 +41,6 @@ namespace Game {
 		}
 	}
 
-	void TriggerVolume::OnTick(float deltaTime) {
-		Object::OnTick(deltaTime);
-		if (mObjectStates.empty()) {
-			return;
-		}
-
-		auto radius = mBoundingBox.extent.x;
-		for (auto it = mObjectStates.begin(); it != mObjectStates.end(); ++it) {
-			bool isInRadius = glm::distance(it->first->GetPosition(), GetPosition()) <= radius;
-			if (it->second == 0) {
-				if (isInRadius) {
-					OnEnter(it->first);
-					it->second = 1;
-				}
-			} else if (isInRadius) {
-				OnStay(it->first);
-			} else {
-				OnExit(it->first);
-				it = mObjectStates.erase(it);
-			}
-		}
-	}
-
 	const ObjectPtr& TriggerVolume::GetOwnerObject() const {
 		return mOwnerObject;
 	}
@@ -78,17 +55,6 @@ namespace Game {
 		}
 	}
 
-	void TriggerVolume::AddObject(const ObjectPtr& object) {
-		if (object == mOwnerObject) {
-			return;
-		}
-
-		const auto& [it, inserted] = mObjectStates.try_emplace(object);
-		if (inserted) {
-			it->second = 0;
-		}
-	}
-
 	void TriggerVolume::SetOnEnterCallback(sol::protected_function callback) {
 		mOnEnter = std::move(callback);
 		if (!mEnvironment && mOnEnter) {
@@ -132,8 +98,32 @@ namespace Game {
 	}
 
 	// ObjectManager
-	ObjectManager::ObjectManager(Instance& game) : mGame(game) {
-		mOctTree = std::make_unique<OctTree>();
+	ObjectManager::ObjectManager(Instance& game) : ObjectManager(game, SpatialIndex::GetConfiguredType()) {}
+	ObjectManager::ObjectManager(Instance& game, SpatialIndexType spatialIndexType) : mGame(game), mAIScheduler(game), mTriggerSystem(*this), mLagCompensation(*this) {
+		mSpatialIndex = SpatialIndex::Create(spatialIndexType);
+
+		// Named up front for the stats.
+		mPools = std::make_shared<ObjectPools>();
+		mPools->Get<Object>("Object");
+		mPools->Get<TriggerVolume>("TriggerVolume");
+		mPools->Get<Attributes>("Attributes");
+		mPools->Get<CombatantData>("CombatantData");
+		mPools->Get<InteractableData>("InteractableData");
+		mPools->Get<LootData>("LootData");
+		mPools->Get<Locomotion>("Locomotion");
+		mPools->Get<AgentBlackboard>("AgentBlackboard");
+		mPools->Get<AI>("AI");
+		mPools->Get<EffectList>("EffectList");
+
+		// Reserve slot 0 for the invalid id.
+		mSlots.emplace_back();
+	}
+
+	ObjectManager::~ObjectManager() {
+		// Players may still hold their characters, everything else goes back to the pools.
+		for (const auto& object : mActiveObjects) {
+			object->ReleaseComponents();
+		}
 	}
 
 	Instance& ObjectManager::GetGame() {
@@ -144,13 +134,15 @@ namespace Game {
 		return mGame;
 	}
 
-	const std::unordered_set<ObjectPtr>& ObjectManager::GetActiveObjects() const {
+	const std::vector<ObjectPtr>& ObjectManager::GetActiveObjects() const {
 		return mActiveObjects;
 	}
 
 	ObjectPtr ObjectManager::Get(uint32_t id) const {
-		if (auto it = mObjects.find(id); it != mObjects.end()) {
-			return it->second;
+		if (const auto index = GetIndex(id); index < mSlots.size()) {
+			if (const auto& slot = mSlots[index]; slot.id == id) {
+				return slot.object;
+			}
 		}
 		return nullptr;
 	}
@@ -161,23 +153,16 @@ namespace Game {
 			return nullptr;
 		}
 
-		const auto& [it, inserted] = mObjects.try_emplace(id);
-		if (inserted) {
-			// Create a new object
-			auto object = ObjectPtr(new Object(*this, id, noun));
-			it->second = object;
+		// Create a new object
+		auto object = ObjectPtr(new (mPools->Get<Object>()) Object(*this, id, noun), std::default_delete<Object>(), PoolAllocator<Object>(mPools, "ObjectControlBlock"));
 
-			// Initialize object (cannot use shared_from_this() when creating the object)
-			object->Initialize();
+		// Initialize object (cannot use shared_from_this() when creating the object)
+		object->Initialize();
 
-			// Add to octree and active list
-			mOctTree->Enqueue(object);
-			mActiveObjects.insert(object);
+		// Add to slots, spatial index and active list
+		Insert(object);
 
-			return std::move(object);
-		}
-
-		return nullptr;
+		return object;
 	}
 
 	ObjectPtr ObjectManager::Create(const MarkerPtr& marker) {
@@ -226,10 +211,8 @@ namespace Game {
 	}
 
 	TriggerVolumePtr ObjectManager::GetTrigger(uint32_t id) const {
-		if (auto it = mObjects.find(id); it != mObjects.end()) {
-			if (it->second->IsTrigger()) {
-				return std::static_pointer_cast<TriggerVolume>(it->second);
-			}
+		if (auto object = Get(id); object && object->IsTrigger()) {
+			return std::static_pointer_cast<TriggerVolume>(object);
 		}
 		return nullptr;
 	}
@@ -240,26 +223,70 @@ namespace Game {
 			return nullptr;
 		}
 
-		const auto& [it, inserted] = mObjects.try_emplace(id);
-		if (inserted) {
-			auto object = TriggerVolumePtr(new TriggerVolume(*this, id, position, radius));
-			it->second = object;
+		auto object = TriggerVolumePtr(new (mPools->Get<TriggerVolume>()) TriggerVolume(*this, id, position, radius), std::default_delete<TriggerVolume>(), PoolAllocator<TriggerVolume>(mPools, "TriggerVolumeControlBlock"));
+		Insert(object);
 
-			mOctTree->Enqueue(object);
-			mActiveObjects.insert(object);
+		return object;
+	}
 
-			return std::move(object);
-		}
+	SpatialIndex& ObjectManager::GetSpatialIndex() {
+		return *mSpatialIndex;
+	}
 
-		return nullptr;
+	const SpatialIndex& ObjectManager::GetSpatialIndex() const {
+		return *mSpatialIndex;
+	}
+
+	AIScheduler& ObjectManager::GetAIScheduler() {
+		return mAIScheduler;
+	}
+
+	const AIScheduler& ObjectManager::GetAIScheduler() const {
+		return mAIScheduler;
+	}
+
+	TriggerSystem& ObjectManager::GetTriggerSystem() {
+		return mTriggerSystem;
+	}
+
+	const TriggerSystem& ObjectManager::GetTriggerSystem() const {
+		return mTriggerSystem;
 	}
 
-	std::vector<ObjectPtr> ObjectManager::GetObjectsInRegion(const BoundingBox& region, const std::vector<NounType>& types) const {
-		return mOctTree->GetObjectsInRegion(region, types);
+	LagCompensation& ObjectManager::GetLagCompensation() {
+		return mLagCompensation;
 	}
 
-	std::vector<ObjectPtr> ObjectManager::GetObjectsInRadius(const BoundingSphere& region, const std::vector<NounType>& types) const {
-		return mOctTree->GetObjectsInRadius(region, types);
+	const LagCompensation& ObjectManager::GetLagCompensation() const {
+		return mLagCompensation;
+	}
+
+	ObjectPools& ObjectManager::GetPools() {
+		return *mPools;
+	}
+
+	const ObjectPools& ObjectManager::GetPools() const {
+		return *mPools;
+	}
+
+	void ObjectManager::VisitObjectsInRegion(const BoundingBox& region, NounTypeMask types, ObjectVisitor visitor) const {
+		mSpatialIndex->VisitObjectsInRegion(region, types, visitor);
+	}
+
+	void ObjectManager::VisitObjectsInRadius(const BoundingSphere& region, NounTypeMask types, ObjectVisitor visitor) const {
+		mSpatialIndex->VisitObjectsInRadius(region, types, visitor);
+	}
+
+	void ObjectManager::GetObjectsInRegion(std::vector<Object*>& objects, const BoundingBox& region, NounTypeMask types) const {
+		mSpatialIndex->GetObjectsInRegion(objects, region, types);
+	}
+
+	void ObjectManager::GetObjectsInRadius(std::vector<Object*>& objects, const BoundingSphere& region, NounTypeMask types) const {
+		mSpatialIndex->GetObjectsInRadius(objects, region, types);
+	}
+
+	void ObjectManager::GetNearestObjects(std::vector<Object*>& objects, const BoundingSphere& region, size_t count, NounTypeMask types) const {
+		mSpatialIndex->GetNearestObjects(objects, region, count, types);
 	}
 
 	bool ObjectManager::IsInLineOfSight(const ObjectPtr& object, const ObjectPtr& target, const glm::vec3& targetPosition) const {
@@ -287,31 +314,39 @@ namespace Game {
 	}
 
 	void ObjectManager::Update(float deltaTime) {
-		mOctTree->Update();
-		for (const auto& object : mActiveObjects) {
-			object->OnTick(deltaTime);
-			if (object->NeedUpdate()) {
+		mSpatialIndex->Update();
+		mTriggerSystem.Update();
+
+		// Objects created while ticking are appended and wait for the next tick, nothing is removed until below.
+		mAIScheduler.BeginTick();
+		const auto activeCount = mActiveObjects.size();
+		for (size_t i = 0; i < activeCount; ++i) {
+			mActiveObjects[i]->OnTick(deltaTime);
+			if (const auto& object = mActiveObjects[i]; object->NeedUpdate()) {
 				mGame.SendObjectUpdate(object);
 			}
 		}
+		mAIScheduler.EndTick();
+		mLagCompensation.Record(mGame.GetTime());
 
 		if (!mMarkedObjects.empty()) {
 			auto& lua = mGame.GetLua();
+			auto& pathfinder = mGame.GetPathfinder();
 
 			mGame.SendObjectDelete(mMarkedObjects);
 			for (const auto& object : mMarkedObjects) {
-				mActiveObjects.erase(object);
-
-				auto id = object->GetId();
-				lua.RemovePrivateTable(id);
-
-				mObjects.erase(id);
-				mOpenObjectIds.push_back(id);
+				mSpatialIndex->Remove(object);
+				mTriggerSystem.Remove(object);
+				lua.RemovePrivateTable(object->GetId());
+				lua.GetScheduler().OnObjectRemoved(object->GetId());
+				pathfinder.Cancel(object->GetId());
+				mLagCompensation.Remove(object->GetId());
+				Erase(object);
+
+				// Back to the pools once the last script lets go of it.
+				object->ReleaseComponents();
 			}
 			mMarkedObjects.clear();
-
-			// Cleanup removed private tables
-			lua.CollectGarbage();
 		}
 	}
 
@@ -321,21 +356,67 @@ namespace Game {
 		}
 	}
 
+	void ObjectManager::OnObjectMoved(uint32_t id) {
+		mSpatialIndex->Move(id);
+		mTriggerSystem.Move(id);
+		mGame.OnLuaEvent(LuaEvent::Moved, id);
+	}
+
 	uint32_t ObjectManager::GetNextObjectId() {
-		static thread_local uint32_t sNextId = 1;
+		const auto index = static_cast<uint32_t>(mSlots.size());
+		if (mFreeSlots.size() > sMinFreeSlots || (index > sIndexMask && !mFreeSlots.empty())) {
+			const auto freeIndex = mFreeSlots.front();
+			mFreeSlots.pop_front();
+			return mSlots[freeIndex].id;
+		}
 
-		uint32_t id;
-		if (!mOpenObjectIds.empty()) {
-			id = mOpenObjectIds.back();
-			mOpenObjectIds.pop_back();
-		} else {
-			id = sNextId++;
+		if (index > sIndexMask) {
+			// Out of slots.
+			return 0;
 		}
 
-		if (id == 0) {
-			// Out of ids?
+		auto& slot = mSlots.emplace_back();
+		slot.id = index;
+		return slot.id;
+	}
+
+	void ObjectManager::Insert(const ObjectPtr& object) {
+		auto& slot = mSlots[GetIndex(object->GetId())];
+		slot.object = object;
+		slot.active = static_cast<uint32_t>(mActiveObjects.size());
+
+		mSpatialIndex->Enqueue(object);
+		mTriggerSystem.Add(object);
+		mActiveObjects.push_back(object);
+	}
+
+	void ObjectManager::Erase(const ObjectPtr& object) {
+		const auto index = GetIndex(object->GetId());
+
+		auto& slot = mSlots[index];
+		if (slot.object != object) {
+			return;
+		}
+
+		// Swap the last active object into the hole.
+		const auto active = slot.active;
+		if (active != mActiveObjects.size() - 1) {
+			mActiveObjects[active] = std::move(mActiveObjects.back());
+			mSlots[GetIndex(mActiveObjects[active]->GetId())].active = active;
+		}
+		mActiveObjects.pop_back();
+
+		slot.object.reset();
+		slot.active = sInvalidIndex;
+
+		// Retire the slot rather than wrap its generation, its last id keeps finding nothing.
+		const auto generation = slot.id >> sIndexBits;
+		if (generation == sGenerationMax) {
+			return;
 		}
 
-		return id;
+		// Bump the generation so the old id never finds whatever reuses this slot.
+		slot.id = index | ((generation + 1) << sIndexBits);
+		mFreeSlots.push_back(index);
 	}
 }
@@ -4,12 +4,17 @@
 
 // Include
 #include "Object.h"
-#include "Octree.h"
+#include "SpatialIndex.h"
+#include "AIScheduler.h"
+#include "LagCompensation.h"
+#include "ObjectPool.h"
+#include "TriggerSystem.h"
 #include "Lua.h"
 #include "Level.h"
 
 #include <unordered_map>
 #include <unordered_set>
+#include <deque>
 #include <set>
 #include <vector>
 
@@ -24,15 +29,12 @@ namespace Game {
 
 			void OnActivate() override;
 			void OnDeactivate() override;
-			void OnTick(float deltaTime) override;
 
 			const ObjectPtr& GetOwnerObject() const;
 
 			void Attach(const ObjectPtr& object);
 			void Detach(const ObjectPtr& object);
 
-			void AddObject(const ObjectPtr& object);
-
 			void SetOnEnterCallback(sol::protected_function callback);
 			void SetOnExitCallback(sol::protected_function callback);
 			void SetOnStayCallback(sol::protected_function callback);
@@ -43,27 +45,40 @@ namespace Game {
 			void OnStay(ObjectPtr object) const;
 
 		private:
-			std::map<ObjectPtr, uint8_t> mObjectStates;
-
 			ObjectPtr mOwnerObject = nullptr;
 
 			sol::environment mEnvironment;
 			sol::protected_function mOnEnter;
 			sol::protected_function mOnExit;
 			sol::protected_function mOnStay;
+
+			friend class TriggerSystem;
 	};
 
 	using TriggerVolumePtr = std::shared_ptr<TriggerVolume>;
 
 	// ObjectManager
 	class ObjectManager {
+		// Object ids are the slot index in the low bits and the slot generation in the high bits, slot 0 is never used so 0 stays invalid.
+		static constexpr uint32_t sIndexBits = 20;
+		static constexpr uint32_t sIndexMask = (1u << sIndexBits) - 1;
+		static constexpr uint32_t sGenerationMax = ~0u >> sIndexBits;
+
+		// Freed slots wait for this many others before they are reused, so a stale id has to outlive that much churn to alias.
+		static constexpr size_t sMinFreeSlots = 1024;
+		static constexpr uint32_t sInvalidIndex = ~0u;
+
 		public:
+			static constexpr uint32_t GetIndex(uint32_t id) { return id & sIndexMask; }
+
 			ObjectManager(Instance& game);
+			ObjectManager(Instance& game, SpatialIndexType spatialIndexType);
+			~ObjectManager();
 
 			Instance& GetGame();
 			const Instance& GetGame() const;
 
-			const std::unordered_set<ObjectPtr>& GetActiveObjects() const;
+			const std::vector<ObjectPtr>& GetActiveObjects() const;
 
 			ObjectPtr Get(uint32_t id) const;
 			ObjectPtr Create(uint32_t noun);
@@ -72,27 +87,69 @@ namespace Game {
 			TriggerVolumePtr GetTrigger(uint32_t id) const;
 			TriggerVolumePtr CreateTrigger(const glm::vec3& position, float radius);
 
-			std::vector<ObjectPtr> GetObjectsInRegion(const BoundingBox& region, const std::vector<NounType>& types) const;
-			std::vector<ObjectPtr> GetObjectsInRadius(const BoundingSphere& region, const std::vector<NounType>& types) const;
+			SpatialIndex& GetSpatialIndex();
+			const SpatialIndex& GetSpatialIndex() const;
+
+			AIScheduler& GetAIScheduler();
+			const AIScheduler& GetAIScheduler() const;
+
+			TriggerSystem& GetTriggerSystem();
+			const TriggerSystem& GetTriggerSystem() const;
+
+			LagCompensation& GetLagCompensation();
+			const LagCompensation& GetLagCompensation() const;
+
+			ObjectPools& GetPools();
+			const ObjectPools& GetPools() const;
+
+			void VisitObjectsInRegion(const BoundingBox& region, NounTypeMask types, ObjectVisitor visitor) const;
+			void VisitObjectsInRadius(const BoundingSphere& region, NounTypeMask types, ObjectVisitor visitor) const;
+
+			void GetObjectsInRegion(std::vector<Object*>& objects, const BoundingBox& region, NounTypeMask types) const;
+			void GetObjectsInRadius(std::vector<Object*>& objects, const BoundingSphere& region, NounTypeMask types) const;
+			void GetNearestObjects(std::vector<Object*>& objects, const BoundingSphere& region, size_t count, NounTypeMask types) const;
 
 			bool IsInLineOfSight(const ObjectPtr& object, const ObjectPtr& target, const glm::vec3& targetPosition) const;
 
 			void Update(float deltaTime);
 
 		private:
+			struct Slot {
+				ObjectPtr object;
+				uint32_t id = 0;
+				uint32_t active = sInvalidIndex;
+			};
+
 			void MarkForDeletion(const ObjectPtr& object);
+			void OnObjectMoved(uint32_t id);
 			uint32_t GetNextObjectId();
 
+			void Insert(const ObjectPtr& object);
+			void Erase(const ObjectPtr& object);
+
 		private:
 			Instance& mGame;
 
-			std::unique_ptr<OctTree> mOctTree;
+			// Shared with every object's control block, so objects that outlive the manager can still be freed.
+			std::shared_ptr<ObjectPools> mPools;
+
+			std::unique_ptr<SpatialIndex> mSpatialIndex;
+
+			AIScheduler mAIScheduler;
+
+			TriggerSystem mTriggerSystem;
+			LagCompensation mLagCompensation;
+
+			// index -> slot, ids are only valid while they match the slot's id.
+			std::vector<Slot> mSlots;
+
+			// Oldest first, a slot whose generation ran out never comes back.
+			std::deque<uint32_t> mFreeSlots;
 
-			std::unordered_map<uint32_t, ObjectPtr> mObjects;
-			std::unordered_set<ObjectPtr> mActiveObjects;
+			// Packed, an object knows its place through its slot.
+			std::vector<ObjectPtr> mActiveObjects;
 
 			std::vector<ObjectPtr> mMarkedObjects;
-			std::vector<uint32_t> mOpenObjectIds;
 
 			friend class Object;
 	};
@@ -0,0 +1,142 @@
+
+// Include
+#include "ObjectPool.h"
+
+#include <algorithm>
+#include <new>
+
+/*
+	Projectiles, loot orbs and summons come and go all match long, and each one used to be an object, a control
+	block and a handful of components, every one of them its own heap allocation. Objects and components now
+	come out of per-type pools owned by the object manager. Blocks are carved from 16 KB chunks and go back on a
+	free list when released, chunks are only handed back to the heap with the instance, so a long-running server
+	stops fragmenting around short-lived spawns.
+
+	Every block carries a pointer to its pool in front of it. That is what lets a plain std::unique_ptr or
+	shared_ptr control block give memory back without knowing where it came from, and what lets anything made
+	with a plain new (a null pool) live next to pooled objects. Over-aligned types (Attributes keeps its values
+	on cache lines) get blocks on their alignment, with the header padded in front so it still ends at the block. Pools are only touched from the instance thread,
+	the server is stopped before the instance lets go of its objects.
+*/
+
+// Game
+namespace Game {
+	// BlockPool
+	BlockPool::BlockPool(std::string_view name, size_t size, size_t alignment) {
+		// Room for the free list link once released.
+		mBlockSize = std::max(size, sizeof(void*));
+		mAlignment = std::max(alignment, alignof(std::max_align_t));
+		mHeaderSpace = GetHeaderSpace(mAlignment);
+		mStride = mHeaderSpace + (mBlockSize + mAlignment - 1) / mAlignment * mAlignment;
+
+		mStats.name = name;
+		mStats.blockSize = static_cast<uint32_t>(mBlockSize);
+	}
+
+	BlockPool::~BlockPool() = default;
+
+	size_t BlockPool::GetBlockSize() const {
+		return mBlockSize;
+	}
+
+	void* BlockPool::Allocate(size_t size, size_t alignment) {
+		if (size > mBlockSize || alignment > mAlignment) {
+			return AllocateUnpooled(size, std::max(alignment, mAlignment));
+		}
+
+		void* data;
+		if (mFree) {
+			data = mFree;
+			mFree = *static_cast<void**>(data);
+			mStats.recycled++;
+		} else {
+			if (mNext == mEnd) {
+				Grow();
+			}
+
+			data = mNext + mHeaderSpace;
+			mNext += mStride;
+
+			auto header = static_cast<Header*>(data) - 1;
+			header->pool = this;
+			header->alignment = static_cast<uint32_t>(mAlignment);
+		}
+
+		mStats.allocations++;
+		mStats.live++;
+		mStats.peak = std::max(mStats.peak, mStats.live);
+		return data;
+	}
+
+	void* BlockPool::AllocateUnpooled(size_t size, size_t alignment) {
+		alignment = std::max(alignment, alignof(std::max_align_t));
+
+		const auto headerSpace = GetHeaderSpace(alignment);
+		void* block;
+		if (alignment > alignof(std::max_align_t)) {
+			block = ::operator new(headerSpace + size, std::align_val_t(alignment));
+		} else {
+			block = ::operator new(headerSpace + size);
+		}
+
+		auto data = static_cast<std::byte*>(block) + headerSpace;
+		auto header = reinterpret_cast<Header*>(data) - 1;
+		header->pool = nullptr;
+		header->alignment = static_cast<uint32_t>(alignment);
+		return data;
+	}
+
+	void BlockPool::Release(void* data) {
+		if (!data) {
+			return;
+		}
+
+		auto header = static_cast<Header*>(data) - 1;
+		if (auto pool = header->pool) {
+			*static_cast<void**>(data) = pool->mFree;
+			pool->mFree = data;
+			pool->mStats.live--;
+		} else {
+			const size_t alignment = header->alignment;
+			const auto block = static_cast<std::byte*>(data) - GetHeaderSpace(alignment);
+			if (alignment > alignof(std::max_align_t)) {
+				::operator delete(block, std::align_val_t(alignment));
+			} else {
+				::operator delete(block);
+			}
+		}
+	}
+
+	const PoolStats& BlockPool::GetStats() const {
+		return mStats;
+	}
+
+	size_t BlockPool::GetHeaderSpace(size_t alignment) {
+		return (sizeof(Header) + alignment - 1) / alignment * alignment;
+	}
+
+	void BlockPool::Grow() {
+		const auto count = std::max(sChunkSize / mStride, sMinChunkBlocks);
+
+		// new[] of std::byte is aligned for any fundamental type, over-aligned pools skip ahead to their alignment.
+		// Strides are a multiple of the alignment, so every block after the first stays aligned.
+		const auto padding = mAlignment - alignof(std::max_align_t);
+		const auto& chunk = mChunks.emplace_back(new std::byte[count * mStride + padding]);
+
+		const auto address = reinterpret_cast<uintptr_t>(chunk.get());
+		mNext = chunk.get() + ((mAlignment - address % mAlignment) % mAlignment);
+		mEnd = mNext + count * mStride;
+
+		mStats.capacity += static_cast<uint32_t>(count);
+	}
+
+	// ObjectPools
+	void ObjectPools::GetStats(std::vector<PoolStats>& stats) const {
+		stats.clear();
+		for (const auto& pool : mPools) {
+			if (pool) {
+				stats.push_back(pool->GetStats());
+			}
+		}
+	}
+}
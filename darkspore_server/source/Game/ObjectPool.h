@@ -0,0 +1,165 @@
+
+#ifndef _GAME_OBJECT_POOL_HEADER
+#define _GAME_OBJECT_POOL_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <vector>
+
+// Game
+namespace Game {
+	// PoolStats
+	struct PoolStats {
+		std::string_view name;
+		uint32_t blockSize = 0;
+		uint32_t capacity = 0;
+		uint32_t live = 0;
+		uint32_t peak = 0;
+		uint64_t allocations = 0;
+		uint64_t recycled = 0;
+	};
+
+	// BlockPool
+	class BlockPool {
+		// Every block starts with the pool it came from, so a block can be handed back without knowing its type.
+		struct alignas(std::max_align_t) Header {
+			BlockPool* pool;
+
+			// Of the block, a heap fallback has to be freed with it.
+			uint32_t alignment;
+		};
+
+		static constexpr size_t sChunkSize = 16 * 1024;
+		static constexpr size_t sMinChunkBlocks = 8;
+
+		public:
+			BlockPool(std::string_view name, size_t size, size_t alignment = alignof(std::max_align_t));
+			~BlockPool();
+
+			BlockPool(const BlockPool&) = delete;
+			BlockPool& operator=(const BlockPool&) = delete;
+
+			size_t GetBlockSize() const;
+
+			// Falls back to the heap for anything bigger or more aligned than the blocks, such as a derived type.
+			void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+			// Returns any block from any pool, or from the heap fallback.
+			static void* AllocateUnpooled(size_t size, size_t alignment = alignof(std::max_align_t));
+			static void Release(void* data);
+
+			const PoolStats& GetStats() const;
+
+		private:
+			// Bytes in front of a block, the header ends right where the block starts.
+			static size_t GetHeaderSpace(size_t alignment);
+
+			void Grow();
+
+		private:
+			std::vector<std::unique_ptr<std::byte[]>> mChunks;
+
+			// Released blocks, then whatever the newest chunk has not handed out yet.
+			void* mFree = nullptr;
+			std::byte* mNext = nullptr;
+			std::byte* mEnd = nullptr;
+
+			size_t mBlockSize;
+			size_t mAlignment;
+			size_t mHeaderSpace;
+			size_t mStride;
+
+			PoolStats mStats;
+	};
+
+	// Pooled
+	class Pooled {
+		public:
+			// new (pool) T(...), and plain new T(...) still works for anything made outside an instance.
+			static void* operator new(size_t size, BlockPool& pool) { return pool.Allocate(size); }
+			static void* operator new(size_t size) { return BlockPool::AllocateUnpooled(size); }
+
+			// Picked by the compiler for types aligned past std::max_align_t, such as Attributes.
+			static void* operator new(size_t size, std::align_val_t alignment, BlockPool& pool) { return pool.Allocate(size, static_cast<size_t>(alignment)); }
+			static void* operator new(size_t size, std::align_val_t alignment) { return BlockPool::AllocateUnpooled(size, static_cast<size_t>(alignment)); }
+
+			static void operator delete(void* data, BlockPool&) { BlockPool::Release(data); }
+			static void operator delete(void* data) { BlockPool::Release(data); }
+			static void operator delete(void* data, std::align_val_t, BlockPool&) { BlockPool::Release(data); }
+			static void operator delete(void* data, std::align_val_t) { BlockPool::Release(data); }
+	};
+
+	// ObjectPools
+	class ObjectPools {
+		public:
+			// Pools by type, names only show up in the stats.
+			template<typename T>
+			BlockPool& Get(std::string_view name = {}) {
+				static const size_t index = sTypeCount++;
+				if (index >= mPools.size()) {
+					mPools.resize(index + 1);
+				}
+
+				auto& pool = mPools[index];
+				if (!pool) {
+					pool = std::make_unique<BlockPool>(name, sizeof(T), alignof(T));
+				}
+				return *pool;
+			}
+
+			template<typename T, typename... Args>
+			std::unique_ptr<T> MakeUnique(Args&&... args) {
+				return std::unique_ptr<T>(new (Get<T>()) T(std::forward<Args>(args)...));
+			}
+
+			void GetStats(std::vector<PoolStats>& stats) const;
+
+		private:
+			static inline std::atomic<size_t> sTypeCount = 0;
+
+			std::vector<std::unique_ptr<BlockPool>> mPools;
+	};
+
+	// PoolAllocator
+	template<typename T>
+	class PoolAllocator {
+		public:
+			using value_type = T;
+
+			// Holds on to the pools, whatever it allocated keeps them alive.
+			PoolAllocator(std::shared_ptr<ObjectPools> pools, std::string_view name) : mPools(std::move(pools)), mName(name) {}
+
+			template<typename U>
+			PoolAllocator(const PoolAllocator<U>& other) : mPools(other.mPools), mName(other.mName) {}
+
+			T* allocate(size_t count) {
+				if (count != 1) {
+					return static_cast<T*>(BlockPool::AllocateUnpooled(count * sizeof(T), alignof(T)));
+				}
+				return static_cast<T*>(mPools->Get<T>(mName).Allocate(sizeof(T), alignof(T)));
+			}
+
+			void deallocate(T* data, size_t) {
+				BlockPool::Release(data);
+			}
+
+			template<typename U>
+			bool operator==(const PoolAllocator<U>& other) const { return mPools == other.mPools; }
+
+		private:
+			std::shared_ptr<ObjectPools> mPools;
+			std::string_view mName;
+
+			template<typename U>
+			friend class PoolAllocator;
+	};
+}
+
+#endif
@@ -13,6 +13,12 @@ namespace Game {
 	OctTree::OctTree() : mRegion(glm::vec3(-2500), glm::vec3(2500)) {}
 	OctTree::OctTree(const BoundingBox& boundingBox) : mRegion(boundingBox) {}
 
+	OctTree::~OctTree() {
+		for (auto childNode : mChildNode) {
+			delete childNode;
+		}
+	}
+
 	void OctTree::Update() {
 		if (!mReady) {
 			if (!mBuilt) {
@@ -123,15 +129,6 @@ namespace Game {
 			mObjects.erase(std::find(mObjects.begin(), mObjects.end(), movedObject));
 			current->Insert(movedObject);
 		}
-
-		if (!mParentNode) {
-			std::vector<std::tuple<TriggerVolumePtr, ObjectPtr>> collisions;
-			GetTriggerInteractions(collisions, {});
-
-			for (const auto& [trigger, object] : collisions) {
-				trigger->AddObject(object);
-			}
-		}
 	}
 
 	void OctTree::BuildTree() {
@@ -296,162 +293,35 @@ namespace Game {
 		return false;
 	}
 
-	std::vector<ObjectPtr> OctTree::GetObjectsInRegion(const BoundingBox& region, const std::vector<NounType>& types) const {
-		std::vector<ObjectPtr> objects;
-		GetObjectsInRegion(objects, region, types);
-		return objects;
+	void OctTree::VisitObjectsInRegion(const BoundingBox& region, NounTypeMask types, ObjectVisitor visitor) const {
+		VisitObjects(region, types, visitor);
 	}
 
-	std::vector<ObjectPtr> OctTree::GetObjectsInRadius(const BoundingSphere& region, const std::vector<NounType>& types) const {
-		std::vector<ObjectPtr> objects;
-		GetObjectsInRadius(objects, region, types);
-		return objects;
+	void OctTree::VisitObjectsInRadius(const BoundingSphere& region, NounTypeMask types, ObjectVisitor visitor) const {
+		VisitObjects(region, types, visitor);
 	}
 
-	void OctTree::GetObjectsInRegion(std::vector<ObjectPtr>& objects, const BoundingBox& region, const std::vector<NounType>& types) const {
+	template<typename Region>
+	bool OctTree::VisitObjects(const Region& region, NounTypeMask types, const ObjectVisitor& visitor) const {
 		if (!mBuilt) {
-			return;
-		}
-
-		for (const auto& object : mObjects) {
-			if (types.empty()) {
-				if (region.Intersects(object->GetBoundingBox())) {
-					objects.push_back(object);
-				}
-			} else {
-				auto type = object->GetType();
-				for (auto acceptedType : types) {
-					if (type == acceptedType) {
-						if (region.Intersects(object->GetBoundingBox())) {
-							objects.push_back(object);
-						}
-						break;
-					}
-				}
-			}
-		}
-
-		if (mActiveNodes) {
-			for (const auto& childNode : mChildNode) {
-				if (childNode && region.Intersects(childNode->mRegion)) {
-					childNode->GetObjectsInRegion(objects, region, types);
-				}
-			}
-		}
-	}
-
-	void OctTree::GetObjectsInRadius(std::vector<ObjectPtr>& objects, const BoundingSphere& region, const std::vector<NounType>& types) const {
-		if (!mBuilt) {
-			return;
+			return true;
 		}
 
 		for (const auto& object : mObjects) {
-			if (types.empty()) {
-				if (region.Intersects(object->GetBoundingBox())) {
-					objects.push_back(object);
-				}
-			} else {
-				auto type = object->GetType();
-				for (auto acceptedType : types) {
-					if (type == acceptedType) {
-						if (region.Intersects(object->GetBoundingBox())) {
-							objects.push_back(object);
-						}
-						break;
-					}
-				}
+			if (types.Accepts(object->GetType()) && region.Intersects(object->GetBoundingBox()) && !visitor(object)) {
+				return false;
 			}
 		}
 
 		if (mActiveNodes) {
 			for (const auto& childNode : mChildNode) {
-				if (childNode && region.Intersects(childNode->mRegion)) {
-					childNode->GetObjectsInRadius(objects, region, types);
-				}
-			}
-		}
-	}
-
-	void OctTree::GetTriggerInteractions(std::vector<std::tuple<TriggerVolumePtr, ObjectPtr>>& collisions, std::vector<TriggerVolumePtr> parentTriggers) const {
-		// TODO: just store triggers in a seperate vector as to not fetch them each time?
-		if (!mObjects.empty()) {
-			decltype(parentTriggers) localTriggers;
-			if (parentTriggers.empty()) {
-				for (const auto& object : mObjects) {
-					if (object->IsTrigger() && !object->GetBoundingBox().IsPoint()) {
-						localTriggers.push_back(std::static_pointer_cast<TriggerVolume>(object));
-					}
-				}
-			} else {
-				for (const auto& trigger : parentTriggers) {
-					const auto& triggerBox = trigger->GetBoundingBox();
-					for (const auto& object : mObjects) {
-						const auto& objectBox = object->GetBoundingBox();
-						if (object->IsTrigger()) {
-							if (!objectBox.IsPoint()) {
-								localTriggers.push_back(std::static_pointer_cast<TriggerVolume>(object));
-							}
-							continue;
-						}
-
-						if (object != trigger->GetOwnerObject() && triggerBox.Intersects(objectBox)) {
-							collisions.push_back(std::make_tuple(trigger, object));
-						}
-					}
-				}
-			}
-
-			if (!localTriggers.empty()) {
-#if 1
-				auto node = this;
-				while (node) {
-					if (!node->mParentNode) {
-						break;
-					}
-					node = node->mParentNode;
+				if (childNode && region.Intersects(childNode->mRegion) && !childNode->VisitObjects(region, types, visitor)) {
+					return false;
 				}
-
-				for (const auto& trigger : localTriggers) {
-					std::vector<ObjectPtr> foundObjects;
-					node->GetObjectsInRegion(foundObjects, trigger->GetBoundingBox(), {});
-
-					for (const auto& object : foundObjects) {
-						if (object->IsTrigger() || object == trigger->GetOwnerObject()) {
-							continue;
-						}
-						collisions.push_back(std::make_tuple(trigger, object));
-					}
 			}
-#else
-				auto current = this;
-				while (current) {
-					for (const auto& trigger : localTriggers) {
-						const auto& triggerBox = trigger->GetBoundingBox();
-						for (const auto& object : current->mObjects) {
-							if (object->IsTrigger()) {
-								continue;
-							}
-
-							if (object != trigger->GetOwnerObject() && triggerBox.Intersects(object->GetBoundingBox())) {
-								collisions.push_back(std::make_tuple(trigger, object));
-							}
-						}
-					}
-					current = current->mParentNode;
-				}
-#endif
-			}
-
-			parentTriggers.insert(parentTriggers.end(), localTriggers.begin(), localTriggers.end());
 		}
 
-		if (mActiveNodes) {
-			for (const auto& childNode : mChildNode) {
-				if (childNode) {
-					childNode->GetTriggerInteractions(collisions, parentTriggers);
-				}
-			}
-		}
+		return true;
 	}
 
 	OctTree* OctTree::CreateNode(const BoundingBox& region, const std::vector<ObjectPtr>& objectList) {
@@ -3,32 +3,35 @@
 #define _GAME_OCTREE_HEADER
 
 // Include
-#include "Core/Base/Predefined.h"
-#include "Noun.h"
+#include "SpatialIndex.h"
 
 // Game
 namespace Game {
 	// OctTree
-	class OctTree {
+	class OctTree : public SpatialIndex {
 		static constexpr float sSmallestExtent = 1;
 
 		public:
 			OctTree();
 			OctTree(const BoundingBox& boundingBox);
+			~OctTree() override;
 
-			void Update();
+			void Update() override;
 			void BuildTree();
 
-			void Enqueue(const ObjectPtr& object);
+			void Enqueue(const ObjectPtr& object) override;
 			bool Insert(const ObjectPtr& object);
 
-			std::vector<ObjectPtr> GetObjectsInRegion(const BoundingBox& region, const std::vector<NounType>& types) const;
-			std::vector<ObjectPtr> GetObjectsInRadius(const BoundingSphere& region, const std::vector<NounType>& types) const;
+			// Moved and deleted objects are picked up by scanning the dirty and deletion flags in Update.
+			void Move(uint32_t id) override {}
+			void Remove(const ObjectPtr& object) override {}
+
+			void VisitObjectsInRegion(const BoundingBox& region, NounTypeMask types, ObjectVisitor visitor) const override;
+			void VisitObjectsInRadius(const BoundingSphere& region, NounTypeMask types, ObjectVisitor visitor) const override;
 
 		protected:
-			void GetObjectsInRegion(std::vector<ObjectPtr>& objects, const BoundingBox& region, const std::vector<NounType>& types) const;
-			void GetObjectsInRadius(std::vector<ObjectPtr>& objects, const BoundingSphere& region, const std::vector<NounType>& types) const;
-			void GetTriggerInteractions(std::vector<std::tuple<TriggerVolumePtr, ObjectPtr>>& collisions, std::vector<TriggerVolumePtr> parentTriggers) const;
+			template<typename Region>
+			bool VisitObjects(const Region& region, NounTypeMask types, const ObjectVisitor& visitor) const;
 
 			OctTree* CreateNode(const BoundingBox& region, const std::vector<ObjectPtr>& objectList);
 			OctTree* CreateNode(const BoundingBox& region, const ObjectPtr& object);
@@ -0,0 +1,149 @@
+
+// Include
+#include "SpatialIndex.h"
+#include "Octree.h"
+#include "LooseGrid.h"
+#include "ObjectManager.h"
+#include "GameManager.h"
+#include "Config.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <random>
+#include <utility>
+
+#include <glm/gtx/norm.hpp>
+
+// Game
+namespace Game {
+	// SpatialIndex
+	std::unique_ptr<SpatialIndex> SpatialIndex::Create(SpatialIndexType type) {
+		switch (type) {
+			case SpatialIndexType::OctTree:
+				return std::make_unique<OctTree>();
+
+			case SpatialIndexType::LooseGrid:
+			default:
+				return std::make_unique<LooseGrid>();
+		}
+	}
+
+	SpatialIndexType SpatialIndex::GetConfiguredType() {
+		const auto& value = Config::Get(ConfigKey::CONFIG_GAME_SPATIAL_INDEX);
+		if (value == "octree") {
+			return SpatialIndexType::OctTree;
+		} else if (value != "grid") {
+			std::cout << std::format("Game::SpatialIndex: Unknown index '{}', using 'grid'", value) << std::endl;
+		}
+		return SpatialIndexType::LooseGrid;
+	}
+
+	std::string_view SpatialIndex::GetName(SpatialIndexType type) {
+		switch (type) {
+			case SpatialIndexType::OctTree: return "octree";
+			case SpatialIndexType::LooseGrid: return "grid";
+			default: return "unknown";
+		}
+	}
+
+	void SpatialIndex::Benchmark() {
+		using Clock = std::chrono::steady_clock;
+
+		constexpr std::array<uint32_t, 5> objectCounts { 100, 500, 1000, 2500, 5000 };
+		constexpr std::array<float, 3> queryRadii { 10.f, 30.f, 100.f };
+		constexpr std::array<SpatialIndexType, 2> types { SpatialIndexType::OctTree, SpatialIndexType::LooseGrid };
+		constexpr uint32_t queryCount = 1000;
+
+		const auto elapsed = [](Clock::time_point start) {
+			return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+		};
+
+		std::cout << "Spatial index benchmark (times in microseconds, queries are per 1000)" << std::endl;
+		std::cout << std::format("{:>8} {:>8} {:>10} {:>10} {:>10} {:>10} {:>10}", "index", "objects", "build", "move 10%", "r=10", "r=30", "r=100") << std::endl;
+
+		for (auto objectCount : objectCounts) {
+			for (auto type : types) {
+				// Same layout for every index.
+				std::mt19937 random(objectCount);
+				std::uniform_real_distribution<float> coordinate(-500.f, 500.f);
+
+				auto game = GameManager::CreateGame();
+				auto objectManager = std::make_unique<ObjectManager>(*game, type);
+				auto& spatialIndex = objectManager->GetSpatialIndex();
+
+				std::vector<ObjectPtr> objects;
+				objects.reserve(objectCount);
+				for (uint32_t i = 0; i < objectCount; ++i) {
+					if (auto object = objectManager->Create(0)) {
+						object->SetPosition(glm::vec3(coordinate(random), coordinate(random), 0));
+						objects.push_back(std::move(object));
+					}
+				}
+
+				auto start = Clock::now();
+				spatialIndex.Update();
+				const double buildTime = elapsed(start);
+
+				start = Clock::now();
+				for (size_t i = 0; i < objects.size(); i += 10) {
+					objects[i]->SetPosition(glm::vec3(coordinate(random), coordinate(random), 0));
+				}
+				spatialIndex.Update();
+				const double moveTime = elapsed(start);
+
+				std::array<double, queryRadii.size()> queryTimes {};
+				std::vector<Object*> found;
+				for (size_t i = 0; i < queryRadii.size(); ++i) {
+					start = Clock::now();
+					for (uint32_t j = 0; j < queryCount; ++j) {
+						found.clear();
+						spatialIndex.GetObjectsInRadius(found, BoundingSphere(glm::vec3(coordinate(random), coordinate(random), 0), queryRadii[i]), {});
+					}
+					queryTimes[i] = elapsed(start);
+				}
+
+				std::cout << std::format("{:>8} {:>8} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f} {:>10.1f}",
+					GetName(type), objectCount, buildTime, moveTime, queryTimes[0], queryTimes[1], queryTimes[2]) << std::endl;
+
+				objects.clear();
+				objectManager.reset();
+				GameManager::RemoveGame(game->GetId());
+			}
+		}
+	}
+
+	void SpatialIndex::GetObjectsInRegion(std::vector<Object*>& objects, const BoundingBox& region, NounTypeMask types) const {
+		VisitObjectsInRegion(region, types, [&objects](const ObjectPtr& object) {
+			objects.push_back(object.get());
+		});
+	}
+
+	void SpatialIndex::GetObjectsInRadius(std::vector<Object*>& objects, const BoundingSphere& region, NounTypeMask types) const {
+		VisitObjectsInRadius(region, types, [&objects](const ObjectPtr& object) {
+			objects.push_back(object.get());
+		});
+	}
+
+	void SpatialIndex::GetNearestObjects(std::vector<Object*>& objects, const BoundingSphere& region, size_t count, NounTypeMask types) const {
+		static thread_local std::vector<std::pair<float, Object*>> candidates;
+
+		candidates.clear();
+		VisitObjectsInRadius(region, types, [&region](const ObjectPtr& object) {
+			candidates.emplace_back(glm::distance2(region.center, object->GetPosition()), object.get());
+		});
+
+		// Only the requested head is sorted, the rest is left in any order and dropped.
+		count = std::min(count, candidates.size());
+		std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.first < rhs.first;
+		});
+
+		for (size_t i = 0; i < count; ++i) {
+			objects.push_back(candidates[i].second);
+		}
+		candidates.clear();
+	}
+}
@@ -0,0 +1,87 @@
+
+#ifndef _GAME_SPATIAL_INDEX_HEADER
+#define _GAME_SPATIAL_INDEX_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+#include "Noun.h"
+
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Game
+namespace Game {
+	// SpatialIndexType
+	enum class SpatialIndexType {
+		OctTree,
+		LooseGrid
+	};
+
+	// ObjectVisitor
+	class ObjectVisitor {
+		public:
+			// Does not own the callable, only pass it down the call it was created for.
+			template<typename Callable> requires (!std::is_same_v<std::remove_cvref_t<Callable>, ObjectVisitor>)
+			ObjectVisitor(Callable&& callable) :
+				mCallable(const_cast<void*>(static_cast<const void*>(std::addressof(callable)))),
+				mInvoke(&Invoke<std::remove_reference_t<Callable>>) {}
+
+			// Returns false once the visitor wants no more objects.
+			bool operator()(const ObjectPtr& object) const { return mInvoke(mCallable, object); }
+
+		private:
+			template<typename Callable>
+			static bool Invoke(void* callable, const ObjectPtr& object) {
+				auto& function = *static_cast<Callable*>(callable);
+				if constexpr (std::is_void_v<std::invoke_result_t<Callable&, const ObjectPtr&>>) {
+					function(object);
+					return true;
+				} else {
+					return function(object);
+				}
+			}
+
+		private:
+			void* mCallable;
+			bool (*mInvoke)(void*, const ObjectPtr&);
+	};
+
+	// SpatialIndex
+	class SpatialIndex {
+		public:
+			virtual ~SpatialIndex() = default;
+
+			static std::unique_ptr<SpatialIndex> Create(SpatialIndexType type);
+
+			// GAME_SPATIAL_INDEX, "grid" (default) or "octree"
+			static SpatialIndexType GetConfiguredType();
+			static std::string_view GetName(SpatialIndexType type);
+
+			// Prints build, move and query timings of every index for 100 to 5000 objects.
+			static void Benchmark();
+
+			// Applies pending inserts and moves.
+			virtual void Update() = 0;
+
+			virtual void Enqueue(const ObjectPtr& object) = 0;
+
+			// The object moved or changed extents since the last update.
+			virtual void Move(uint32_t id) = 0;
+			virtual void Remove(const ObjectPtr& object) = 0;
+
+			// Calls the visitor for every object of an accepted type touching the region, without copying any handle.
+			virtual void VisitObjectsInRegion(const BoundingBox& region, NounTypeMask types, ObjectVisitor visitor) const = 0;
+			virtual void VisitObjectsInRadius(const BoundingSphere& region, NounTypeMask types, ObjectVisitor visitor) const = 0;
+
+			// Appends raw handles, they stay valid until the object manager deletes marked objects.
+			void GetObjectsInRegion(std::vector<Object*>& objects, const BoundingBox& region, NounTypeMask types) const;
+			void GetObjectsInRadius(std::vector<Object*>& objects, const BoundingSphere& region, NounTypeMask types) const;
+
+			// Up to count objects in the region, closest to its center first.
+			void GetNearestObjects(std::vector<Object*>& objects, const BoundingSphere& region, size_t count, NounTypeMask types) const;
+	};
+}
+
+#endif
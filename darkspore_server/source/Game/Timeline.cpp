@@ -0,0 +1,219 @@
+
+// Include
+#include "Timeline.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <random>
+
+/*
+	Hierarchical timing wheel keyed on game time in milliseconds. Level 0 holds everything due within the next 64
+	milliseconds in exact slots, every level above holds 64 times coarser slots that are cascaded one level down
+	when the wheel turns over into them. Scheduling is a push into a slot and advancing only visits occupied level 0
+	slots and the round boundaries in between, so a tick costs what it fires plus a few cascades no matter how many
+	cooldowns and modifiers are waiting further ahead.
+*/
+
+// Game
+namespace Game {
+	// Timeline
+	void Timeline::Benchmark() {
+		using Clock = std::chrono::steady_clock;
+
+		constexpr std::array<uint32_t, 3> objectCounts { 1000, 5000, 20000 };
+		constexpr uint32_t modifiersPerObject = 4;
+		constexpr uint32_t tickCount = 1200;
+		constexpr uint64_t tickTime = 50;
+		constexpr uint32_t period = 1000;
+
+		struct Entry {
+			uint64_t end;
+			uint64_t nextTick;
+			uint32_t period;
+		};
+
+		const auto elapsed = [](Clock::time_point start) {
+			return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+		};
+
+		std::cout << std::format("Timeline benchmark ({} modifiers per object, {} ticks of {} ms, times in microseconds per tick)",
+			modifiersPerObject, tickCount, tickTime) << std::endl;
+		std::cout << std::format("{:>8} {:>10} {:>10} {:>10} {:>10}",
+			"objects", "events", "wheel", "polling", "cascades") << std::endl;
+
+		for (auto objectCount : objectCounts) {
+			// Buffs last 2 to 30 seconds, a quarter of them tick every second, expired ones are applied again right away.
+			std::mt19937 random(1);
+			std::uniform_int_distribution<uint32_t> duration(2000, 30000);
+
+			const auto apply = [&](Entry& entry, uint64_t time, bool periodic) {
+				entry.end = time + duration(random);
+				entry.period = periodic ? period : 0;
+				entry.nextTick = periodic ? time + period : 0;
+			};
+
+			std::vector<Entry> initial(objectCount * modifiersPerObject);
+			for (size_t i = 0; i < initial.size(); ++i) {
+				apply(initial[i], 0, i % 4 == 0);
+			}
+
+			const auto randomState = random;
+
+			// Wheel
+			auto entries = initial;
+
+			Timeline timeline(0);
+			for (uint32_t i = 0; i < entries.size(); ++i) {
+				const auto& entry = entries[i];
+				timeline.Schedule({ entry.end, i, 0, TimelineEventType::ModifierExpire });
+				if (entry.period) {
+					timeline.Schedule({ entry.nextTick, i, 0, TimelineEventType::ModifierTick });
+				}
+			}
+
+			std::vector<TimelineEvent> events;
+			uint64_t fired = 0;
+			uint64_t cascades = 0;
+
+			auto start = Clock::now();
+			for (uint32_t tick = 1; tick <= tickCount; ++tick) {
+				const uint64_t time = tick * tickTime;
+
+				events.clear();
+				timeline.Advance(time, events);
+				cascades += timeline.GetStats().cascaded;
+
+				for (const auto& event : events) {
+					auto& entry = entries[event.objectId];
+					if (event.type == TimelineEventType::ModifierExpire && entry.end == event.time) {
+						apply(entry, time, entry.period != 0);
+						timeline.Schedule({ entry.end, event.objectId, 0, TimelineEventType::ModifierExpire });
+						if (entry.period) {
+							timeline.Schedule({ entry.nextTick, event.objectId, 0, TimelineEventType::ModifierTick });
+						}
+						++fired;
+					} else if (event.type == TimelineEventType::ModifierTick && entry.nextTick == event.time) {
+						entry.nextTick += entry.period;
+						timeline.Schedule({ entry.nextTick, event.objectId, 0, TimelineEventType::ModifierTick });
+						++fired;
+					}
+				}
+			}
+			const double wheel = elapsed(start);
+
+			// Polling every entry of every object each tick, the way expiry used to be evaluated.
+			random = randomState;
+			entries = initial;
+
+			start = Clock::now();
+			for (uint32_t tick = 1; tick <= tickCount; ++tick) {
+				const uint64_t time = tick * tickTime;
+				for (auto& entry : entries) {
+					if (entry.end <= time) {
+						apply(entry, time, entry.period != 0);
+					} else if (entry.period && entry.nextTick <= time) {
+						entry.nextTick += entry.period;
+					}
+				}
+			}
+			const double polling = elapsed(start);
+
+			std::cout << std::format("{:>8} {:>10.1f} {:>10.2f} {:>10.2f} {:>10.2f}",
+				objectCount, static_cast<double>(fired) / tickCount, wheel / tickCount, polling / tickCount,
+				static_cast<double>(cascades) / tickCount) << std::endl;
+		}
+	}
+
+	Timeline::Timeline(uint64_t time) : mTime(time) {}
+
+	void Timeline::Schedule(const TimelineEvent& event) {
+		Insert(event);
+		mStats.pending++;
+	}
+
+	void Timeline::Advance(uint64_t time, std::vector<TimelineEvent>& events) {
+		mStats.fired = 0;
+		mStats.cascaded = 0;
+
+		while (mTime <= time) {
+			if (mStats.pending == 0) {
+				// Nothing anywhere on the wheel, slot positions do not matter.
+				mTime = time + 1;
+				break;
+			}
+
+			const auto slot = static_cast<uint32_t>(mTime & sSlotMask);
+			if (slot == 0) {
+				Cascade(1);
+			}
+
+			const auto bit = 1ull << slot;
+			if (mOccupied[0] & bit) {
+				auto& bucket = mSlots[0][slot];
+				events.insert(events.end(), bucket.begin(), bucket.end());
+
+				mStats.fired += static_cast<uint32_t>(bucket.size());
+				mStats.pending -= bucket.size();
+
+				bucket.clear();
+				mOccupied[0] &= ~bit;
+			}
+
+			// Jump to the next occupied slot of this round, or to the start of the next round to cascade.
+			const auto ahead = slot == sSlotMask ? 0 : mOccupied[0] >> (slot + 1);
+			const uint64_t step = ahead ? std::countr_zero(ahead) + 1 : sSlotCount - slot;
+			mTime = std::min(mTime + step, time + 1);
+		}
+
+		mStats.totalFired += mStats.fired;
+	}
+
+	const TimelineStats& Timeline::GetStats() const {
+		return mStats;
+	}
+
+	void Timeline::Insert(const TimelineEvent& event) {
+		const auto time = std::max(event.time, mTime);
+		for (uint32_t level = 0; level < sLevelCount; ++level) {
+			const auto shift = level * sSlotBits;
+			if ((time >> shift) - (mTime >> shift) < sSlotCount) {
+				const auto slot = static_cast<uint32_t>((time >> shift) & sSlotMask);
+				mSlots[level][slot].push_back(event);
+				mOccupied[level] |= 1ull << slot;
+				return;
+			}
+		}
+
+		// Beyond the top level, parked in the last slot of its round and inserted again once that turns over.
+		constexpr auto shift = (sLevelCount - 1) * sSlotBits;
+		const auto slot = static_cast<uint32_t>(((mTime >> shift) + sSlotMask) & sSlotMask);
+		mSlots[sLevelCount - 1][slot].push_back(event);
+		mOccupied[sLevelCount - 1] |= 1ull << slot;
+	}
+
+	void Timeline::Cascade(uint32_t level) {
+		const auto slot = static_cast<uint32_t>((mTime >> (level * sSlotBits)) & sSlotMask);
+		if (slot == 0 && level + 1 < sLevelCount) {
+			Cascade(level + 1);
+		}
+
+		const auto bit = 1ull << slot;
+		if (!(mOccupied[level] & bit)) {
+			return;
+		}
+
+		// Moved out before inserting again, the events all land in other slots.
+		static thread_local std::vector<TimelineEvent> events;
+		events.clear();
+		events.swap(mSlots[level][slot]);
+		mOccupied[level] &= ~bit;
+
+		for (const auto& event : events) {
+			Insert(event);
+		}
+		mStats.cascaded += static_cast<uint32_t>(events.size());
+	}
+}
@@ -0,0 +1,80 @@
+
+#ifndef _GAME_TIMELINE_HEADER
+#define _GAME_TIMELINE_HEADER
+
+// Include
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Game
+namespace Game {
+	// TimelineEventType
+	enum class TimelineEventType : uint8_t {
+		CooldownEnd = 0,
+		ModifierExpire,
+		ModifierTick,
+
+		// Carries a lua thread slot in objectId and its wait in id.
+		LuaWake
+	};
+
+	// TimelineEvent
+	struct TimelineEvent {
+		// Objects ignore events whose time no longer matches what they have stored, there is no way to cancel one.
+		uint64_t time = 0;
+		uint32_t objectId = 0;
+		uint32_t id = 0;
+		TimelineEventType type = TimelineEventType::CooldownEnd;
+	};
+
+	// TimelineStats
+	struct TimelineStats {
+		uint64_t pending = 0;
+		uint64_t totalFired = 0;
+
+		// Last advance
+		uint32_t fired = 0;
+		uint32_t cascaded = 0;
+	};
+
+	// Timeline
+	class Timeline {
+		// Every level has 64 slots, each one spanning a whole round of the level below. Level 0 slots are one millisecond.
+		static constexpr uint32_t sSlotBits = 6;
+		static constexpr uint32_t sSlotCount = 1 << sSlotBits;
+		static constexpr uint32_t sSlotMask = sSlotCount - 1;
+
+		// Five levels reach 2^30 milliseconds (~12 days) ahead, events further away wait in the top level.
+		static constexpr uint32_t sLevelCount = 5;
+
+		public:
+			// Prints the per tick cost of the wheel against polling every object, for growing object counts.
+			static void Benchmark();
+
+			Timeline(uint64_t time);
+
+			// Events in the past fire on the next advance.
+			void Schedule(const TimelineEvent& event);
+
+			// Appends every event due at or before time, in time order.
+			void Advance(uint64_t time, std::vector<TimelineEvent>& events);
+
+			const TimelineStats& GetStats() const;
+
+		private:
+			void Insert(const TimelineEvent& event);
+			void Cascade(uint32_t level);
+
+		private:
+			std::array<std::array<std::vector<TimelineEvent>, sSlotCount>, sLevelCount> mSlots;
+			std::array<uint64_t, sLevelCount> mOccupied {};
+
+			TimelineStats mStats;
+
+			// First millisecond that has not been advanced over yet.
+			uint64_t mTime;
+	};
+}
+
+#endif
@@ -0,0 +1,360 @@
+
+// Include
+#include "TriggerSystem.h"
+#include "ObjectManager.h"
+
+#include <algorithm>
+#include <cmath>
+
+/*
+	Trigger volumes used to collect candidates from the spatial index every tick, by walking every trigger
+	against the whole index, and kept them in a map per trigger that only ever grew. Occupancy is now kept here,
+	one entry per (trigger, object) pair that is inside, and only what moved is looked at again: a moved object is
+	tested against the triggers in its cell, a moved trigger asks the spatial index for what is around it. Pairs
+	of things that did not move stay as they are.
+
+	Every pair is visited once per tick for the stay callbacks anyway, that pass also drops the pairs a moved
+	object or trigger was not seen in again. The callbacks of the tick are sorted by trigger and object before
+	any of them runs, so scripts see the same order whichever order objects moved in, and whatever they move or
+	create is picked up next tick.
+*/
+
+// Game
+namespace Game {
+	// TriggerSystem
+	TriggerSystem::TriggerSystem(ObjectManager& manager) : mManager(manager) {}
+
+	void TriggerSystem::Add(const ObjectPtr& object) {
+		if (object->IsTrigger()) {
+			mTriggers.push_back(std::static_pointer_cast<TriggerVolume>(object));
+			mCellsDirty = true;
+		}
+		Move(object->GetId());
+	}
+
+	void TriggerSystem::Remove(const ObjectPtr& object) {
+		if (object->IsTrigger()) {
+			// Its pairs go away quietly once the object manager no longer knows the id.
+			std::erase(mTriggers, std::static_pointer_cast<TriggerVolume>(object));
+			mCellsDirty = true;
+		} else {
+			mRemoved.push_back(object);
+		}
+	}
+
+	void TriggerSystem::Move(uint32_t id) {
+		const auto index = ObjectManager::GetIndex(id);
+		if (index >= mMovedIds.size()) {
+			mMovedIds.resize(static_cast<size_t>(index) + 1, 0);
+		}
+
+		// Slots are reused, the id decides whether this object already moved this tick.
+		if (mMovedIds[index] != id) {
+			mMovedIds[index] = id;
+			mMoved.push_back(id);
+		}
+	}
+
+	void TriggerSystem::Update() {
+		mStats.checked = 0;
+		mStats.enters = 0;
+		mStats.exits = 0;
+		mStats.stays = 0;
+
+		// Cells follow the triggers, moved ones included.
+		static thread_local std::vector<ObjectPtr> movedObjects;
+		movedObjects.clear();
+		for (auto id : mMoved) {
+			if (auto object = mManager.Get(id); object && !object->IsMarkedForDeletion()) {
+				mCellsDirty |= object->IsTrigger();
+				movedObjects.push_back(std::move(object));
+			}
+		}
+
+		if (mCellsDirty) {
+			RebuildCells();
+		}
+
+		for (const auto& object : movedObjects) {
+			if (object->IsTrigger()) {
+				CheckTrigger(static_cast<const TriggerVolume&>(*object));
+			} else {
+				CheckObject(*object);
+			}
+		}
+		mStats.checked = static_cast<uint32_t>(movedObjects.size());
+		movedObjects.clear();
+
+		std::sort(mRemoved.begin(), mRemoved.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs->GetId() < rhs->GetId();
+		});
+
+		const auto isRemoved = [this](uint32_t id) {
+			const auto it = std::lower_bound(mRemoved.begin(), mRemoved.end(), id, [](const auto& object, uint32_t value) {
+				return object->GetId() < value;
+			});
+			return it != mRemoved.end() && (*it)->GetId() == id;
+		};
+
+		static thread_local std::vector<uint64_t> stale;
+		stale.clear();
+		mEvents.clear();
+
+		for (auto& pair : mPairs) {
+			if (pair.key == 0) {
+				continue;
+			}
+
+			const auto triggerId = static_cast<uint32_t>(pair.key >> 32);
+			const auto objectId = static_cast<uint32_t>(pair.key);
+			if (!mManager.GetTrigger(triggerId)) {
+				stale.push_back(pair.key);
+				continue;
+			}
+
+			const bool moved = IsMoved(triggerId) || IsMoved(objectId);
+			if ((moved && pair.seen != mTick) || isRemoved(objectId)) {
+				mEvents.push_back({ triggerId, objectId, EventType::Exit });
+				stale.push_back(pair.key);
+			} else if (!pair.entered) {
+				pair.entered = true;
+				mEvents.push_back({ triggerId, objectId, EventType::Enter });
+			} else {
+				mEvents.push_back({ triggerId, objectId, EventType::Stay });
+			}
+		}
+
+		for (auto key : stale) {
+			ErasePair(key);
+		}
+
+		// Moves from here on, callbacks included, belong to the next tick.
+		for (auto id : mMoved) {
+			mMovedIds[ObjectManager::GetIndex(id)] = 0;
+		}
+		mMoved.clear();
+		mTick++;
+
+		std::sort(mEvents.begin(), mEvents.end(), [](const Event& lhs, const Event& rhs) {
+			if (lhs.triggerId != rhs.triggerId) {
+				return lhs.triggerId < rhs.triggerId;
+			}
+			return lhs.objectId < rhs.objectId;
+		});
+
+		TriggerVolumePtr trigger;
+		for (const auto& event : mEvents) {
+			if (!trigger || trigger->GetId() != event.triggerId) {
+				trigger = mManager.GetTrigger(event.triggerId);
+			}
+
+			const auto object = GetObject(event.objectId);
+			if (!trigger || !object) {
+				continue;
+			}
+
+			switch (event.type) {
+				case EventType::Enter:
+					trigger->OnEnter(object);
+					mStats.enters++;
+					break;
+
+				case EventType::Exit:
+					trigger->OnExit(object);
+					mStats.exits++;
+					break;
+
+				case EventType::Stay:
+					trigger->OnStay(object);
+					mStats.stays++;
+					break;
+			}
+		}
+
+		mEvents.clear();
+		mRemoved.clear();
+
+		mStats.triggers = static_cast<uint32_t>(mTriggers.size());
+		mStats.occupants = static_cast<uint32_t>(mPairCount);
+	}
+
+	const TriggerStats& TriggerSystem::GetStats() const {
+		return mStats;
+	}
+
+	size_t TriggerSystem::Hash(uint64_t key) {
+		// Fibonacci hashing, ids only differ in their low bits.
+		key *= 0x9E3779B97F4A7C15ull;
+		return static_cast<size_t>(key ^ (key >> 32));
+	}
+
+	uint64_t TriggerSystem::GetKey(uint32_t triggerId, uint32_t objectId) {
+		return (static_cast<uint64_t>(triggerId) << 32) | objectId;
+	}
+
+	uint64_t TriggerSystem::GetCellKey(int32_t x, int32_t y) {
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+	int32_t TriggerSystem::GetCellCoordinate(float value) {
+		return static_cast<int32_t>(std::floor(value / sCellSize));
+	}
+
+	bool TriggerSystem::IsMoved(uint32_t id) const {
+		const auto index = ObjectManager::GetIndex(id);
+		return index < mMovedIds.size() && mMovedIds[index] == id;
+	}
+
+	void TriggerSystem::RebuildCells() {
+		mCells.clear();
+		for (uint32_t i = 0; i < mTriggers.size(); ++i) {
+			const auto& boundingBox = mTriggers[i]->GetBoundingBox();
+			if (boundingBox.IsPoint()) {
+				continue;
+			}
+
+			const auto minX = GetCellCoordinate(boundingBox.center.x - boundingBox.extent.x);
+			const auto maxX = GetCellCoordinate(boundingBox.center.x + boundingBox.extent.x);
+			const auto minY = GetCellCoordinate(boundingBox.center.y - boundingBox.extent.y);
+			const auto maxY = GetCellCoordinate(boundingBox.center.y + boundingBox.extent.y);
+			for (auto x = minX; x <= maxX; ++x) {
+				for (auto y = minY; y <= maxY; ++y) {
+					mCells.emplace_back(GetCellKey(x, y), i);
+				}
+			}
+		}
+
+		std::sort(mCells.begin(), mCells.end());
+		mCellsDirty = false;
+	}
+
+	void TriggerSystem::CheckObject(const Object& object) {
+		const auto& position = object.GetPosition();
+		const auto cell = GetCellKey(GetCellCoordinate(position.x), GetCellCoordinate(position.y));
+
+		auto it = std::lower_bound(mCells.begin(), mCells.end(), cell, [](const auto& entry, uint64_t value) {
+			return entry.first < value;
+		});
+
+		for (; it != mCells.end() && it->first == cell; ++it) {
+			const auto& trigger = *mTriggers[it->second];
+			if (trigger.GetOwnerObject().get() == &object) {
+				continue;
+			}
+
+			if (glm::distance(position, trigger.GetPosition()) <= trigger.GetBoundingBox().extent.x) {
+				See(trigger.GetId(), object.GetId());
+			}
+		}
+	}
+
+	void TriggerSystem::CheckTrigger(const TriggerVolume& trigger) {
+		const auto& boundingBox = trigger.GetBoundingBox();
+		if (boundingBox.IsPoint()) {
+			return;
+		}
+
+		const auto& center = trigger.GetPosition();
+		const auto radius = boundingBox.extent.x;
+		const auto& owner = trigger.GetOwnerObject();
+		mManager.VisitObjectsInRadius(BoundingSphere(center, radius), {}, [&](const ObjectPtr& object) {
+			if (object->IsTrigger() || object == owner || object->IsMarkedForDeletion()) {
+				return;
+			}
+
+			if (glm::distance(object->GetPosition(), center) <= radius) {
+				See(trigger.GetId(), object->GetId());
+			}
+		});
+	}
+
+	void TriggerSystem::See(uint32_t triggerId, uint32_t objectId) {
+		InsertPair(GetKey(triggerId, objectId)).seen = mTick;
+	}
+
+	size_t TriggerSystem::FindPair(uint64_t key) const {
+		if (mPairs.empty()) {
+			return mPairs.size();
+		}
+
+		const auto mask = mPairs.size() - 1;
+		for (auto i = Hash(key) & mask;; i = (i + 1) & mask) {
+			if (mPairs[i].key == key) {
+				return i;
+			} else if (mPairs[i].key == 0) {
+				return mPairs.size();
+			}
+		}
+	}
+
+	TriggerSystem::Pair& TriggerSystem::InsertPair(uint64_t key) {
+		// Kept at most half full.
+		if ((mPairCount + 1) * 2 > mPairs.size()) {
+			Rehash(std::max<size_t>(mPairs.size() * 2, 64));
+		}
+
+		const auto mask = mPairs.size() - 1;
+		auto i = Hash(key) & mask;
+		while (mPairs[i].key != 0 && mPairs[i].key != key) {
+			i = (i + 1) & mask;
+		}
+
+		auto& pair = mPairs[i];
+		if (pair.key == 0) {
+			pair.key = key;
+			mPairCount++;
+		}
+		return pair;
+	}
+
+	void TriggerSystem::ErasePair(uint64_t key) {
+		auto hole = FindPair(key);
+		if (hole == mPairs.size()) {
+			return;
+		}
+
+		// Shift the rest of the run back instead of leaving a tombstone.
+		const auto mask = mPairs.size() - 1;
+		for (auto i = (hole + 1) & mask; mPairs[i].key != 0; i = (i + 1) & mask) {
+			const auto home = Hash(mPairs[i].key) & mask;
+			if (((i - home) & mask) >= ((i - hole) & mask)) {
+				mPairs[hole] = mPairs[i];
+				hole = i;
+			}
+		}
+
+		mPairs[hole] = Pair {};
+		mPairCount--;
+	}
+
+	void TriggerSystem::Rehash(size_t capacity) {
+		auto pairs = std::move(mPairs);
+		mPairs.assign(capacity, Pair {});
+
+		const auto mask = capacity - 1;
+		for (const auto& pair : pairs) {
+			if (pair.key != 0) {
+				auto i = Hash(pair.key) & mask;
+				while (mPairs[i].key != 0) {
+					i = (i + 1) & mask;
+				}
+				mPairs[i] = pair;
+			}
+		}
+	}
+
+	ObjectPtr TriggerSystem::GetObject(uint32_t id) const {
+		if (auto object = mManager.Get(id)) {
+			return object;
+		}
+
+		const auto it = std::lower_bound(mRemoved.begin(), mRemoved.end(), id, [](const auto& object, uint32_t value) {
+			return object->GetId() < value;
+		});
+
+		if (it != mRemoved.end() && (*it)->GetId() == id) {
+			return *it;
+		}
+		return nullptr;
+	}
+}
@@ -0,0 +1,122 @@
+
+#ifndef _GAME_TRIGGER_SYSTEM_HEADER
+#define _GAME_TRIGGER_SYSTEM_HEADER
+
+// Include
+#include "Core/Base/Predefined.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Game
+namespace Game {
+	class Object;
+	class ObjectManager;
+	class TriggerVolume;
+
+	using ObjectPtr = std::shared_ptr<Object>;
+	using TriggerVolumePtr = std::shared_ptr<TriggerVolume>;
+
+	// TriggerStats
+	struct TriggerStats {
+		uint32_t triggers = 0;
+		uint32_t occupants = 0;
+
+		// Last tick
+		uint32_t checked = 0;
+		uint32_t enters = 0;
+		uint32_t exits = 0;
+		uint32_t stays = 0;
+	};
+
+	// TriggerSystem
+	class TriggerSystem {
+		// Trigger cells on the x/y plane, only used to find the triggers around a moved object.
+		static constexpr float sCellSize = 32.f;
+
+		public:
+			TriggerSystem(ObjectManager& manager);
+
+			void Add(const ObjectPtr& object);
+			void Remove(const ObjectPtr& object);
+
+			// Only moved objects and moved triggers are tested again, every other occupant stays.
+			void Move(uint32_t id);
+
+			// Called after the spatial index caught up, calls the enter, exit and stay callbacks of the tick ordered by trigger.
+			void Update();
+
+			const TriggerStats& GetStats() const;
+
+		private:
+			enum class EventType : uint8_t {
+				Enter,
+				Exit,
+				Stay
+			};
+
+			struct Event {
+				uint32_t triggerId;
+				uint32_t objectId;
+				EventType type;
+			};
+
+			// Keyed by trigger id and object id, key 0 is an empty slot since id 0 is never used.
+			struct Pair {
+				uint64_t key = 0;
+				uint32_t seen = 0;
+				bool entered = false;
+			};
+
+			static size_t Hash(uint64_t key);
+			static uint64_t GetKey(uint32_t triggerId, uint32_t objectId);
+			static uint64_t GetCellKey(int32_t x, int32_t y);
+			static int32_t GetCellCoordinate(float value);
+
+			bool IsMoved(uint32_t id) const;
+
+			void RebuildCells();
+			void CheckObject(const Object& object);
+			void CheckTrigger(const TriggerVolume& trigger);
+			void See(uint32_t triggerId, uint32_t objectId);
+
+			// Open addressing with linear probing.
+			size_t FindPair(uint64_t key) const;
+			Pair& InsertPair(uint64_t key);
+			void ErasePair(uint64_t key);
+			void Rehash(size_t capacity);
+
+			ObjectPtr GetObject(uint32_t id) const;
+
+		private:
+			ObjectManager& mManager;
+
+			std::vector<TriggerVolumePtr> mTriggers;
+
+			// cell -> index into mTriggers, sorted by cell.
+			std::vector<std::pair<uint64_t, uint32_t>> mCells;
+			bool mCellsDirty = false;
+
+			std::vector<Pair> mPairs;
+			size_t mPairCount = 0;
+
+			// object slot index -> id of the object that moved there this tick, 0 if none did
+			std::vector<uint32_t> mMovedIds;
+			std::vector<uint32_t> mMoved;
+
+			// Pairs seen in this tick are still inside.
+			uint32_t mTick = 1;
+
+			// Deleted since the last update, their exits still need them.
+			std::vector<ObjectPtr> mRemoved;
+
+			std::vector<Event> mEvents;
+
+			TriggerStats mStats;
+	};
+}
+
+#endif
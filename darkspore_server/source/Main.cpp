@@ -2,15 +2,23 @@
 // Include
 #include "Main.h"
 #include "Core/Async/Scheduler.h"
+#include "Core/Async/Executor.h"
 #include "Core/Base/Version.h"
 
 #include "SporeNet/Instance.h"
 
+#include "RakNet/SendPolicy.h"
+
 #include "HTTP/URI.h"
 
 #include "Game/Config.h"
 #include "Game/Noun.h"
 #include "Game/Lua.h"
+#include "Game/LuaStatePool.h"
+#include "Game/SpatialIndex.h"
+#include "Game/Narrowphase.h"
+#include "Game/Navigation.h"
+#include "Game/Timeline.h"
 
 #include "Game/AssetData/DBPFManager.h"
 #include "Game/AssetData/AssetData.h"
@@ -39,6 +47,10 @@
 Application* Application::sApplication = nullptr;
 
 bool Application::sVerboseTimestamps = false;
+bool Application::sBenchmarkSpatial = false;
+bool Application::sBenchmarkNarrowphase = false;
+bool Application::sBenchmarkPathfinding = false;
+bool Application::sBenchmarkTimeline = false;
 
 std::string Application::darksporeInstallPath = "../..";
 std::string Application::darksporeInstallVersion = "5.3.0.127";
@@ -57,6 +69,14 @@ Application& Application::InitApp(int argc, char* argv[]) {
                 strcmp(argv[i], "-v") == 0) {
                 std::cout << RECAP_VERSION_STRING << std::endl;
                 exit(0);
+            } else if (strcmp(argv[i], "--benchmark-spatial") == 0) {
+                sBenchmarkSpatial = true;
+            } else if (strcmp(argv[i], "--benchmark-narrowphase") == 0) {
+                sBenchmarkNarrowphase = true;
+            } else if (strcmp(argv[i], "--benchmark-pathfinding") == 0) {
+                sBenchmarkPathfinding = true;
+            } else if (strcmp(argv[i], "--benchmark-timeline") == 0) {
+                sBenchmarkTimeline = true;
             } else if (strcmp(argv[i], "--darkspore-path") == 0) {
                 i++;
                 darksporeInstallPath = std::string(argv[i]);
@@ -66,6 +86,10 @@ Application& Application::InitApp(int argc, char* argv[]) {
                 std::cout << "Options:\n";
                 std::cout << "  --timestamps, -ts    Timestamp log\n";
                 std::cout << "  --version, -v        Display server version\n";
+                std::cout << "  --benchmark-spatial  Compare the spatial indexes and exit\n";
+                std::cout << "  --benchmark-narrowphase  Compare batched and scalar collision tests and exit\n";
+                std::cout << "  --benchmark-pathfinding  Time-sliced path requests for hundreds of agents and exit\n";
+                std::cout << "  --benchmark-timeline  Timing wheel against polling for modifier expiry and exit\n";
                 std::cout << "  --help, -h           Shows this help\n";
                 exit(0);
             }
@@ -109,6 +133,31 @@ bool Application::OnInit() {
 	// Scheduler
 	mScheduler = std::make_unique<Scheduler>();
 
+	// RakNet
+	RakNet::SendPolicyTable::Load(Game::Config::Get(Game::ConfigKey::CONFIG_PACKET_POLICY_PATH));
+
+	// Executor
+	mExecutor = std::make_unique<Executor>(Game::Config::GetU32(Game::ConfigKey::CONFIG_GAME_WORKER_THREADS));
+
+	if (sBenchmarkSpatial || sBenchmarkNarrowphase || sBenchmarkPathfinding || sBenchmarkTimeline) {
+		if (sBenchmarkSpatial) {
+			Game::SpatialIndex::Benchmark();
+		}
+
+		if (sBenchmarkNarrowphase) {
+			Game::Narrowphase::Benchmark();
+		}
+
+		if (sBenchmarkPathfinding) {
+			Game::Pathfinder::Benchmark();
+		}
+
+		if (sBenchmarkTimeline) {
+			Game::Timeline::Benchmark();
+		}
+		exit(0);
+	}
+
 	// SporeNet
 	mSporeNet = std::make_unique<SporeNet::Instance>();
 
@@ -194,6 +243,7 @@ bool Application::OnInit() {
 
 		// Load scripts
 		Game::GlobalLua::Instance().Initialize();
+		Game::LuaStatePool::Instance().Fill();
 	});
 	t.detach();
 
@@ -211,6 +261,8 @@ int Application::OnExit() {
 	mScheduler->Shutdown();
 	mScheduler.reset();
 
+	mExecutor->Shutdown();
+
 	DBPFManager::shutdown();
 	
 	return 0;
@@ -259,6 +311,10 @@ Scheduler& Application::GetScheduler() const {
 	return *mScheduler;
 }
 
+Executor& Application::GetExecutor() const {
+	return *mExecutor;
+}
+
 SporeNet::Instance& Application::GetSporeNet() const {
 	return *mSporeNet;
 }
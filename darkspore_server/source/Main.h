@@ -17,6 +17,10 @@ class Application {
 	private:
 		Application();
 		static bool sVerboseTimestamps;
+		static bool sBenchmarkSpatial;
+		static bool sBenchmarkNarrowphase;
+		static bool sBenchmarkPathfinding;
+		static bool sBenchmarkTimeline;
 		static std::string darksporeInstallPath;
 		static std::string darksporeInstallVersion;
 		
@@ -34,6 +38,7 @@ class Application {
 		boost::asio::io_context& get_io_service();
 
 		Scheduler& GetScheduler() const;
+		Executor& GetExecutor() const;
 
 		SporeNet::Instance& GetSporeNet() const;
 
@@ -54,6 +59,7 @@ class Application {
 		boost::asio::signal_set mSignals;
 
 		std::unique_ptr<Scheduler> mScheduler;
+		std::unique_ptr<Executor> mExecutor;
 
 		std::unique_ptr<SporeNet::Instance> mSporeNet;
 
@@ -8,6 +8,8 @@
 #include "SporeNet/User.h"
 
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 
 bool IsValidStateChange(GameState fromState, GameState toState) {
 	if (toState == GameState::Login && fromState != GameState::Login) {
@@ -78,6 +80,212 @@ std::string to_string(GameState gameState) {
 
 // RakNet
 namespace RakNet {
+	// OutgoingFrame
+	void OutgoingFrame::Append(const BitStream& stream, const SendPolicy& policy) {
+		const auto offset = static_cast<uint32_t>(mBuffer.size());
+		const auto length = static_cast<uint32_t>(stream.GetNumberOfBytesUsed());
+		if (length == 0) {
+			return;
+		}
+
+		const auto data = stream.GetData();
+
+		// Only taken as an object id when the policy says the packet starts with one.
+		uint32_t leadingId = 0;
+		if (length >= 5) {
+			std::memcpy(&leadingId, data + 1, sizeof(leadingId));
+		}
+
+		const uint32_t objectId = policy.objectId ? leadingId : 0;
+		if (data[0] == static_cast<uint8_t>(PacketID::ObjectDelete)) {
+			// Unsent state of a deleted object is useless, and if not even its create went out the client never has to hear of it.
+			mDeleted.clear();
+			for (uint32_t position = 1; position + sizeof(uint32_t) <= length; position += sizeof(uint32_t)) {
+				uint32_t deletedId;
+				std::memcpy(&deletedId, data + position, sizeof(deletedId));
+
+				for (auto& message : mMessages) {
+					if (message.length != 0 && message.objectId == deletedId) {
+						message.length = 0;
+						mSuperseded++;
+					}
+				}
+				mPriorities.erase(deletedId);
+
+				if (mCreates.erase(deletedId) == 0) {
+					mDeleted.push_back(deletedId);
+				}
+			}
+
+			if (mDeleted.empty()) {
+				mSuperseded++;
+				return;
+			}
+
+			if (mDeleted.size() != (length - 1) / sizeof(uint32_t)) {
+				const auto deleteLength = static_cast<uint32_t>(1 + mDeleted.size() * sizeof(uint32_t));
+				mBuffer.push_back(data[0]);
+				mBuffer.insert(mBuffer.end(), reinterpret_cast<const uint8_t*>(mDeleted.data()), reinterpret_cast<const uint8_t*>(mDeleted.data() + mDeleted.size()));
+				mMessages.push_back(Message { offset, deleteLength, 0, 0, policy.weight, false, false });
+				return;
+			}
+		} else if (data[0] == static_cast<uint8_t>(PacketID::ObjectCreate) && objectId != 0) {
+			// Creates are never held back, so this only lasts until the next drain.
+			mCreates.insert(objectId);
+		}
+
+		uint64_t key = 0;
+		if (policy.supersede == SupersedeMode::Packet) {
+			key = data[0];
+		} else if (policy.supersede == SupersedeMode::Object && length >= 5) {
+			key = data[0] | (static_cast<uint64_t>(leadingId) << 8);
+		}
+
+		if (key != 0) {
+			auto [it, inserted] = mLatest.try_emplace(key, static_cast<uint32_t>(mMessages.size()));
+			if (!inserted) {
+				auto& previous = mMessages[it->second];
+				if (previous.length != 0) {
+					previous.length = 0;
+					mSuperseded++;
+				}
+				it->second = static_cast<uint32_t>(mMessages.size());
+			}
+		}
+
+		// Anything RakNet does not order behind the create waits for a later drain than the create.
+		const auto& createPolicy = SendPolicyTable::Get(PacketID::ObjectCreate);
+		const bool orderedWithCreate = policy.reliability == RELIABLE_ORDERED && createPolicy.reliability == RELIABLE_ORDERED &&
+			policy.orderingChannel == createPolicy.orderingChannel;
+
+		const bool afterCreate = objectId != 0 && data[0] != static_cast<uint8_t>(PacketID::ObjectCreate) && !orderedWithCreate;
+
+		mBuffer.insert(mBuffer.end(), data, data + length);
+		mMessages.push_back(Message { offset, length, objectId, key, policy.weight, policy.deferrable && objectId != 0, afterCreate });
+	}
+
+	void OutgoingFrame::Clear() {
+		mBuffer.clear();
+		mMessages.clear();
+		mLatest.clear();
+		mCreates.clear();
+		mPriorities.clear();
+		mSuperseded = 0;
+	}
+
+	void OutgoingFrame::Accumulate(const Scorer& scorer) {
+		CollectGroups();
+		for (const auto& [objectId, group] : mGroups) {
+			mPriorities[objectId] += scorer(objectId) * group.weight;
+		}
+	}
+
+	void OutgoingFrame::Drain(int64_t& budget, bool limited, const Scorer& scorer, const Sender& sender) {
+		mSuperseded = 0;
+		if (!limited) {
+			for (auto& message : mMessages) {
+				if (message.length != 0 && !IsWaitingForCreate(message)) {
+					sender(mBuffer.data() + message.offset, message.length);
+					message.length = 0;
+				}
+			}
+			Compact();
+			return;
+		}
+
+		// Session messages and anything that cannot be deferred keep their order and never wait.
+		for (auto& message : mMessages) {
+			if (message.length != 0 && !message.deferrable && !IsWaitingForCreate(message)) {
+				sender(mBuffer.data() + message.offset, message.length);
+				budget -= message.length;
+				message.length = 0;
+			}
+		}
+
+		// Then whole objects, highest priority first, so the messages of one object stay in order.
+		CollectGroups();
+
+		mOrder.clear();
+		for (const auto& [objectId, group] : mGroups) {
+			auto [it, inserted] = mPriorities.try_emplace(objectId, 0.f);
+			if (inserted) {
+				it->second = scorer(objectId) * group.weight;
+			}
+			mOrder.emplace_back(it->second, objectId);
+		}
+
+		std::sort(mOrder.begin(), mOrder.end(), std::greater<>());
+		for (const auto& [_, objectId] : mOrder) {
+			if (budget <= 0) {
+				break;
+			}
+
+			auto& group = mGroups[objectId];
+			group.selected = true;
+			budget -= group.bytes;
+			mPriorities.erase(objectId);
+		}
+
+		for (auto& message : mMessages) {
+			if (message.length == 0 || !message.deferrable || IsWaitingForCreate(message)) {
+				continue;
+			}
+
+			if (const auto it = mGroups.find(message.objectId); it != mGroups.end() && it->second.selected) {
+				sender(mBuffer.data() + message.offset, message.length);
+				message.length = 0;
+			}
+		}
+
+		Compact();
+	}
+
+	bool OutgoingFrame::IsWaitingForCreate(const Message& message) const {
+		return message.afterCreate && mCreates.contains(message.objectId);
+	}
+
+	void OutgoingFrame::CollectGroups() {
+		mGroups.clear();
+		for (const auto& message : mMessages) {
+			if (message.length != 0 && message.deferrable && !IsWaitingForCreate(message)) {
+				auto& group = mGroups[message.objectId];
+				group.weight += message.weight;
+				group.bytes += message.length;
+			}
+		}
+	}
+
+	void OutgoingFrame::Compact() {
+		mSpareBuffer.clear();
+		mLatest.clear();
+		mCreates.clear();
+
+		uint32_t kept = 0;
+		for (auto message : mMessages) {
+			if (message.length == 0) {
+				continue;
+			}
+
+			auto& keptMessage = mMessages[kept];
+			keptMessage = message;
+			keptMessage.offset = static_cast<uint32_t>(mSpareBuffer.size());
+			if (keptMessage.key != 0) {
+				mLatest[keptMessage.key] = kept;
+			}
+
+			mSpareBuffer.insert(mSpareBuffer.end(), mBuffer.data() + message.offset, mBuffer.data() + message.offset + message.length);
+			kept++;
+		}
+
+		mMessages.resize(kept);
+		std::swap(mBuffer, mSpareBuffer);
+
+		if (mMessages.empty()) {
+			mPriorities.clear();
+		}
+	}
+
+	// Client
 	Client::Client(Server& server, const SystemAddress& systemAddress)
 		: mServer(server), mSystemAddress(systemAddress) {}
 
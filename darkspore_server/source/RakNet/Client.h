@@ -5,9 +5,15 @@
 // Include
 #include "Core/Base/Predefined.h"
 #include "Types.h"
+#include "SendPolicy.h"
 
 #include <RakPeerInterface.h>
 #include <memory>
+#include <vector>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
 
 enum class GameState : uint32_t {
 	Invalid = 0xFFFFFFFF,
@@ -40,6 +46,78 @@ enum class GameState : uint32_t {
 
 // RakNet
 namespace RakNet {
+	// OutgoingFrame
+	class OutgoingFrame {
+		public:
+			using Scorer = std::function<float(uint32_t)>;
+			using Sender = std::function<void(const uint8_t*, uint32_t)>;
+
+			void Append(const BitStream& stream, const SendPolicy& policy);
+			void Clear();
+
+			// Raises the priority of every held back object, once per tick, so nothing waits forever.
+			void Accumulate(const Scorer& scorer);
+
+			// Hands out everything that cannot be held back, then objects by priority while the budget lasts (negative budget = debt).
+			// Without a budget everything goes out in append order. Either way, messages RakNet would not order behind the
+			// ObjectCreate of their object wait for the drain after the one that sends it.
+			void Drain(int64_t& budget, bool limited, const Scorer& scorer, const Sender& sender);
+
+			bool IsEmpty() const { return mMessages.empty(); }
+
+			// Since the last drain.
+			size_t GetSupersededCount() const { return mSuperseded; }
+
+			size_t GetMessageCount() const { return mMessages.size(); }
+			size_t GetByteCount() const { return mBuffer.size(); }
+
+		private:
+			struct Message {
+				uint32_t offset;
+				uint32_t length; // 0 once superseded or sent
+				uint32_t objectId; // 0 unless the policy says the packet starts with one
+				uint64_t key; // 0 unless supersedable
+				float weight;
+				bool deferrable;
+				bool afterCreate; // not ordered behind ObjectCreate by RakNet
+			};
+
+			struct Group {
+				float weight = 0;
+				uint32_t bytes = 0;
+				bool selected = false;
+			};
+
+			// Held for the next drain, the create of its object goes out in this one.
+			bool IsWaitingForCreate(const Message& message) const;
+
+			void CollectGroups();
+			void Compact();
+
+		private:
+			// Messages are kept back to back in one buffer that keeps its capacity between ticks.
+			std::vector<uint8_t> mBuffer;
+			std::vector<uint8_t> mSpareBuffer;
+			std::vector<Message> mMessages;
+
+			// supersede key -> index of the newest message in mMessages
+			std::unordered_map<uint64_t, uint32_t> mLatest;
+
+			// Objects with an ObjectCreate in the frame, until the drain that sends it.
+			std::unordered_set<uint32_t> mCreates;
+
+			// object id -> accumulated priority of its unsent messages
+			std::unordered_map<uint32_t, float> mPriorities;
+
+			// Scratch, reused every flush.
+			std::unordered_map<uint32_t, Group> mGroups;
+			std::vector<std::tuple<float, uint32_t>> mOrder;
+			std::vector<uint32_t> mDeleted;
+
+			size_t mSuperseded = 0;
+	};
+
+	// Client
 	class Client {
 		public:
 			Client(Server& server, const SystemAddress& systemAddress);
@@ -75,6 +153,9 @@ namespace RakNet {
 
 			GameStateData mGameStateData;
 
+			OutgoingFrame mFrame;
+			int64_t mBudget = 0;
+
 			GameState mGameState = GameState::Invalid;
 
 			friend class Server;
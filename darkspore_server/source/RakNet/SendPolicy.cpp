@@ -0,0 +1,168 @@
+
+// Include
+#include "SendPolicy.h"
+
+#include <pugixml.hpp>
+
+#include <filesystem>
+#include <iostream>
+#include <format>
+
+/*
+	Ordering channels
+		0 - session and object state, everything that must arrive after ObjectCreate and before ObjectDelete
+		1 - movement, so a lost ObjectUpdate does not hold back positions (and the other way around)
+		2 - the unreliable locomotion stream, only the newest one matters
+		3 - per tick game state, only the newest one matters
+		4 - objectives, every change has to arrive, and in order
+		5 - cosmetic combat feedback
+
+	Sequenced messages are dropped when a newer one on the same channel got there first, whatever packet it was,
+	so nothing that must arrive shares a channel with them.
+
+	Nothing on channels other than 0 is ordered behind ObjectCreate by RakNet, so the client frame holds messages
+	about an object back until the drain after the one that sent its create (object="true" below).
+
+	Overrides file, supersede is "none", "object" or "packet"
+		<policies>
+			<policy packet="LocomotionDataUpdate" priority="MEDIUM" reliability="RELIABLE_ORDERED" channel="1" supersede="object" object="true" deferrable="true" weight="1.5"/>
+		</policies>
+*/
+
+// RakNet
+namespace RakNet {
+	// SendPolicyTable
+	std::array<SendPolicy, 0x100> SendPolicyTable::sPolicies;
+
+	void SendPolicyTable::Load(const std::string& path) {
+		LoadDefaults();
+		if (path.empty() || !std::filesystem::exists(path)) {
+			return;
+		}
+
+		pugi::xml_document document;
+		if (!document.load_file(path.c_str())) {
+			std::cout << std::format("RakNet::SendPolicyTable: Could not parse '{}'", path) << std::endl;
+			return;
+		}
+
+		const auto parse_packet = [](std::string_view name) -> int32_t {
+			for (int32_t id = static_cast<int32_t>(PacketID::HelloPlayerRequest); id <= static_cast<int32_t>(PacketID::DebugPing); ++id) {
+				if (to_string(static_cast<PacketID>(id)) == name) {
+					return id;
+				}
+			}
+			return -1;
+		};
+
+		const auto parse_priority = [](std::string_view name, PacketPriority value) {
+			if (name == "SYSTEM") { return SYSTEM_PRIORITY; }
+			if (name == "HIGH") { return HIGH_PRIORITY; }
+			if (name == "MEDIUM") { return MEDIUM_PRIORITY; }
+			if (name == "LOW") { return LOW_PRIORITY; }
+			return value;
+		};
+
+		const auto parse_reliability = [](std::string_view name, PacketReliability value) {
+			if (name == "UNRELIABLE") { return UNRELIABLE; }
+			if (name == "UNRELIABLE_SEQUENCED") { return UNRELIABLE_SEQUENCED; }
+			if (name == "RELIABLE") { return RELIABLE; }
+			if (name == "RELIABLE_ORDERED") { return RELIABLE_ORDERED; }
+			if (name == "RELIABLE_SEQUENCED") { return RELIABLE_SEQUENCED; }
+			if (name == "UNRELIABLE_WITH_ACK_RECEIPT") { return UNRELIABLE_WITH_ACK_RECEIPT; }
+			return value;
+		};
+
+		const auto parse_supersede = [](std::string_view name, SupersedeMode value) {
+			if (name == "none") { return SupersedeMode::None; }
+			if (name == "object") { return SupersedeMode::Object; }
+			if (name == "packet") { return SupersedeMode::Packet; }
+			return value;
+		};
+
+		for (const auto& node : document.child("policies").children("policy")) {
+			std::string_view name = node.attribute("packet").value();
+
+			auto id = parse_packet(name);
+			if (id < 0) {
+				std::cout << std::format("RakNet::SendPolicyTable: Unknown packet '{}'", name) << std::endl;
+				continue;
+			}
+
+			auto& policy = sPolicies[id];
+			policy.priority = parse_priority(node.attribute("priority").value(), policy.priority);
+			policy.reliability = parse_reliability(node.attribute("reliability").value(), policy.reliability);
+			policy.orderingChannel = static_cast<char>(node.attribute("channel").as_int(policy.orderingChannel));
+			policy.supersede = parse_supersede(node.attribute("supersede").value(), policy.supersede);
+			policy.objectId = node.attribute("object").as_bool(policy.objectId);
+			policy.deferrable = node.attribute("deferrable").as_bool(policy.deferrable);
+			policy.weight = node.attribute("weight").as_float(policy.weight);
+		}
+	}
+
+	const SendPolicy& SendPolicyTable::Get(PacketID id) {
+		return sPolicies[static_cast<uint8_t>(id)];
+	}
+
+	const SendPolicy& SendPolicyTable::Get(uint8_t id) {
+		return sPolicies[id];
+	}
+
+	void SendPolicyTable::LoadDefaults() {
+		sPolicies.fill(SendPolicy {});
+
+		const auto set = [](PacketID id, PacketPriority priority, PacketReliability reliability, char orderingChannel, SupersedeMode supersede) {
+			sPolicies[static_cast<uint8_t>(id)] = SendPolicy { priority, reliability, orderingChannel, supersede };
+		};
+
+		// Movement
+		set(PacketID::ObjectTeleport, HIGH_PRIORITY, RELIABLE_ORDERED, 1, SupersedeMode::Object);
+		set(PacketID::ObjectPlayerMove, HIGH_PRIORITY, RELIABLE_ORDERED, 1, SupersedeMode::Object);
+		set(PacketID::ForcePhysicsUpdate, HIGH_PRIORITY, RELIABLE_ORDERED, 1, SupersedeMode::Object);
+		set(PacketID::LocomotionDataUpdate, HIGH_PRIORITY, RELIABLE_ORDERED, 1, SupersedeMode::Object);
+		set(PacketID::LocomotionDataUnreliableUpdate, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 2, SupersedeMode::Object);
+
+		// Per tick state
+		set(PacketID::GameState, MEDIUM_PRIORITY, UNRELIABLE_SEQUENCED, 3, SupersedeMode::Packet);
+
+		// Every update may carry a notification or voiceover, none of them replaces another.
+		set(PacketID::ObjectiveUpdated, MEDIUM_PRIORITY, RELIABLE_ORDERED, 4, SupersedeMode::None);
+
+		// Cosmetic
+		set(PacketID::CombatEvent, MEDIUM_PRIORITY, RELIABLE, 5, SupersedeMode::None);
+		set(PacketID::DebugPing, LOW_PRIORITY, UNRELIABLE, 0, SupersedeMode::None);
+
+		// Packets that start with the id of the object they are about
+		for (const auto id : {
+			PacketID::ObjectCreate, PacketID::ObjectUpdate, PacketID::ObjectJump, PacketID::ObjectTeleport, PacketID::ObjectPlayerMove,
+			PacketID::ForcePhysicsUpdate, PacketID::PhysicsChanged, PacketID::LocomotionDataUpdate, PacketID::LocomotionDataUnreliableUpdate,
+			PacketID::AttributeDataUpdate, PacketID::CombatantDataUpdate, PacketID::InteractableDataUpdate, PacketID::AgentBlackboardUpdate,
+			PacketID::LootDataUpdate, PacketID::ModifierCreated, PacketID::ModifierUpdated, PacketID::ModifierDeleted,
+			PacketID::SetAnimationState, PacketID::SetObjectGfxState, PacketID::CooldownUpdate
+		}) {
+			sPolicies[static_cast<uint8_t>(id)].objectId = true;
+		}
+
+		// Object state, scheduled by priority under the client bandwidth budget
+		// ObjectCreate is never held back, everything else about the object and interest management count on it being out.
+		const auto defer = [](PacketID id, float weight) {
+			auto& policy = sPolicies[static_cast<uint8_t>(id)];
+			policy.deferrable = true;
+			policy.weight = weight;
+		};
+
+		defer(PacketID::CombatantDataUpdate, 2.f);
+		defer(PacketID::ObjectTeleport, 1.5f);
+		defer(PacketID::ObjectPlayerMove, 1.5f);
+		defer(PacketID::ForcePhysicsUpdate, 1.5f);
+		defer(PacketID::LocomotionDataUpdate, 1.5f);
+		defer(PacketID::LocomotionDataUnreliableUpdate, 1.5f);
+		defer(PacketID::ObjectUpdate, 1.f);
+		defer(PacketID::SetAnimationState, 1.f);
+		defer(PacketID::SetObjectGfxState, 1.f);
+		defer(PacketID::AttributeDataUpdate, 0.5f);
+		defer(PacketID::InteractableDataUpdate, 0.5f);
+		defer(PacketID::AgentBlackboardUpdate, 0.5f);
+		defer(PacketID::LootDataUpdate, 0.5f);
+	}
+}
@@ -0,0 +1,58 @@
+
+#ifndef _RAKNET_SEND_POLICY_HEADER
+#define _RAKNET_SEND_POLICY_HEADER
+
+// Include
+#include "Types.h"
+
+#include <PacketPriority.h>
+
+#include <array>
+#include <string>
+
+// RakNet
+namespace RakNet {
+	// SupersedeMode
+	enum class SupersedeMode : uint8_t {
+		None,
+		Object, // packet id and the object id that follows it
+		Packet // packet id alone, for packets there is only one current value of (GameState)
+	};
+
+	// SendPolicy
+	struct SendPolicy {
+		PacketPriority priority = HIGH_PRIORITY;
+		PacketReliability reliability = RELIABLE_ORDERED;
+
+		char orderingChannel = 0;
+
+		// A newer message with the same key replaces an unsent one in the client frame.
+		SupersedeMode supersede = SupersedeMode::None;
+
+		// Starts with the id of the object it is about, see ObjectCreate and ObjectDelete in the client frame.
+		bool objectId = false;
+
+		// Starts with an object id and may be held back for a later tick when the client is over its bandwidth budget.
+		bool deferrable = false;
+
+		// How much this kind of update adds to the priority of its object while it waits.
+		float weight = 1.f;
+	};
+
+	// SendPolicyTable
+	class SendPolicyTable {
+		public:
+			static void Load(const std::string& path);
+
+			static const SendPolicy& Get(PacketID id);
+			static const SendPolicy& Get(uint8_t id);
+
+		private:
+			static void LoadDefaults();
+
+		private:
+			static std::array<SendPolicy, 0x100> sPolicies;
+	};
+}
+
+#endif
@@ -6,17 +6,21 @@
 #include "SporeNet/User.h"
 #include "SporeNet/Creature.h"
 
+#include "SendPolicy.h"
+
 #include "Core/Utils/Functions.h"
 
+#include "Game/Config.h"
 #include "Game/Instance.h"
 #include "Game/ObjectManager.h"
+#include "Game/InterestManager.h"
 #include "Game/ServerEvent.h"
 #include "Game/Catalyst.h"
+#include "Game/Lua.h"
 
 #include <glm/gtx/euler_angles.hpp>
 
 #include <MessageIdentifiers.h>
-#include <RakSleep.h>
 #include <RakNetTypes.h>
 #include <RakNetworkFactory.h>
 #include <BitStream.h>
@@ -81,6 +85,11 @@ static bool DBG_SEND_TELEPORTS          = true;
 static bool DBG_SEND_LOOT_UPDATE        = false;
 static bool DBG_SEND_INTERACTABLE_UPDATE= true;
 
+// Tick driver
+static constexpr uint32_t sMaxTickRate = 240;
+static constexpr uint32_t sMaxCatchUpTicks = 5;
+static constexpr std::chrono::milliseconds sNetworkPollInterval { 10 };
+
 // RakNet
 namespace RakNet {
 	// Debug
@@ -156,7 +165,15 @@ namespace RakNet {
 
 	// Server
 	Server::Server(Game::Instance& game) : mGame(game) {
-		// Nothing?
+		mTickRate = std::clamp<uint32_t>(Game::Config::GetU32(Game::CONFIG_GAME_TICK_RATE), 1, sMaxTickRate);
+		mTickInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / mTickRate));
+		mTickCatchUp = Game::Config::GetBool(Game::CONFIG_GAME_TICK_CATCH_UP);
+		mClientBudget = Game::Config::GetU32(Game::CONFIG_GAME_CLIENT_BUDGET);
+
+		// RakNet does not expose a socket wakeup, so incoming packets are polled on a short interval between ticks.
+		mPollInterval = std::min<Clock::duration>(sNetworkPollInterval, mTickInterval);
+
+		mStrand = GetApp().GetExecutor().MakeStrand();
 	}
 
 	Server::~Server() {
@@ -164,7 +181,7 @@ namespace RakNet {
 	}
 
 	void Server::start(uint16_t port) {
-		mThread = std::thread([this, port] {
+		mStrand->Post([this, port] {
 			mSelf = RakNetworkFactory::GetRakPeerInterface();
 			// mSelf->SetTimeoutTime(30000, UNASSIGNED_SYSTEM_ADDRESS);
 			mSelf->SetTimeoutTime(0xFFFFFFFF, UNASSIGNED_SYSTEM_ADDRESS);
@@ -174,6 +191,8 @@ namespace RakNet {
 
 			auto socketDescriptor = SocketDescriptor(port, nullptr);
 			if (!mSelf->Startup(4, 10, &socketDescriptor, 1)) {
+				RakNetworkFactory::DestroyRakPeerInterface(mSelf);
+				mSelf = nullptr;
 				return;
 			}
 
@@ -182,36 +201,9 @@ namespace RakNet {
 			// mSelf->SetUnreliableTimeout(1000);
 			mSelf->SetUnreliableTimeout(0);
 
-			std::unique_lock<std::mutex> taskUniqueLock(mTaskMutex, std::defer_lock);
-			while (is_running()) {
-				taskUniqueLock.lock();
-				while (!mTasks.empty()) {
-					mTasks.front()();
-					mTasks.pop();
-				}
-				taskUniqueLock.unlock();
-
-				if (mGame.ServerUpdate()) {
-					run_one();
-				}
-
-				if (mGame.Update()) {
-					// Loop clients instead of using broadcasting to get separate client data
-					const auto& gameStateData = mGame.GetStateData();
-					for (const auto& [_, client] : mClients) {
-						auto& clientGameStateData = client->GetGameStateData();
-						clientGameStateData.var = gameStateData.var;
-						clientGameStateData.type = gameStateData.type;
-
-						SendGameState(client, clientGameStateData);
-					}
-				}
-
-				RakSleep(1);
-			}
-
-			mSelf->Shutdown(300);
-			RakNetworkFactory::DestroyRakPeerInterface(mSelf);
+			mNextTick = Clock::now() + mTickInterval;
+			mNextPoll = Clock::now();
+			run_pump();
 		});
 	}
 
@@ -221,16 +213,104 @@ namespace RakNet {
 			mRunning = false;
 		}
 
-		if (mThread.joinable()) {
-			mThread.join();
+		// Waits for a tick in flight on another worker; pending tasks are dropped.
+		mStrand->Close();
+
+		if (mSelf) {
+			mSelf->Shutdown(300);
+			RakNetworkFactory::DestroyRakPeerInterface(mSelf);
+			mSelf = nullptr;
 		}
 	}
 
-	bool Server::is_running() {
+	bool Server::is_running() const {
 		std::lock_guard<std::mutex> lock(mMutex);
 		return mRunning;
 	}
 
+	TickStats Server::GetTickStats() const {
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mTickStats;
+	}
+
+	Strand::Stats Server::GetStrandStats() const {
+		return mStrand->GetStats();
+	}
+
+	void Server::run_pump() {
+		if (!is_running()) {
+			return;
+		}
+
+		auto now = Clock::now();
+		if (now >= mNextPoll) {
+			run_one();
+			mNextPoll = now + mPollInterval;
+		}
+
+		bool ticked = false;
+		if (now >= mNextTick) {
+			run_tick();
+			ticked = true;
+		}
+
+		Flush();
+		if (ticked) {
+			std::lock_guard<std::mutex> lock(mMutex);
+			mTickStats.lastTickMessages = mFrameMessages;
+			mTickStats.lastTickBytes = mFrameBytes;
+			mFrameMessages = 0;
+			mFrameBytes = 0;
+		}
+
+		mStrand->PostAt(std::min(mNextTick, mNextPoll), [this] {
+			run_pump();
+		});
+	}
+
+	void Server::run_tick() {
+		// Ticks missed since the deadline, not counting the one we are about to run.
+		const auto tickStart = Clock::now();
+		const auto missedTicks = static_cast<uint32_t>((tickStart - mNextTick) / mTickInterval);
+
+		uint32_t steps = 1;
+		if (missedTicks > 0 && mTickCatchUp) {
+			steps = std::min<uint32_t>(missedTicks + 1, sMaxCatchUpTicks);
+		}
+
+		const auto deltaTime = GetTickDeltaTime();
+		for (uint32_t i = 0; i < steps; ++i) {
+			mGame.Update(deltaTime);
+		}
+
+		// Skipped ticks are dropped instead of simulated, keep the schedule aligned to the original phase.
+		mNextTick += mTickInterval * (missedTicks + 1);
+
+		RefillBudgets();
+
+		// Loop clients instead of using broadcasting to get separate client data
+		const auto& gameStateData = mGame.GetStateData();
+		for (const auto& [_, client] : mClients) {
+			auto& clientGameStateData = client->GetGameStateData();
+			clientGameStateData.var = gameStateData.var;
+			clientGameStateData.type = gameStateData.type;
+
+			SendGameState(client, clientGameStateData);
+		}
+
+		const auto tickCost = Clock::now() - tickStart;
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mTickStats.ticks += steps;
+		mTickStats.lastTickCost = tickCost;
+		mTickStats.maxTickCost = std::max(mTickStats.maxTickCost, tickCost);
+		mTickStats.totalTickCost += tickCost;
+		if (missedTicks > 0) {
+			mTickStats.overruns++;
+			mTickStats.skippedTicks += (missedTicks + 1) - steps;
+		}
+	}
+
 	void Server::run_one() {
 		const auto GetPacketIdentifier = [this]() -> MessageID {
 			uint8_t message;
@@ -264,13 +344,14 @@ namespace RakNet {
 	}
 
 	void Server::add_task(std::function<void(void)> task) {
-		std::lock_guard<std::mutex> lock(mTaskMutex);
-		mTasks.push(std::move(task));
+		mStrand->Post([this, task = std::move(task)] {
+			task();
+			Flush();
+		});
 	}
 
 	void Server::add_client_task(uint8_t id, PacketID packet) {
-		std::lock_guard<std::mutex> lock(mTaskMutex);
-		mTasks.push([this, id, packet] {
+		mStrand->Post([this, id, packet] {
 			const auto& client = mClients.begin()->second;
 			if (!client) {
 				return;
@@ -391,6 +472,8 @@ namespace RakNet {
 					teleportMovement = !teleportMovement;
 					break;
 			}
+
+			Flush();
 		});
 	}
 
@@ -539,7 +622,9 @@ namespace RakNet {
 	}
 
 	void Server::Send(BitStream& stream, const ClientPtr& client) {
-		mSelf->Send(&stream, HIGH_PRIORITY, UNRELIABLE_WITH_ACK_RECEIPT, 0, client->mSystemAddress, false);
+		// Queued in the client frame, the whole frame goes out at the end of the current pump or task.
+		const auto packetId = stream.GetData()[0];
+		client->mFrame.Append(stream, SendPolicyTable::Get(packetId));
 #if 1 // if logging
 		stream.ResetReadPointer();
 
@@ -549,6 +634,7 @@ namespace RakNet {
 		switch (packetType) {
 			case PacketID::ObjectiveUpdated:
 			case PacketID::GameState:
+			case PacketID::CombatEvent:
 				break;
 
 			default:
@@ -558,8 +644,99 @@ namespace RakNet {
 #endif
 	}
 
+	void Server::Send(BitStream& stream, const Recipients& recipients) {
+		if (recipients.IsSubset()) {
+			for (const auto& client : recipients.GetClients()) {
+				Send(stream, client);
+			}
+			return;
+		}
+
+		if (!recipients.IsAll()) {
+			Send(stream, recipients.GetClient());
+			return;
+		}
+
+		for (const auto& [_, client] : mClients) {
+			Send(stream, client);
+		}
+	}
+
 	void Server::SendBroadcast(BitStream& stream) {
-		mSelf->Send(&stream, HIGH_PRIORITY, UNRELIABLE_WITH_ACK_RECEIPT, 0, UNASSIGNED_SYSTEM_ADDRESS, true);
+		const auto& policy = SendPolicyTable::Get(stream.GetData()[0]);
+		for (const auto& [_, client] : mClients) {
+			client->mFrame.Append(stream, policy);
+		}
+	}
+
+	void Server::Flush() {
+		if (!mSelf) {
+			return;
+		}
+
+		const bool limited = mClientBudget > 0;
+
+		size_t messages = 0;
+		size_t bytes = 0;
+		size_t superseded = 0;
+		size_t pendingMessages = 0;
+		size_t pendingBytes = 0;
+		for (const auto& [_, client] : mClients) {
+			auto& frame = client->mFrame;
+			if (frame.IsEmpty()) {
+				continue;
+			}
+
+			superseded += frame.GetSupersededCount();
+
+			// Sent back to back so the reliability layer can pack them into as few datagrams as possible.
+			frame.Drain(client->mBudget, limited, GetPriorityScorer(client), [&](const uint8_t* data, uint32_t length) {
+				const auto& policy = SendPolicyTable::Get(data[0]);
+				mSelf->Send(reinterpret_cast<const char*>(data), static_cast<int>(length), policy.priority, policy.reliability, policy.orderingChannel, client->mSystemAddress, false);
+
+				messages++;
+				bytes += length;
+			});
+
+			pendingMessages += frame.GetMessageCount();
+			pendingBytes += frame.GetByteCount();
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mTickStats.pendingMessages = pendingMessages;
+		mTickStats.pendingBytes = pendingBytes;
+		if (messages == 0) {
+			return;
+		}
+
+		mTickStats.messagesSent += messages;
+		mTickStats.messagesSuperseded += superseded;
+		mTickStats.bytesSent += bytes;
+		mFrameMessages += messages;
+		mFrameBytes += bytes;
+	}
+
+	void Server::RefillBudgets() {
+		if (mClientBudget == 0) {
+			return;
+		}
+
+		// Unused budget does not pile up, debt from an oversized message is paid off over the next ticks.
+		const auto budget = static_cast<int64_t>(mClientBudget);
+		for (const auto& [_, client] : mClients) {
+			client->mBudget = std::min(client->mBudget + budget, budget);
+			client->mFrame.Accumulate(GetPriorityScorer(client));
+		}
+	}
+
+	OutgoingFrame::Scorer Server::GetPriorityScorer(const ClientPtr& client) const {
+		return [this, &client](uint32_t objectId) {
+			return mGame.GetInterestManager().GetPriority(client, objectId);
+		};
+	}
+
+	int32_t Server::GetAveragePing(const ClientPtr& client) const {
+		return client ? mSelf->GetAveragePing(client->mSystemAddress) : -1;
 	}
 
 	void Server::OnNewIncomingConnection(Packet* packet) {
@@ -877,7 +1054,9 @@ namespace RakNet {
 					combatData.unk[1] = command.ability.unk;
 					combatData.valueFromActionResponse = command.ability.userData;
 
-					mGame.UseAbility(object, combatData);
+					// The client fired at what it saw, half a round trip and a tick ago.
+					const auto rewind = mGame.GetObjectManager().GetLagCompensation().GetRewind(GetAveragePing(client));
+					mGame.UseAbility(object, combatData, rewind);
 
 					auto targetObject = mGame.GetObjectManager().Get(command.ability.targetId);
 					if (targetObject) {
@@ -1368,7 +1547,7 @@ namespace RakNet {
 		SendBroadcast(outStream);
 	}
 
-	void Server::SendLabsPlayerUpdate(const ClientPtr& client, const Game::PlayerPtr& player) {
+	void Server::SendLabsPlayerUpdate(const Recipients& recipients, const Game::PlayerPtr& player) {
 		if (!player) {
 			return;
 		}
@@ -1407,7 +1586,7 @@ namespace RakNet {
 			}
 		}
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
 	void Server::SendDirectorState(const ClientPtr& client, const cAIDirector& director) {
@@ -1441,7 +1620,7 @@ namespace RakNet {
 		Send(outStream, client);
 	}
 	
-	void Server::SendObjectCreate(const ClientPtr& client, const Game::ObjectPtr& object) {
+	void Server::SendObjectCreate(const Recipients& recipients, const Game::ObjectPtr& object, bool full) {
 		if (!DBG_SEND_OBJECT_SPAWNS) return;
 		if (!object) {
 			return;
@@ -1471,7 +1650,7 @@ namespace RakNet {
 
 		// write reflection of creation and the object
 		createData.WriteReflection(outStream);
-		object->WriteReflection(outStream);
+		object->WriteReflection(outStream, full);
 
 		// write update data (same as in ObjectUpdate
 		// is the u8 value here "team"?
@@ -1496,17 +1675,18 @@ namespace RakNet {
 			createData.position.WriteTo(outStream);
 		}
 #endif
-		Send(outStream, client);
+		Send(outStream, recipients);
 		LogPacketSize("ObjectCreate", outStream);
 	}
 
-	void Server::SendObjectUpdate(const ClientPtr& client, const Game::ObjectPtr& object) {
+	void Server::SendObjectUpdate(const Recipients& recipients, const Game::ObjectPtr& object) {
 		if (!object) {
 			return;
 		}
 
-		// Packet data
-		BitStream outStream(8);
+		// Sent for every changed object every tick, the stream keeps what full reflections grew it to.
+		static thread_local BitStream outStream;
+		outStream.Reset();
 		outStream.Write(PacketID::ObjectUpdate);
 
 		Write<uint32_t>(outStream, object->GetId());
@@ -1514,10 +1694,10 @@ namespace RakNet {
 
 		// 0x15 data in loop
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
-	void Server::SendObjectDelete(const ClientPtr& client, const Game::ObjectPtr& object) {
+	void Server::SendObjectDelete(const Recipients& recipients, const Game::ObjectPtr& object) {
 		// 100%
 		if (!object) {
 			return;
@@ -1528,10 +1708,10 @@ namespace RakNet {
 
 		Write<uint32_t>(outStream, object->GetId());
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
-	void Server::SendObjectDelete(const ClientPtr& client, const std::vector<Game::ObjectPtr>& objects) {
+	void Server::SendObjectDelete(const Recipients& recipients, const std::vector<Game::ObjectPtr>& objects) {
 		// 100%
 		if (objects.empty()) {
 			return;
@@ -1545,7 +1725,7 @@ namespace RakNet {
 			}
 		}
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
 	void Server::SendActionCancel(const ClientPtr& client, uint8_t value, uint32_t otherValue) {
@@ -1683,7 +1863,7 @@ namespace RakNet {
 		Send(outStream, client);
 	}
 
-	void Server::SendObjectTeleport(const ClientPtr& client, const Game::ObjectPtr& object, const glm::vec3& position, const glm::quat& orientation) {
+	void Server::SendObjectTeleport(const Recipients& recipients, const Game::ObjectPtr& object, const glm::vec3& position, const glm::quat& orientation) {
 		if (!DBG_SEND_TELEPORTS) return;
 
 		BitStream outStream(33);
@@ -1693,11 +1873,11 @@ namespace RakNet {
 		Write(outStream, position);
 		Write(outStream, orientation);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 		LogPacketSize("ObjectTeleport", outStream);
 	}
 
-	void Server::SendObjectPlayerMove(const ClientPtr& client, const Game::ObjectPtr& object, const Game::Locomotion& locomotionData) {
+	void Server::SendObjectPlayerMove(const Recipients& recipients, const Game::ObjectPtr& object, const Game::Locomotion& locomotionData) {
 		// 100%
 		BitStream outStream(81);
 		outStream.Write(PacketID::ObjectPlayerMove);
@@ -1713,7 +1893,7 @@ namespace RakNet {
 		Write(outStream, locomotionData.GetTargetPosition());
 		Write<uint32_t>(outStream, locomotionData.GetTargetId());
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
 	void Server::SendForcePhysicsUpdate(const ClientPtr& client, const Game::ObjectPtr& object) {
@@ -1748,7 +1928,7 @@ namespace RakNet {
 		Send(outStream, client);
 	}
 
-	void Server::SendLocomotionDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::Locomotion& locomotionData) {
+	void Server::SendLocomotionDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::Locomotion& locomotionData) {
 		// 100%
 		if (!object) {
 			return;
@@ -1760,11 +1940,11 @@ namespace RakNet {
 		Write<uint32_t>(outStream, object->GetId());
 		// locomotionData.WriteReflection(outStream);
 		locomotionData.WriteTo(outStream);
-		Send(outStream, client);
+		Send(outStream, recipients);
 		LogPacketSize("LocomotionDataUpdate", outStream);
 	}
 
-	void Server::SendLocomotionDataUnreliableUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const glm::vec3& position) {
+	void Server::SendLocomotionDataUnreliableUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const glm::vec3& position) {
 		// 100%
 		if (!object) {
 			return;
@@ -1776,10 +1956,10 @@ namespace RakNet {
 		Write<uint32_t>(outStream, object->GetId());
 		Write(outStream, position);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
-	void Server::SendAttributeDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::Attributes& attributes) {
+	void Server::SendAttributeDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::Attributes& attributes, bool full) {
 		// 100%
 		if (!object) {
 			return;
@@ -1789,12 +1969,12 @@ namespace RakNet {
 		outStream.Write(PacketID::AttributeDataUpdate);
 
 		Write<uint32_t>(outStream, object->GetId());
-		attributes.WriteReflection(outStream);
+		attributes.WriteReflection(outStream, full);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
-	void Server::SendCombatantDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::CombatantData& combatantData) {
+	void Server::SendCombatantDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::CombatantData& combatantData) {
 		// 100%
 		if (!object) {
 			return;
@@ -1806,10 +1986,10 @@ namespace RakNet {
 		Write<uint32_t>(outStream, object->GetId());
 		combatantData.WriteReflection(outStream);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
-	void Server::SendInteractableDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::InteractableData& interactableData) {
+	void Server::SendInteractableDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::InteractableData& interactableData) {
 		// 100%
 		if (!DBG_SEND_INTERACTABLE_UPDATE) return;
 
@@ -1824,11 +2004,11 @@ namespace RakNet {
 		// interactableData.WriteReflection(outStream);
 		interactableData.WriteTo(outStream);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 		LogPacketSize("InteractableDataUpdate", outStream);
 	}
 
-	void Server::SendAgentBlackboardUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::AgentBlackboard& agentBlackboard) {
+	void Server::SendAgentBlackboardUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::AgentBlackboard& agentBlackboard) {
 		// 100%
 		if (!object) {
 			return;
@@ -1840,10 +2020,10 @@ namespace RakNet {
 		Write<uint32_t>(outStream, object->GetId());
 		agentBlackboard.WriteReflection(outStream);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
-	void Server::SendLootDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::LootData& lootData) {
+	void Server::SendLootDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::LootData& lootData) {
 		// 100%
 		if (!DBG_SEND_LOOT_UPDATE) return;
 
@@ -1857,11 +2037,11 @@ namespace RakNet {
 		Write<uint32_t>(outStream, object->GetId());
 		lootData.WriteReflection(outStream);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 		LogPacketSize("LootDataUpdate", outStream);
 	}
 
-	void Server::SendCooldownUpdate(const ClientPtr& client, const Game::ObjectPtr& object, uint32_t id, uint64_t start, uint32_t duration) {
+	void Server::SendCooldownUpdate(const Recipients& recipients, const Game::ObjectPtr& object, uint32_t id, uint64_t start, uint32_t duration) {
 		// 100%
 		if (!object) {
 			return;
@@ -1877,10 +2057,10 @@ namespace RakNet {
 		Write<uint64_t>(outStream, start);
 		Write<uint64_t>(outStream, 0); // not quite sure how this one works yet
 		
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
-	void Server::SendServerEvent(const ClientPtr& client, const Game::ServerEventBase& serverEvent) {
+	void Server::SendServerEvent(const Recipients& recipients, const Game::ServerEventBase& serverEvent) {
 		// 100%
 		if (!DBG_SEND_SERVER_EVENT) return;
 
@@ -1889,7 +2069,7 @@ namespace RakNet {
 
 		serverEvent.WriteReflection(outStream);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 		LogPacketSize("ServerEvent", outStream);
 	}
 
@@ -1903,14 +2083,14 @@ namespace RakNet {
 		Send(outStream, client);
 	}
 
-	void Server::SendCombatEvent(const ClientPtr& client, const Game::CombatEvent& combatEvent) {
+	void Server::SendCombatEvent(const Recipients& recipients, const Game::CombatEvent& combatEvent) {
 		// 100%
 		BitStream outStream(8);
 		outStream.Write(PacketID::CombatEvent);
 
 		combatEvent.WriteReflection(outStream);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
 	void Server::SendModifierCreated(const ClientPtr& client, const Game::ObjectPtr& object) {
@@ -1970,7 +2150,7 @@ namespace RakNet {
 		Send(outStream, client);
 	}
 
-	void Server::SendAnimationState(const ClientPtr& client, const Game::ObjectPtr& object, uint32_t state, uint64_t timestamp, bool overlay, float scale) {
+	void Server::SendAnimationState(const Recipients& recipients, const Game::ObjectPtr& object, uint32_t state, uint64_t timestamp, bool overlay, float scale) {
 		BitStream outStream(8);
 		outStream.Write(PacketID::SetAnimationState);
 
@@ -1981,10 +2161,10 @@ namespace RakNet {
 		Write<float>(outStream, scale);
 		Write<uint32_t>(outStream, state); // some client data?
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
-	void Server::SendObjectGfxState(const ClientPtr& client, const Game::ObjectPtr& object, uint32_t state, uint64_t timestamp) {
+	void Server::SendObjectGfxState(const Recipients& recipients, const Game::ObjectPtr& object, uint32_t state, uint64_t timestamp) {
 		BitStream outStream(8);
 		outStream.Write(PacketID::SetObjectGfxState);
 
@@ -1992,7 +2172,7 @@ namespace RakNet {
 		Write<uint32_t>(outStream, state);
 		Write<uint64_t>(outStream, timestamp);
 
-		Send(outStream, client);
+		Send(outStream, recipients);
 	}
 
 	void Server::SendGamePrepareForStart(const ClientPtr& client) {
@@ -13,6 +13,8 @@
 
 #include "Blaze/Types.h"
 
+#include "Core/Async/Executor.h"
+
 #ifdef PACKET_LOGGING
 #	include <PacketLogger.h>
 #endif
@@ -21,12 +23,11 @@
 #include <BitStream.h>
 
 #include <cstdint>
-#include <thread>
+#include <chrono>
 #include <mutex>
 #include <vector>
 #include <map>
 #include <array>
-#include <queue>
 #include <functional>
 
 // RakNet
@@ -120,15 +121,64 @@ namespace RakNet {
 		uint32_t level = 0;
 	};
 
+	// Recipients
+	class Recipients {
+		public:
+			Recipients(const ClientPtr& client) : mClient(&client) {}
+
+			// A subset of the connected clients, like the ones an object is currently relevant to.
+			Recipients(const std::vector<ClientPtr>& clients) : mClients(&clients) {}
+
+			// Every connected client, the stream is serialized once and the same bytes are handed to each of them.
+			static Recipients All() { return Recipients(); }
+
+			const ClientPtr& GetClient() const { return *mClient; }
+			const std::vector<ClientPtr>& GetClients() const { return *mClients; }
+
+			bool IsAll() const { return mClient == nullptr && mClients == nullptr; }
+			bool IsSubset() const { return mClients != nullptr; }
+
+		private:
+			Recipients() = default;
+
+		private:
+			const ClientPtr* mClient = nullptr;
+			const std::vector<ClientPtr>* mClients = nullptr;
+	};
+
+	// TickStats
+	struct TickStats {
+		uint64_t ticks = 0;
+		uint64_t overruns = 0;
+		uint64_t skippedTicks = 0;
+
+		std::chrono::steady_clock::duration lastTickCost {};
+		std::chrono::steady_clock::duration maxTickCost {};
+		std::chrono::steady_clock::duration totalTickCost {};
+
+		// Outgoing frames
+		uint64_t messagesSent = 0;
+		uint64_t messagesSuperseded = 0;
+		uint64_t bytesSent = 0;
+		uint64_t lastTickMessages = 0;
+		uint64_t lastTickBytes = 0;
+
+		// Held back by the client bandwidth budgets after the last flush
+		uint64_t pendingMessages = 0;
+		uint64_t pendingBytes = 0;
+	};
+
 	// Server
 	class Server {
 		public:
+			using Clock = std::chrono::steady_clock;
+
 			Server(Game::Instance& game);
 			~Server();
 
 			void start(uint16_t port);
 			void stop();
-			bool is_running();
+			bool is_running() const;
 
 			void run_one();
 
@@ -137,7 +187,15 @@ namespace RakNet {
 
 			Game::Instance& GetGame();
 
+			uint32_t GetTickRate() const { return mTickRate; }
+			float GetTickDeltaTime() const { return 1.f / mTickRate; }
+			TickStats GetTickStats() const;
+			Strand::Stats GetStrandStats() const;
+
 		private:
+			void run_pump();
+			void run_tick();
+
 			void ParseRakNetPackets(Packet* packet, uint8_t packetType);
 			void ParseSporeNetPackets(Packet* packet, uint8_t packetType);
 
@@ -149,7 +207,15 @@ namespace RakNet {
 			const auto& GetClients() const { return mClients; }
 
 			void Send(BitStream& stream, const ClientPtr& client);
+			void Send(BitStream& stream, const Recipients& recipients);
 			void SendBroadcast(BitStream& stream);
+			void Flush();
+			void RefillBudgets();
+
+			OutgoingFrame::Scorer GetPriorityScorer(const ClientPtr& client) const;
+
+			// In milliseconds, -1 until RakNet measured it.
+			int32_t GetAveragePing(const ClientPtr& client) const;
 			
 			// RakNet
 			void OnNewIncomingConnection(Packet* packet);
@@ -175,12 +241,12 @@ namespace RakNet {
 			void SendGameState(const ClientPtr& client, const GameStateData& data);
 			void SendGameState();
 			void SendPlayerCharacterDeploy(const ClientPtr& client, const Game::PlayerPtr& player, uint32_t creatureIndex);
-			void SendLabsPlayerUpdate(const ClientPtr& client, const Game::PlayerPtr& player);
+			void SendLabsPlayerUpdate(const Recipients& recipients, const Game::PlayerPtr& player);
 
-			void SendObjectCreate(const ClientPtr& client, const Game::ObjectPtr& object);
-			void SendObjectUpdate(const ClientPtr& client, const Game::ObjectPtr& object);
-			void SendObjectDelete(const ClientPtr& client, const Game::ObjectPtr& object);
-			void SendObjectDelete(const ClientPtr& client, const std::vector<Game::ObjectPtr>& objects);
+			void SendObjectCreate(const Recipients& recipients, const Game::ObjectPtr& object, bool full = false);
+			void SendObjectUpdate(const Recipients& recipients, const Game::ObjectPtr& object);
+			void SendObjectDelete(const Recipients& recipients, const Game::ObjectPtr& object);
+			void SendObjectDelete(const Recipients& recipients, const std::vector<Game::ObjectPtr>& objects);
 
 			void SendActionCancel(const ClientPtr& client, uint8_t value, uint32_t otherValue);
 
@@ -190,26 +256,26 @@ namespace RakNet {
 				const ClientPtr& client, const Game::ObjectPtr& object, const glm::vec3& destination, const glm::vec3& direction,
 				float speed, float minJumpHeight, float maxJumpHeight, float rangeToHitMaxJumpHeight
 			);
-			void SendObjectTeleport(const ClientPtr& client, const Game::ObjectPtr& object, const glm::vec3& position, const glm::quat& orientation);
-			void SendObjectPlayerMove(const ClientPtr& client, const Game::ObjectPtr& object, const Game::Locomotion& locomotionData);
+			void SendObjectTeleport(const Recipients& recipients, const Game::ObjectPtr& object, const glm::vec3& position, const glm::quat& orientation);
+			void SendObjectPlayerMove(const Recipients& recipients, const Game::ObjectPtr& object, const Game::Locomotion& locomotionData);
 			void SendForcePhysicsUpdate(const ClientPtr& client, const Game::ObjectPtr& object);
 			void SendPhysicsChanged(const ClientPtr& client, const Game::ObjectPtr& object, bool hasCollision);
-			void SendLocomotionDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::Locomotion& locomotionData);
-			void SendLocomotionDataUnreliableUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const glm::vec3& position);
-			void SendAttributeDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::Attributes& attributes);
-			void SendCombatantDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::CombatantData& combatantData);
-			void SendInteractableDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::InteractableData& interactableData);
-			void SendAgentBlackboardUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::AgentBlackboard& agentBlackboard);
-			void SendLootDataUpdate(const ClientPtr& client, const Game::ObjectPtr& object, const Game::LootData& lootData);
-			void SendCooldownUpdate(const ClientPtr& client, const Game::ObjectPtr& object, uint32_t id, uint64_t start, uint32_t duration);
-			void SendServerEvent(const ClientPtr& client, const Game::ServerEventBase& serverEvent);
+			void SendLocomotionDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::Locomotion& locomotionData);
+			void SendLocomotionDataUnreliableUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const glm::vec3& position);
+			void SendAttributeDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::Attributes& attributes, bool full = false);
+			void SendCombatantDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::CombatantData& combatantData);
+			void SendInteractableDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::InteractableData& interactableData);
+			void SendAgentBlackboardUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::AgentBlackboard& agentBlackboard);
+			void SendLootDataUpdate(const Recipients& recipients, const Game::ObjectPtr& object, const Game::LootData& lootData);
+			void SendCooldownUpdate(const Recipients& recipients, const Game::ObjectPtr& object, uint32_t id, uint64_t start, uint32_t duration);
+			void SendServerEvent(const Recipients& recipients, const Game::ServerEventBase& serverEvent);
 			void SendActionCommandMessages(const ClientPtr& client, const Game::PlayerPtr& player);
-			void SendCombatEvent(const ClientPtr& client, const Game::CombatEvent& combatEvent);
+			void SendCombatEvent(const Recipients& recipients, const Game::CombatEvent& combatEvent);
 			void SendModifierCreated(const ClientPtr& client, const Game::ObjectPtr& object);
 			void SendModifierUpdated(const ClientPtr& client, const Game::ObjectPtr& object, uint32_t modifierId, uint64_t timestamp, uint32_t stackCount, bool bind);
 			void SendModifierDeleted(const ClientPtr& client, const Game::ObjectPtr& object, uint32_t modifierId);
-			void SendAnimationState(const ClientPtr& client, const Game::ObjectPtr& object, uint32_t state, uint64_t timestamp, bool overlay, float scale);
-			void SendObjectGfxState(const ClientPtr& client, const Game::ObjectPtr& object, uint32_t state, uint64_t timestamp);
+			void SendAnimationState(const Recipients& recipients, const Game::ObjectPtr& object, uint32_t state, uint64_t timestamp, bool overlay, float scale);
+			void SendObjectGfxState(const Recipients& recipients, const Game::ObjectPtr& object, uint32_t state, uint64_t timestamp);
 			void SendGamePrepareForStart(const ClientPtr& client);
 			void SendGameStart(const ClientPtr& client);
 			void SendArenaGameMessages(const ClientPtr& client);
@@ -240,13 +306,24 @@ namespace RakNet {
 
 			std::map<SystemAddress, ClientPtr> mClients;
 
-			// Thread
-			std::thread mThread;
-			std::mutex mMutex;
+			// Every task and tick of this server runs serialized on its strand, in the shared executor.
+			std::shared_ptr<Strand> mStrand;
+			mutable std::mutex mMutex;
+
+			// Tick driver
+			Clock::time_point mNextTick;
+			Clock::time_point mNextPoll;
+			Clock::duration mTickInterval;
+			Clock::duration mPollInterval;
+			TickStats mTickStats;
+
+			uint64_t mFrameMessages = 0;
+			uint64_t mFrameBytes = 0;
+
+			uint32_t mTickRate = 20;
+			uint32_t mClientBudget = 0;
 
-			// Task queue
-			std::queue<std::function<void(void)>> mTasks;
-			std::mutex mTaskMutex;
+			bool mTickCatchUp = true;
 
 			// Misc
 #ifdef PACKET_LOGGING